@@ -0,0 +1,7 @@
+#pragma once
+
+/**
+ * Marks the functions and variables of the library API, the only symbols exported by libpgncompress.so,
+ * whose objects are built with -fvisibility=hidden (see the lib target of the Makefile).
+ */
+#define PGN_API __attribute__((visibility("default")))
@@ -1,7 +1,43 @@
 #pragma once
+#include "../include/api.h"
 #include "../include/piece.h"
 
+/**
+ * Moves a piece on the board only, without updating any bitboards.
+ */
 void move_piece(board board, const struct coord* from, const struct coord* to);
 
-void apply_move_on_raw_board(const struct pgn_token* token, board board);
-void apply_move(const struct pgn_token* token, struct board_state* state);
+PGN_API bool is_token_a_move(enum token_type type);
+
+/**
+ * Plays a move in place and fills the undo record, promotion_piece is EMPTY_SQUARE if the move isn't a promotion.
+ * A pawn moving diagonally to an empty square is an en passant.
+ * The bitboards are updated alongside the board.
+ */
+void make_move(board board, struct bitboards* bitboards, const struct coord* from, const struct coord* to, enum piece_type promotion_piece, struct move_undo* undo);
+void make_castling(board board, struct bitboards* bitboards, enum player player, enum castling castling, struct move_undo* undo);
+
+/**
+ * Takes back a move played with make_move or make_castling, does nothing with EMPTY_MOVE_UNDO.
+ */
+void unmake_move(board board, struct bitboards* bitboards, const struct move_undo* undo);
+
+/**
+ * Returns the file of the pawn which moved 2 squares forward during the move, INVALID_COORD for any other move.
+ */
+int en_passant_file_after(board board, const struct move_undo* undo);
+
+/**
+ * Returns the castling rights left after the move, a king or a rook leaving its starting square, or a rook being captured there, removes the matching rights.
+ */
+uint8_t castling_rights_after(uint8_t castling_rights, const struct move_undo* undo);
+
+/**
+ * Tokens which aren't moves leave the board untouched and set undo to EMPTY_MOVE_UNDO.
+ */
+void apply_move_on_raw_board(const struct pgn_token* token, board board, struct bitboards* bitboards, struct move_undo* undo);
+/**
+ * Also updates the castling rights and the en passant file of the state, their previous values are saved in the last move undo record.
+ * Inside alternative moves, the move is added to the undo log, false is returned if it cannot be.
+ */
+bool apply_move(const struct pgn_token* token, struct board_state* state);
@@ -0,0 +1,28 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+
+#define ARENA_CHUNK_SIZE 4096
+#define ARENA_ALIGNMENT 16 // enough for any type used in the project
+
+struct arena_chunk {
+    struct arena_chunk* previous;
+    size_t size; // of the data
+    size_t used;
+    unsigned char data[];
+};
+
+/**
+ * Bump allocator : allocations are carved out of chunks one after the other, and can only be freed all at once.
+ */
+struct arena {
+    struct arena_chunk* chunk; // the one being carved out, NULL before the first allocation
+};
+
+void arena_init(struct arena* arena);
+void arena_free(struct arena* arena);
+
+/**
+ * Returns size bytes aligned on ARENA_ALIGNMENT, living until the arena is freed, or NULL if a chunk cannot be allocated.
+ */
+void* arena_alloc(struct arena* arena, size_t size);
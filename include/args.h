@@ -5,6 +5,21 @@ struct args {
     bool compress;
     bool uncompress;
     bool help;
+    bool index; // builds a position index of a container
+    bool verify; // checks the blocks of a container against their checksums, without decoding the games
+    bool roundtrip; // checks that every game of a container decodes the same once encoded again with each move coding
+    const char* find_position; // FEN looked for in a position index, NULL if not searching
+    unsigned checkpoints; // rewrites a container with a checkpoint every n plies, 0 if not rewriting
+    long ply; // only prints the position after this ply when uncompressing, -1 to uncompress everything
+    const char* transcode; // move coding a container is rewritten with, NULL if not rewriting
+    bool huffman; // Huffman codes the token types when transcoding
+    unsigned opening_trie; // plies of the openings shared through the opening trie when transcoding, 0 without trie
+    bool dedup; // stores the games already in the container as references to their first occurrence when transcoding
+    const char* dedup_tags; // comma separated names of the tags telling games apart besides their moves, NULL for none
+    unsigned long block_size; // bytes of games per block when transcoding, 0 without blocks
+    bool variation_lengths; // stores the length of the alternative moves when transcoding, so that they can be skipped
+    bool mainline_only; // skips the alternative moves when uncompressing
+    bool log; // logs the parsing of the games, on unless --no-log is given
     const char* input;
     const char* output;
 };
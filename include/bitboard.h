@@ -0,0 +1,79 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "piece.h"
+
+#define EMPTY_BITBOARD ((bitboard)0)
+#define N_SQUARES (BOARD_SIZE * BOARD_SIZE)
+
+extern const bitboard KNIGHT_ATTACKS[N_SQUARES];
+extern const bitboard KING_ATTACKS[N_SQUARES];
+extern const bitboard PAWN_ATTACKS[PLAYER_SIZE][N_SQUARES]; // squares attacked by a pawn of the given player
+
+uint8_t coord_to_square(struct coord coord);
+struct coord square_to_coord(uint8_t square);
+
+bitboard square_bit(uint8_t square);
+bitboard coord_bit(struct coord coord);
+uint8_t count_squares(bitboard bitboard);
+
+/**
+ * Returns the lowest square of a non-empty bitboard and removes it, iterating this way enumerates squares by increasing index.
+ */
+uint8_t pop_lowest_square(bitboard* bitboard);
+
+/**
+ * Index of a square among the squares of the bitboard, by increasing square index.
+ */
+uint8_t count_squares_below(bitboard bitboard, uint8_t square);
+
+/**
+ * Square with the given index among the squares of the bitboard, N_SQUARES if there are not enough squares.
+ */
+uint8_t nth_square(bitboard bitboard, uint8_t n);
+
+bitboard bishop_attacks(uint8_t square, bitboard occupied);
+bitboard rook_attacks(uint8_t square, bitboard occupied);
+bitboard queen_attacks(uint8_t square, bitboard occupied);
+
+/**
+ * Squares attacked by a piece of the given type and player, standing on the given square.
+ */
+bitboard piece_attacks(enum piece_type piece, enum player player, uint8_t square, bitboard occupied);
+
+/**
+ * Squares strictly between two squares on the same line or diagonal, EMPTY_BITBOARD if they aren't aligned.
+ */
+bitboard squares_between(uint8_t first, uint8_t second);
+
+/**
+ * Whole line or diagonal going through both squares (up to the board edges), EMPTY_BITBOARD if they aren't aligned.
+ */
+bitboard line_through(uint8_t first, uint8_t second);
+
+/**
+ * Builds the bitboards from scratch, moves then keep them up to date with bitboards_add_piece and bitboards_remove_piece.
+ */
+void compute_bitboards(board board, struct bitboards* bitboards);
+// an empty square is neither added nor removed
+void bitboards_add_piece(struct bitboards* bitboards, struct piece piece, uint8_t square);
+void bitboards_remove_piece(struct bitboards* bitboards, struct piece piece, uint8_t square);
+bitboard all_occupied(const struct bitboards* bitboards);
+
+/**
+ * Squares of the attacker's pieces attacking the given square, with the given occupancy (used by sliding pieces).
+ */
+bitboard attackers_of(const struct bitboards* bitboards, uint8_t square, enum player attacker, bitboard occupied);
+
+/**
+ * Squares of the player's pieces of the given type which can move to the given square, ignoring pins and checks as disambiguation does.
+ * Iterating it with pop_lowest_square yields the candidates in disambiguation order.
+ */
+bitboard pieces_able_to_move_to(const struct bitboards* bitboards, enum player player, enum piece_type piece, uint8_t to);
+
+/**
+ * Squares the player's pieces of the given type can move to, ignoring pins and checks : every destination for which pieces_able_to_move_to isn't empty.
+ * Pawns don't include the last rank, as promotions have their own token, and only capture en passant on en_passant_file.
+ */
+bitboard move_destinations(const struct bitboards* bitboards, enum player player, enum piece_type piece, int en_passant_file);
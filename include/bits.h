@@ -3,6 +3,7 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "../include/api.h"
 #include "../include/safe_bool.h"
 
 struct compressed_buf {
@@ -13,6 +14,17 @@ struct compressed_buf {
     uint8_t nth_bit;
 };
 
+/**
+ * Growable buffer written bit by bit, the most significant bit of each byte first (as read by read_n_bits).
+ */
+struct bit_writer {
+    uint8_t* buf;
+    size_t n_bits;
+    size_t capacity; // in bytes
+};
+
+#define BIT_WRITER_INITIAL_CAPACITY 64
+
 bool is_buf_empty(const struct compressed_buf* buf);
 
 /**
@@ -25,6 +37,55 @@ bool peek_n_bits(const struct compressed_buf* buf, uint8_t n_bits, uint8_t* n);
  */
 bool read_n_bits(struct compressed_buf* buf, uint8_t n_bits, uint8_t* n);
 
+/**
+ * Discards the padding bits until the next byte boundary, does nothing if already on one.
+ */
+void skip_to_next_byte(struct compressed_buf* buf);
+
+/**
+ * Same as read_n_bits, for up to 64 bits.
+ */
+bool read_bits(struct compressed_buf* buf, uint8_t n_bits, uint64_t* n);
+
+/**
+ * Number of bits already consumed since the beginning of the buffer.
+ */
+size_t bit_offset(const struct compressed_buf* buf);
+bool seek_bit_offset(struct compressed_buf* buf, size_t offset);
+
+PGN_API bool bit_writer_init(struct bit_writer* writer);
+PGN_API void bit_writer_free(struct bit_writer* writer);
+
+/**
+ * Empties the writer but keeps its memory, to be reused for another buffer.
+ */
+PGN_API void bit_writer_clear(struct bit_writer* writer);
+
+/**
+ * Writes the n_bits lowest bits of n, the most significant one first.
+ */
+bool write_bits(struct bit_writer* writer, uint8_t n_bits, uint64_t n);
+
+/**
+ * Copies n_bits bits of src starting at the given offset, src is left untouched.
+ */
+bool copy_bits(struct bit_writer* writer, const struct compressed_buf* src, size_t offset, size_t n_bits);
+
+/**
+ * Writes the string and its NUL terminator, as read by read_bytes_until_nul_terminator.
+ */
+bool write_string(struct bit_writer* writer, const char* string);
+
+/**
+ * Pads with 0 bits up to the next byte boundary.
+ */
+bool bit_writer_align(struct bit_writer* writer);
+
+/**
+ * Writes the whole bytes of the writer to a file, it should be aligned first.
+ */
+bool bit_writer_save(const struct bit_writer* writer, const char* path);
+
 uint8_t* read_n_bytes(struct compressed_buf* buf, size_t n_bytes);
 
 /**
@@ -37,12 +98,13 @@ uint8_t* read_bytes_until_nul_terminator(struct compressed_buf* buf, size_t* siz
  */
 enum safe_bool memchr_bits(struct compressed_buf* buf, uint8_t byte, size_t* size);
 
-bool make_compressed_buf(struct compressed_buf* dest, const uint8_t* buf, size_t buf_size);
+PGN_API bool make_compressed_buf(struct compressed_buf* dest, const uint8_t* buf, size_t buf_size);
 
 /**
  * Counts how many bits are required to hold a value (i.e. 3 bits are necessary to hold 7).
+ * To store an index among n choices, pass n - 1.
  */
-uint8_t how_many_bits_to_hold_number(uint8_t n);
+uint8_t how_many_bits_to_hold_number(uint64_t n);
 
 /**
  * Prints binary buffer like xxd/hexdump.
@@ -0,0 +1,50 @@
+#pragma once
+#include <stddef.h>
+
+#include "args.h"
+#include "bits.h"
+#include "piece.h"
+#include "version.h"
+
+#define N_CHECKPOINTS_BITS 16
+#define CHECKPOINT_MAX_PLY_BITS 16
+#define CHECKPOINT_PLY_SIZE_BITS 5 // enough for the number of bits of any ply
+#define CHECKPOINT_OFFSET_SIZE_BITS 6 // enough for the number of bits of any offset
+
+/**
+ * Position of the main line after a ply, and where to resume parsing the moves from.
+ * The last move is kept so that alternative moves following the checkpoint can take it back.
+ */
+struct checkpoint {
+    unsigned ply;
+    size_t bit_offset; // relative to the first bit of the moves, right after the move of the ply
+    board board;
+    uint8_t castling_rights;
+    int8_t en_passant_file;
+    struct move_undo last_move;
+};
+
+void make_checkpoint(const struct board_state* state, unsigned ply, size_t bit_offset, struct checkpoint* checkpoint);
+
+/**
+ * Replaces the state with the position of the checkpoint, the state must be freed with free_board_state.
+ */
+void restore_checkpoint(const struct checkpoint* checkpoint, struct board_state* state);
+
+/**
+ * The table is the number of checkpoints, then for each of them the ply and the bit offset since the previous checkpoint,
+ * the occupied squares, the player and the prefix coded type of each piece by increasing square index,
+ * the castling rights, the en passant file and the last move.
+ * The plies and the offsets must not decrease.
+ */
+bool write_checkpoint_table(struct bit_writer* writer, const struct checkpoint* checkpoints, size_t n_checkpoints);
+
+/**
+ * The checkpoints are allocated and must be freed by the caller, or skipped if checkpoints is NULL.
+ */
+bool read_checkpoint_table(struct compressed_buf* buf, struct checkpoint** checkpoints, size_t* n_checkpoints);
+
+/**
+ * Rewrites every game of the container args->input to args->output with a checkpoint every args->checkpoints plies of the main line.
+ */
+int add_checkpoints(const struct args* args);
@@ -0,0 +1,108 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "api.h"
+#include "args.h"
+#include "bits.h"
+#include "huffman.h"
+#include "opening_trie.h"
+
+/**
+ * A container may start with a header byte, told apart from the version byte of a game by its highest bit,
+ * whose other bits are flags telling what data shared by all the games follows it.
+ */
+#define CONTAINER_HEADER_MARK 0x80
+#define CONTAINER_HUFFMAN_TOKENS 0x01 // followed by the code lengths of the token types
+#define CONTAINER_OPENING_TRIE 0x02 // followed by the opening trie, after the Huffman code if any
+#define CONTAINER_BLOCKS 0x04 // the games are grouped into blocks
+#define CONTAINER_VARIATION_LENGTHS 0x08 // the alternative moves of the games not arithmetic coded start with their length
+
+/**
+ * The length in bits of alternative moves, from right after it up to and including their end token, is stored on
+ * VARIATION_LENGTH_SIZE_BITS bits telling the number of bits of the length, followed by the length itself.
+ */
+#define VARIATION_LENGTH_SIZE_BITS 5
+#define MAX_VARIATION_LENGTH ((1ULL << ((1 << VARIATION_LENGTH_SIZE_BITS) - 1)) - 1)
+
+/**
+ * Blocks start with their number of games, the number of bytes of these games and their CRC-32C, on BLOCK_FIELD_BITS bits each,
+ * and only hold whole games, so that each block can be checked, skipped or decoded on its own.
+ */
+#define BLOCK_FIELD_BITS 32
+#define BLOCK_HEADER_SIZE (3 * BLOCK_FIELD_BITS / 8)
+
+/**
+ * Position of a reader among the blocks, zeroed when the buffer is brought back to the first block.
+ */
+struct block_cursor {
+    size_t nth_block; // 1 for the first block, 0 before it
+    uint32_t games_left; // in the current block
+    size_t end; // byte offset of the end of the current block
+};
+
+struct container_header {
+    uint8_t flags; // 0 if the container has no header
+    struct token_huffman huffman;
+    struct opening_trie trie;
+    struct block_cursor block;
+};
+
+/**
+ * Block being written, the header of the current block is filled once its last game is written.
+ */
+struct block_writer {
+    bool is_open;
+    size_t start; // byte offset of the header of the current block
+    uint32_t n_games;
+};
+
+/**
+ * Reads the header if the container has one, leaving the buffer untouched otherwise.
+ * The header must be freed with free_container_header if this succeeds.
+ */
+PGN_API bool read_container_header(struct compressed_buf* buf, struct container_header* header);
+PGN_API void free_container_header(struct container_header* header);
+
+/**
+ * Writes nothing if the header has no flag.
+ */
+bool write_container_header(struct bit_writer* writer, const struct container_header* header);
+
+/**
+ * Token type codes of the container, NULL if it has none.
+ */
+PGN_API const struct token_huffman* container_huffman(const struct container_header* header);
+
+/**
+ * Opening trie of the container, NULL if it has none.
+ */
+PGN_API const struct opening_trie* container_trie(const struct container_header* header);
+
+/**
+ * Returns if the alternative moves of the games not arithmetic coded start with their length, so that they can be skipped.
+ */
+PGN_API bool container_has_variation_lengths(const struct container_header* header);
+
+/**
+ * Moves to the next game, reading the header of the next block first if the current one is over.
+ * Returns FALSE after the last game, and ERROR if a block is truncated or doesn't match its checksum,
+ * in which case the games of this block are skipped and the following blocks can still be read.
+ */
+PGN_API enum safe_bool next_game(struct compressed_buf* buf, struct container_header* header);
+
+/**
+ * To be called before writing each game of a container with blocks : ends the current block if it already holds block_size bytes,
+ * and starts a new one if needed. Returns TRUE if the game starts a new block, FALSE if it doesn't, ERROR if a block cannot be written.
+ */
+enum safe_bool begin_block_game(struct bit_writer* writer, struct block_writer* block, size_t block_size);
+
+/**
+ * Fills the header of the current block, if any, once its last game is written.
+ */
+bool end_block(struct bit_writer* writer, struct block_writer* block);
+
+/**
+ * Checks every block of the container args->input against its checksum, without decoding any game.
+ */
+int verify_container(const struct args* args);
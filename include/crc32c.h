@@ -0,0 +1,14 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * CRC-32C (Castagnoli) of the bytes, as used by iSCSI and SSE4.2, "123456789" giving 0xE3069283.
+ * Uses the SSE4.2 crc32 instruction when the CPU has it.
+ */
+uint32_t crc32c(const uint8_t* data, size_t size);
+
+/**
+ * Same as crc32c with a table only, whatever the CPU.
+ */
+uint32_t crc32c_portable(const uint8_t* data, size_t size);
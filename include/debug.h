@@ -2,6 +2,7 @@
 
 #include <stdio.h>
 
+#include "huffman.h"
 #include "piece.h"
 #include "uncompress.h"
 
@@ -10,3 +11,4 @@ void print_pgn_token(struct pgn_token* token, FILE* file);
 void print_board(board board);
 void debug_print(struct en_passant_header* en_passant_header, struct tag* tags, size_t n_tags);
 void print_token(const struct pgn_token* token);
+void print_token_huffman(const struct token_huffman* huffman);
@@ -0,0 +1,48 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "api.h"
+#include "arena.h"
+#include "bits.h"
+#include "container.h"
+#include "piece.h"
+#include "position_cache.h"
+#include "safe_bool.h"
+#include "uncompress.h"
+
+/**
+ * Pull based decoder of a container, for programs linking the decompressor rather than parsing its output :
+ * the games are opened one after the other, and their tokens are read one at a time, nothing being printed.
+ * It only reads the buffer, which must outlive it, and it must not be moved once opened.
+ */
+struct decoder {
+    struct compressed_buf buf;
+    struct container_header header;
+    struct position_cache cache;
+    struct arena arena; // comments of the current game
+    struct game_replay game;
+    bool is_game_open;
+    bool is_malformed; // a malformed game outside of blocks leaves the buffer anywhere, so the container ends with it
+};
+
+/**
+ * Reads the container header, returns false if it's malformed or if the decoder cannot be allocated.
+ */
+PGN_API bool decoder_open(struct decoder* decoder, const uint8_t* buf, size_t len);
+PGN_API void decoder_close(struct decoder* decoder);
+
+/**
+ * Opens the next game, the tokens left in the current one being skipped.
+ * Returns TRUE if there's one, FALSE if the container is over, and ERROR if the game cannot be read.
+ * With blocks, the games left in the block of a malformed game, or in a damaged block, are skipped, and the next call goes on with the following block.
+ */
+PGN_API enum safe_bool decoder_next_game(struct decoder* decoder);
+
+/**
+ * Reads the next token of the current game, alternative moves being announced by a beginning token and closed by an end token.
+ * Returns TRUE if there's one, FALSE once the game is over, and ERROR if it's malformed.
+ * A comment lives until the next game is opened.
+ */
+PGN_API enum safe_bool decoder_next_token(struct decoder* decoder, struct pgn_token* token);
@@ -0,0 +1,54 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "encode.h"
+#include "safe_bool.h"
+
+#define DEDUP_SET_INITIAL_SIZE 1024 // must be a power of 2
+#define DEDUP_SET_MAX_ENTRIES (1 << 24) // the table then takes 1 GiB, as it's never more than half full
+
+/**
+ * 128 bits hash of the normalized content of a game : its tokens (moves by their squares, comments, NAGs, alternative moves
+ * and result, but not the check flags or the disambiguation) and the selected tags.
+ */
+struct game_hash {
+    uint64_t high;
+    uint64_t low;
+};
+
+/**
+ * tags points to the tags of the game as stored in the container, selected_tags is a comma separated list of tag names, or NULL.
+ */
+struct game_hash hash_game(const struct token_list* tokens, const uint8_t* tags, size_t tags_size, const char* selected_tags);
+
+struct dedup_entry {
+    struct game_hash hash;
+    uint64_t offset;
+    bool is_used;
+};
+
+/**
+ * Hash set of the games already written, with the byte offset of their first occurrence, growing as needed up to max_entries.
+ */
+struct dedup_set {
+    struct dedup_entry* entries;
+    size_t mask;
+    size_t n_entries;
+    size_t max_entries; // DEDUP_SET_MAX_ENTRIES once initialized
+};
+
+bool dedup_set_init(struct dedup_set* set);
+void dedup_set_free(struct dedup_set* set);
+
+/**
+ * Forgets every game, keeping the memory of the set.
+ */
+void dedup_set_clear(struct dedup_set* set);
+
+/**
+ * If the hash is in the set, returns TRUE and sets offset to the one of the first occurrence, otherwise adds the hash with the offset and returns FALSE.
+ * Returns ERROR if the set is full.
+ */
+enum safe_bool dedup_set_find_or_add(struct dedup_set* set, struct game_hash hash, uint64_t* offset);
@@ -0,0 +1,57 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "api.h"
+#include "args.h"
+#include "bits.h"
+#include "huffman.h"
+#include "piece.h"
+#include "version.h"
+
+/**
+ * Tokens of a game in stream order, as given to a token visitor while uncompressing it. Comments are owned by the list.
+ */
+struct token_list {
+    struct pgn_token* tokens;
+    size_t n_tokens;
+    size_t max_tokens;
+    bool failed; // set if record_token couldn't push a token
+};
+
+PGN_API bool token_list_push(struct token_list* list, const struct pgn_token* token);
+
+/**
+ * Token visitor pushing the tokens to the token list given as data.
+ */
+PGN_API void record_token(const struct pgn_token* token, void* data);
+
+/**
+ * Empties the list but keeps its memory, to be reused by the next game.
+ */
+PGN_API void token_list_clear(struct token_list* list);
+PGN_API void token_list_free(struct token_list* list);
+
+/**
+ * Replays the tokens from the starting position, writing each of them with the given coding, except the first_token ones,
+ * which must be main line moves, as the game starts from the node of the opening trie they lead to.
+ * The token types of the prefixed codings use the Huffman code if it isn't NULL.
+ * With variation_lengths, alternative moves start with their length (see container.h), which the arithmetic coding cannot do.
+ */
+bool encode_moves(struct bit_writer* writer, const struct token_list* tokens, size_t first_token, enum move_coding coding, const struct token_huffman* huffman, bool variation_lengths);
+
+/**
+ * Appends a game to a container without header : its version, its tags, no en passant notation and its tokens written with the given coding.
+ */
+PGN_API bool encode_game(struct bit_writer* writer, const struct tag* tags, size_t n_tags, const struct token_list* tokens, enum move_coding coding);
+
+/**
+ * Rewrites every game of the container args->input to args->output with the move coding named args->transcode.
+ * Tags and en passant headers are kept as is, checkpoint tables are dropped as their offsets would be wrong.
+ * With args->opening_trie, a first pass gathers the openings shared by several games, up to this number of plies, in the opening trie of the header.
+ * With args->huffman, another pass counts the token types of the whole container to build the Huffman code of the header.
+ * With args->dedup, a game whose moves and args->dedup_tags tags hash the same as a game already written is stored as a reference to it.
+ * With args->block_size, the games are grouped into blocks of about this number of bytes.
+ * With args->variation_lengths, alternative moves start with their length, so that decoding the main line only can skip them.
+ */
+int transcode(const struct args* args);
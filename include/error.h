@@ -16,10 +16,11 @@ int errprintf(const char* fmt, ...) __attribute__((format (printf, 1, 2)));
 }
 
 
+// ends the whole process, and the programs the library is linked into : only for broken invariants, never for malformed input
 #define ASSERT_PRINTF_EXIT_PROGRAM(condition, /* fmt, */ ...) ASSERT_PRINTF_BASE(condition, _Exit(EXIT_FAILURE), __VA_ARGS__)
 #define ASSERT_PRINTF_EXIT_FAILURE(condition, /* fmt, */ ...) ASSERT_PRINTF_BASE(condition, return EXIT_FAILURE, __VA_ARGS__)
 #define ASSERT_PRINTF_NULL(condition, /* fmt, */ ...) ASSERT_PRINTF_BASE(condition, return NULL, __VA_ARGS__)
 #define ASSERT_PRINTF(condition, /* fmt, */ ...) ASSERT_PRINTF_BASE(condition, return false, __VA_ARGS__)
 #define ASSERT_PRINTF_RETURN(condition, /* fmt, */ ...) ASSERT_PRINTF_BASE(condition, return, __VA_ARGS__)
 #define ASSERT_PRINTF_RETURN_FALSE(condition, /* fmt, */ ...) ASSERT_PRINTF_BASE(condition, return false, __VA_ARGS__)
-#define FAIL(/* fmt, */ ...) ASSERT_PRINTF_EXIT_PROGRAM(false, __VA_ARGS__)
+#define ASSERT_PRINTF_RETURN_ERROR(condition, /* fmt, */ ...) ASSERT_PRINTF_BASE(condition, return ERROR, __VA_ARGS__) // enum safe_bool
@@ -0,0 +1,10 @@
+#pragma once
+#include <stdbool.h>
+
+#include "piece.h"
+
+/**
+ * Fills the state from a FEN string : piece placement, side to move, castling rights, en passant square and the optional move counters.
+ * The state must be freed with free_board_state. Returns false if the FEN is malformed.
+ */
+bool board_state_from_fen(const char* fen, struct board_state* state);
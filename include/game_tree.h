@@ -0,0 +1,38 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "api.h"
+#include "arena.h"
+#include "bits.h"
+#include "piece.h"
+#include "safe_bool.h"
+#include "uncompress.h"
+
+/**
+ * Token of a line of a game, alternative moves being lines of their own rather than tokens.
+ */
+struct game_node {
+    struct pgn_token token; // never ALTERNATIVE_MOVE, a comment lives in the arena of the tree
+    struct game_node* next; // next token of the same line, NULL at its end
+    struct game_node* variations; // first token of the first alternative line right after this token, NULL if none
+    struct game_node* next_variation; // on the first token of an alternative line, first token of the next line after the same token
+};
+
+/**
+ * Decoded game, whose nodes and comments all come from the same arena, so that it's freed at once.
+ * An alternative line replaces the last move before it, like alternative moves in the stream.
+ */
+struct game_tree {
+    struct arena arena;
+    struct game_node* main_line; // NULL if the game has no token
+    size_t n_nodes;
+};
+
+/**
+ * Decodes the next game into the tree as uncompress_game does, the visitor of the options being replaced, layout may be NULL.
+ * Alternative moves holding no token are left out, as well as every alternative line with options->mainline_only.
+ * Returns ERROR if the game is malformed, TRUE otherwise, the tree must then be freed with game_tree_free.
+ */
+PGN_API enum safe_bool uncompress_game_tree(struct compressed_buf* buf, const struct uncompress_options* options, struct game_layout* layout, struct game_tree* tree);
+PGN_API void game_tree_free(struct game_tree* tree);
@@ -0,0 +1,50 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "bits.h"
+#include "piece.h"
+
+/**
+ * Canonical Huffman code of the token types of the prefix codings, replacing their fixed 3 to 5 bits prefix.
+ * Codes are at most MAX_TOKEN_CODE_LENGTH bits long, so that a single peek decodes them through a lookup table.
+ * Only the code lengths are stored, on TOKEN_CODE_LENGTH_BITS bits each, in the order of TOKEN_SYMBOLS.
+ */
+
+#define N_TOKEN_SYMBOLS 12
+#define MAX_TOKEN_CODE_LENGTH 8
+#define TOKEN_CODE_LENGTH_BITS 4
+
+extern const enum token_type TOKEN_SYMBOLS[N_TOKEN_SYMBOLS];
+
+struct token_code {
+    uint8_t symbol;
+    uint8_t length;
+};
+
+struct token_huffman {
+    uint8_t lengths[N_TOKEN_SYMBOLS];
+    uint8_t codes[N_TOKEN_SYMBOLS];
+    struct token_code table[1 << MAX_TOKEN_CODE_LENGTH]; // indexed by the next MAX_TOKEN_CODE_LENGTH bits
+};
+
+/**
+ * Index of the token type in TOKEN_SYMBOLS, N_TOKEN_SYMBOLS if it has none.
+ */
+uint8_t token_symbol(enum token_type type);
+
+/**
+ * Builds the code from the number of tokens of each symbol. Every symbol gets a code, even the unseen ones.
+ */
+void token_huffman_from_frequencies(struct token_huffman* huffman, const uint64_t frequencies[N_TOKEN_SYMBOLS]);
+
+/**
+ * Builds the code from its lengths, returns false if they don't make a complete prefix code.
+ */
+bool token_huffman_from_lengths(struct token_huffman* huffman, const uint8_t lengths[N_TOKEN_SYMBOLS]);
+
+bool write_token_huffman(struct bit_writer* writer, const struct token_huffman* huffman);
+bool read_token_huffman(struct compressed_buf* buf, struct token_huffman* huffman);
+
+bool write_token_type(struct bit_writer* writer, const struct token_huffman* huffman, enum token_type type);
+bool read_token_type(struct compressed_buf* buf, const struct token_huffman* huffman, enum token_type* type);
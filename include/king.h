@@ -12,6 +12,11 @@ bool parse_king_move(struct move* move, const char* str, enum player moving_play
 
 bool can_king_move_to(struct coord from, struct coord to, enum player moving_player, board board, bool check_is_is_dest_square_safe);
 
+/**
+ * Same as can_king_move_to, but also checks if the destination square is safe, to fit in can_move_to.
+ */
+bool can_king_safely_move_to(struct coord from, struct coord to, enum player moving_player, board board);
+
 extern  struct coord king_starting_coords[PLAYER_SIZE];
 extern struct coord king_ending_coords[PLAYER_SIZE][CASTLING_SIZE];
 extern struct coord rook_starting_coords[PLAYER_SIZE][CASTLING_SIZE];
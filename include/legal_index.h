@@ -0,0 +1,34 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "movegen.h"
+#include "piece.h"
+
+/**
+ * With the legal index coding, each token is a number : below the number n of legal moves, it's the index of the move
+ * in the generate_legal_moves order, otherwise it's n plus one of these values, followed by the same payload as the prefix coding.
+ */
+enum special_index {
+    COMMENT_INDEX,
+    ALTERNATIVE_MOVES_START_INDEX,
+    ALTERNATIVE_MOVES_END_INDEX,
+    NAG_INDEX,
+    END_OF_THE_GAME_INDEX,
+    N_SPECIAL_INDICES
+};
+
+/**
+ * Number of bits of every token in a position with n_moves legal moves.
+ */
+uint8_t legal_index_bits(uint8_t n_moves);
+
+/**
+ * Finds the index of a move token among the legal moves, returns false if the move isn't legal.
+ */
+bool find_legal_move_index(const struct legal_move moves[], uint8_t n_moves, const struct pgn_token* token, uint8_t* index);
+
+/**
+ * Fills the token of a legal move of the player, as the prefix coding parser would, except for the check which is left to the caller.
+ */
+void legal_move_to_token(board board, enum player player, const struct legal_move* move, struct pgn_token* token);
@@ -3,10 +3,11 @@
 #include <stdbool.h>
 #include <stdio.h>
 
-extern bool log_enabled;
-
-#define LOG_BASE(print_func, output, ...)                                   \
-if (log_enabled) {                                                          \
+/**
+ * Logs only if enabled is true, which comes from the options of the caller (see uncompress_options.log), as there's no global switch.
+ */
+#define LOG_BASE(enabled, print_func, output, ...)                          \
+if (enabled) {                                                              \
     print_func((output), "[LOG] ");                                         \
     print_func((output), "At " __FILE__ ":%d (%s)\n", __LINE__, __func__);  \
     print_func((output), "[LOG] ");                                         \
@@ -14,6 +15,6 @@ if (log_enabled) {                                                          \
     print_func((output), "\n");                                             \
 }
 
-#define LOG(...) LOG_BASE(fprintf, stdout, __VA_ARGS__)
-#define ERR(...) LOG_BASE(fprintf, stderr, __VA_ARGS__)
-#define LOGFILE(file, ...) LOG_BASE(fprintf, file, __VA_ARGS__)
+#define LOG(enabled, ...) LOG_BASE(enabled, fprintf, stdout, __VA_ARGS__)
+#define ERR(enabled, ...) LOG_BASE(enabled, fprintf, stderr, __VA_ARGS__)
+#define LOGFILE(enabled, file, ...) LOG_BASE(enabled, fprintf, file, __VA_ARGS__)
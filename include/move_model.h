@@ -0,0 +1,40 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "legal_index.h"
+#include "movegen.h"
+#include "piece.h"
+#include "range_coder.h"
+
+#define MAX_RANK_BITS 8 // a rank + 1 is at most MAX_LEGAL_MOVES, which holds in 8 bits
+#define SPECIAL_INDEX_BITS 3
+
+/**
+ * With the arithmetic coding, the legal moves are sorted from the most to the least likely with a static heuristic,
+ * and the rank of the played move is coded with adaptive probabilities : the first ranks end up costing much less than a bit.
+ * Both sides must update the model with the same moves in the same order, including the ones of alternative moves.
+ */
+struct move_model {
+    bit_probability is_move;
+    bit_probability special[1 << SPECIAL_INDEX_BITS]; // bit tree of the special index
+    bit_probability rank_length[MAX_RANK_BITS + 1]; // unary number of bits of rank + 1
+    bit_probability rank_bits[MAX_RANK_BITS + 1][MAX_RANK_BITS]; // bits of rank + 1 after its leading 1, by length and position
+    uint8_t history[PLAYER_SIZE][N_SQUARES][N_SQUARES]; // how many times each move was played in the game, saturating
+};
+
+void move_model_init(struct move_model* model);
+
+/**
+ * Sorts the legal moves of the player to move from the most to the least likely.
+ * The board is used to try the moves, and is restored afterwards.
+ */
+void rank_legal_moves(const struct move_model* model, struct board_state* state, struct legal_move moves[], uint8_t n_moves);
+
+void move_model_played(struct move_model* model, enum player player, struct coord from, struct coord to);
+
+bool encode_rank(struct range_encoder* encoder, struct move_model* model, uint8_t rank);
+bool decode_rank(struct range_decoder* decoder, struct move_model* model, uint8_t* rank);
+
+bool encode_special_index(struct range_encoder* encoder, struct move_model* model, enum special_index index);
+bool decode_special_index(struct range_decoder* decoder, struct move_model* model, enum special_index* index);
@@ -0,0 +1,33 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "bitboard.h"
+#include "piece.h"
+
+#define MAX_LEGAL_MOVES 218 // highest known number of legal moves in a reachable position
+
+struct legal_move {
+    struct coord from;
+    struct coord to;
+    enum piece_type piece;
+    enum piece_type promotion_piece; // EMPTY_SQUARE if not a promotion
+    bool is_castling;
+    enum castling castling;
+};
+
+/**
+ * Generates every legal move of the player, without playing any of them.
+ * The check evasion mask and the pinned pieces rays are computed once, so that only legal moves are emitted.
+ * Moves are sorted by starting square index, then by destination square index, promotions follow PROMOTION_PIECE order.
+ * castling_rights is a CASTLING_RIGHT combination, en_passant_file is the file of the opponent pawn which just moved 2 squares forward, or INVALID_COORD.
+ * Castling is generated when the player still has the right and the king and the rook are on their starting squares, with the usual emptiness and safety rules.
+ */
+uint8_t generate_legal_moves(const struct bitboards* bitboards, enum player player, uint8_t castling_rights, int en_passant_file, struct legal_move moves[MAX_LEGAL_MOVES]);
+
+/**
+ * Only tells a check from a mate, castling is left out as a checked king cannot castle.
+ */
+bool has_legal_move(const struct bitboards* bitboards, enum player player, int en_passant_file);
+
+void make_legal_move(board board, struct bitboards* bitboards, const struct legal_move* move, struct move_undo* undo);
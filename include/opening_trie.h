@@ -0,0 +1,71 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "bits.h"
+#include "checkpoint.h"
+#include "piece.h"
+
+/**
+ * Opening move sequences shared by the games of a container, stored once in its header.
+ * A game then starts with the node of its opening, and only stores its moves after it.
+ */
+
+#define N_OPENING_NODES_BITS 32
+#define MAX_OPENING_PLIES 64
+#define OPENING_TRIE_MIN_GAMES 2 // a node reached by a single game wouldn't be shared
+
+struct opening_node {
+    size_t parent;
+    uint8_t move_index; // of the move from the parent, in the generate_legal_moves order
+    struct pgn_token token; // move from the parent
+    struct checkpoint state; // position after the move, its bit offset is unused
+    size_t n_games; // only counted while building the trie
+    size_t first_child; // 0 if none, as the root is nobody's child
+    size_t next_sibling; // 0 if none
+};
+
+struct opening_trie {
+    struct opening_node* nodes; // the root is node 0, the starting position, and parents come before their children
+    size_t n_nodes;
+    size_t max_nodes;
+};
+
+/**
+ * Makes a trie holding the root only.
+ */
+bool opening_trie_init(struct opening_trie* trie);
+void opening_trie_free(struct opening_trie* trie);
+
+/**
+ * Walks down the trie along the leading moves of the game (at most max_plies, stopping at the first other token),
+ * adding the missing nodes, and counts the game on each node of its path.
+ */
+bool opening_trie_add_game(struct opening_trie* trie, const struct pgn_token* tokens, size_t n_tokens, unsigned max_plies);
+
+/**
+ * Deepest node along the leading moves of the game, its ply being the number of moves it covers.
+ */
+size_t opening_trie_find(const struct opening_trie* trie, const struct pgn_token* tokens, size_t n_tokens);
+
+/**
+ * Removes the nodes reached by less than min_games games, the root being always kept.
+ */
+bool opening_trie_prune(struct opening_trie* trie, size_t min_games);
+
+/**
+ * Number of bits of a node id in a game.
+ */
+uint8_t opening_node_id_bits(const struct opening_trie* trie);
+
+/**
+ * The trie is the number of nodes after the root, then for each of them the id of its parent (in as many bits as needed
+ * for the ids before it) and the index of its move among the legal moves of the parent (in as many bits as needed for them).
+ */
+bool write_opening_trie(struct bit_writer* writer, const struct opening_trie* trie);
+
+/**
+ * Reads the trie and replays every node once, so that games can start from their state.
+ */
+bool read_opening_trie(struct compressed_buf* buf, struct opening_trie* trie);
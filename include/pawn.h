@@ -14,3 +14,8 @@ bool parse_pawn_move(struct move* move, const char* str, enum player moving_play
     bool _parse_pawn_move(struct move* move, const char* str, enum player moving_player);
 #endif
 bool can_pawn_move_to(struct coord from, struct coord to, enum player moving_player, board board);
+
+/**
+ * Lists the squares a pawn about to promote can move to, sorted by file, as the encoded index is relative to the A file.
+ */
+uint8_t list_promotion_squares(board board, struct coord pawn, enum player player, struct coord squares[3]);
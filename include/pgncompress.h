@@ -0,0 +1,12 @@
+#pragma once
+
+/**
+ * Public header of libpgncompress (make lib), for programs running the codec in process.
+ * Games are encoded from their tokens with encode_game, and decoded with a decoder (one token at a time) or into a game tree.
+ * Only the declarations marked PGN_API are exported by the shared library.
+ */
+
+#include "api.h"
+#include "decoder.h"
+#include "encode.h"
+#include "game_tree.h"
@@ -95,11 +95,16 @@ struct move {
 
 extern const struct move INVALID_MOVE;
 
-struct piece {
-    enum piece_type type;
-    enum player player;
+/**
+ * Packed in a single byte (3 bits for the enum piece_type, 2 bits for the enum player as empty squares use INVALID_PLAYER), so that a whole board is 64 bytes.
+ */
+struct __attribute__((packed)) piece {
+    unsigned type : 3; // enum piece_type
+    unsigned player : 2; // enum player
 };
 
+extern const struct piece EMPTY_PIECE;
+
 bool are_pieces_equal(const struct piece* first, const struct piece* second);
 
 extern const enum piece_type PROMOTION_PIECE[4];
@@ -143,20 +148,85 @@ struct pgn_token {
 
 typedef struct piece board[BOARD_SIZE][BOARD_SIZE];
 
+/**
+ * One bit per square, bit n being the square with index rank * 8 + file (A1 = 0, H1 = 7, H8 = 63).
+ */
+typedef uint64_t bitboard;
+
+/**
+ * Position identity, see zobrist.h.
+ */
+typedef uint64_t zobrist_key;
+
+#define N_PIECE_TYPES EMPTY_SQUARE // EMPTY_SQUARE is right after the last piece type
+
+/**
+ * Square sets of each piece type for each player, alongside the squares occupied by each player and the king squares.
+ * Kept in sync with the board by make_move, make_castling and unmake_move, see bitboard.h for the helpers.
+ */
+struct bitboards {
+    bitboard pieces[PLAYER_SIZE][N_PIECE_TYPES];
+    bitboard occupied[PLAYER_SIZE];
+    uint8_t king_square[PLAYER_SIZE]; // N_SQUARES if the player has no king
+    zobrist_key pieces_key; // pieces part of the zobrist key
+};
+
+/**
+ * Bit of the castling right of a player on a side, castling rights are a combination of these.
+ */
+#define CASTLING_RIGHT(player, castling) (1 << ((player) * CASTLING_SIZE + (castling)))
+#define ALL_CASTLING_RIGHTS 0xF
+
+enum move_undo_flag {
+    MOVE_UNDO_NONE = 0,
+    MOVE_UNDO_CASTLING = 1 << 0,
+    MOVE_UNDO_PROMOTION = 1 << 1,
+    MOVE_UNDO_EN_PASSANT = 1 << 2
+};
+
+/**
+ * Everything needed to take back a move played with make_move, the moved piece is deduced from the destination square.
+ * For castling, from and to are the king's squares.
+ * For en passant, the captured pawn stands on the destination file and the starting rank.
+ */
+struct move_undo {
+    struct coord from; // INVALID_COORD_STRUCT if no move
+    struct coord to;
+    struct piece captured;
+    uint8_t flags; // enum move_undo_flag combination
+    uint8_t castling_rights; // before the move
+    int8_t en_passant_file; // before the move
+};
+
+extern const struct move_undo EMPTY_MOVE_UNDO;
+
+/**
+ * State before alternative moves, without its board : the moves of the sequence are taken back from the undo log
+ * once it ends, then the last move, which the sequence replaces, is played again.
+ */
 struct previous_board_state {
     enum player current_player;
     unsigned move_turn;
-    board board;
+    uint8_t castling_rights;
+    int8_t en_passant_file;
+    struct move_undo last_move;
+    enum piece_type last_moved; // piece type on the destination of the last move, to play a promotion again
+    size_t undo_log_size; // moves of the enclosing sequences, the log is taken back to this size
 };
 
 STACK_STRUCT_WITH_NAME(struct previous_board_state, previous_board_state)
+STACK_STRUCT_WITH_NAME(struct move_undo, move_undo)
 
 struct board_state {
     enum player current_player;
     unsigned move_turn;
     board board;
-    board previous_board;
+    struct bitboards bitboards; // pieces of the board, updated alongside it
+    uint8_t castling_rights; // CASTLING_RIGHT combination
+    int8_t en_passant_file; // file of the pawn which just moved 2 squares forward, or INVALID_COORD
+    struct move_undo last_move; // undone when alternative moves start
     struct stack_previous_board_state previous_states; // previous states, before alternative moves
+    struct stack_move_undo undo_log; // moves played inside alternative moves, in order
 };
 
 struct board_state empty_board_state(void);
@@ -164,9 +234,18 @@ void free_board_state(struct board_state* state);
 void next_turn(struct board_state* state);
 // bool apply_move(struct board_state* state, const struct move* move);
 
+/**
+ * Alternative moves replace the last move : it's taken back when they start, and played again once they end,
+ * after taking back the moves of the sequence. Neither copies the board.
+ */
 bool board_start_alternative_moves(struct board_state* state);
 bool board_end_alternative_moves(struct board_state* state);
 
+/**
+ * Adds the last move to the undo log if it's played inside alternative moves.
+ */
+bool board_log_last_move(struct board_state* state);
+
 // ----------------------------------------------------------------------------
 
 struct piece* board_at_coord(board board, struct coord coord);
@@ -183,28 +262,26 @@ bool is_square_attacked_by(board board, struct coord coord, enum player attacker
 /**
  * Counts how many pawns of the given player are ready to promote (second to last rank), stores each coord in the array and returns the count.
  */
-uint8_t count_pawns_ready_to_promote(board board, enum player pawn_player, struct coord coords[BOARD_SIZE]);
+uint8_t count_pawns_ready_to_promote(const struct bitboards* bitboards, enum player pawn_player, struct coord coords[BOARD_SIZE]);
 
 /**
  * Returns the nth piece of the given player and color, the lowest n being closer to A1, the highest n being closer to H8 (ID calculated with rank * 8 + file).
  * If doesn't exist, returns false.
  */
-bool nth_piece(board board, enum player player, enum piece_type piece, uint8_t nth, struct coord* coord);
+bool nth_piece(const struct bitboards* bitboards, enum player player, enum piece_type piece, uint8_t nth, struct coord* coord);
 
 /**
- * Finds the king of the given player. Returns false if not found (shouldn't happen with correct data), or true it found.
+ * Returns the cached square of the king of the given player, exits the program if it has no king (shouldn't happen with correct data).
  */
-struct coord find_king(board board, enum player player);
-
-// converts each 2D coord to an 1D coord (0->63), and compares these 1D indices
-int qsort_compare_piece_by_index(const void* /* struct coord* */ coord1, const void* /* struct coord* */ coord2);
+struct coord find_king(const struct bitboards* bitboards, enum player player);
 
 #define MAX_PIECES_TO_GO_TO_SAME_SQUARE 8 // At most 8 pieces of the same type could go to the same square (either 8 knights or 8 queens)
 
 /**
  * Returns how many pieces of the given type of the given player can move to the given square.
+ * The coords are stored by increasing square index (rank * 8 + file), which is the disambiguation order.
  */
-uint8_t count_how_many_pieces_of_same_type_can_move_to_square(board board, enum player player, enum piece_type piece, struct coord* to, struct coord coords[MAX_PIECES_TO_GO_TO_SAME_SQUARE]);
+uint8_t count_how_many_pieces_of_same_type_can_move_to_square(const struct bitboards* bitboards, enum player player, enum piece_type piece, struct coord* to, struct coord coords[MAX_PIECES_TO_GO_TO_SAME_SQUARE]);
 
 // ----------------------------------------------------------------------------
 
@@ -212,8 +289,9 @@ extern bool (*const can_move_to[])(struct coord from, struct coord to, enum play
 
 /**
  * Returns if the player is in check, checkmate or nothing.
- * If look_for_escape is true, then the function will look if there's any move than allows the player to escape the check.
+ * If look_for_escape is true, then the function will look if the player has any legal move (see generate_legal_moves).
  * Then it'll return CHECK if so, and CHECKMATE if not.
  * Passing false to this parameter just looks if the player is in check, and can return only NO_CHECK or CHECK
+ * en_passant_file is the file of the opponent pawn which just moved 2 squares forward, or INVALID_COORD.
  */
-enum check_type is_player_checked(board board, enum player player, bool look_for_escape);
+enum check_type is_player_checked(const struct bitboards* bitboards, enum player player, bool look_for_escape, int en_passant_file);
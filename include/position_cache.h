@@ -0,0 +1,36 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "piece.h"
+
+#define POSITION_CACHE_DEFAULT_SIZE 4096 // must be a power of 2
+
+struct position_cache_entry {
+    zobrist_key key;
+    bool is_used;
+    enum check_type check;
+};
+
+/**
+ * Bounded table of data derived from positions, indexed by the low bits of the Zobrist key, a new position replaces the one stored in its slot.
+ * It's meant to be shared by every game decoded by the same worker, as openings reach the same positions again and again.
+ */
+struct position_cache {
+    struct position_cache_entry* entries;
+    size_t mask;
+    size_t hits;
+    size_t misses;
+};
+
+/**
+ * n_entries must be a power of 2.
+ */
+bool position_cache_init(struct position_cache* cache, size_t n_entries);
+void position_cache_free(struct position_cache* cache);
+
+/**
+ * Same as is_player_checked with look_for_escape, but the result is looked up in the cache first, which may be NULL.
+ * The key is the one of the position with the player to move, castling rights included.
+ */
+enum check_type cached_is_player_checked(struct position_cache* cache, zobrist_key key, const struct bitboards* bitboards, enum player player, int en_passant_file);
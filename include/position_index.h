@@ -0,0 +1,36 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#include "args.h"
+#include "piece.h"
+
+#define POSITION_INDEX_MAGIC "CPGNIDX1"
+#define POSITION_INDEX_MAGIC_SIZE 8 // stored without NUL terminator
+#define POSITION_INDEX_ENTRY_SIZE 16
+
+/**
+ * An index file is the magic followed by fixed size entries sorted by key, then game, then ply, so that it can be mmapped and binary-searched in place.
+ * Each entry is the 64 bits key, then the 32 bits game ID (0 being the first game of the container) and the 32 bits ply (0 being the starting position), all little-endian.
+ */
+struct position_index_entry {
+    zobrist_key key;
+    uint32_t game;
+    uint32_t ply;
+};
+
+/**
+ * Replays the main line of every game of the container args->input, and writes the index to args->output (args->input + ".idx" if NULL).
+ */
+int build_position_index(const struct args* args);
+
+/**
+ * Prints the games and plies of the index args->input which reached the position given as a FEN in args->find_position.
+ */
+int find_position(const struct args* args);
+
+/**
+ * Returns the index of the first entry whose key is greater than or equal to the key (n_entries if none), entries pointing right after the magic.
+ */
+size_t position_index_lower_bound(const uint8_t* entries, size_t n_entries, zobrist_key key);
+void position_index_read_entry(const uint8_t* entries, size_t nth, struct position_index_entry* entry);
@@ -0,0 +1,51 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "bits.h"
+
+/**
+ * Adaptive binary range coder, as in LZMA : each bit is coded with the probability of being 0 of its context,
+ * which moves towards the coded bit afterwards. Bytes are written to and read from the bit streams 8 bits at a time,
+ * so the coded data doesn't need to start on a byte boundary, and the decoder reads exactly the bytes the encoder wrote.
+ */
+
+#define BIT_PROBABILITY_BITS 11
+#define BIT_PROBABILITY_MOVE_BITS 5
+#define BIT_PROBABILITY_INIT (1 << (BIT_PROBABILITY_BITS - 1))
+
+typedef uint16_t bit_probability; // probability of a 0 bit, out of 1 << BIT_PROBABILITY_BITS
+
+struct range_encoder {
+    struct bit_writer* writer;
+    uint64_t low;
+    uint32_t range;
+    uint8_t cache;
+    uint64_t cache_size;
+};
+
+struct range_decoder {
+    struct compressed_buf* buf;
+    uint32_t range;
+    uint32_t code;
+};
+
+void range_encoder_init(struct range_encoder* encoder, struct bit_writer* writer);
+bool encode_bit(struct range_encoder* encoder, bit_probability* probability, bool bit);
+
+/**
+ * Codes the n_bits lowest bits of value, most significant first, each with a probability of 1/2.
+ */
+bool encode_direct_bits(struct range_encoder* encoder, uint8_t n_bits, uint32_t value);
+
+/**
+ * Writes the remaining bytes, the encoder cannot be used afterwards.
+ */
+bool range_encoder_flush(struct range_encoder* encoder);
+
+/**
+ * Reads the first 5 bytes of the coded data.
+ */
+bool range_decoder_init(struct range_decoder* decoder, struct compressed_buf* buf);
+bool decode_bit(struct range_decoder* decoder, bit_probability* probability, bool* bit);
+bool decode_direct_bits(struct range_decoder* decoder, uint8_t n_bits, uint32_t* value);
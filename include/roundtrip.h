@@ -0,0 +1,24 @@
+#pragma once
+
+#include "args.h"
+#include "encode.h"
+#include "uncompress.h"
+
+#define MAX_ROUNDTRIP_THREADS 64
+
+/**
+ * Decodes every game of the container args->input, encodes it again with each move coding and decodes the result in memory,
+ * checking that the same tokens come out. The games are shared between as many threads as there are processors.
+ */
+int roundtrip(const struct args* args);
+
+/**
+ * Tells if two tokens show the same thing in the SAN, the squares of the moves included.
+ */
+bool are_tokens_equal(const struct pgn_token* first, const struct pgn_token* second);
+
+/**
+ * Rewrites the game of the layout with the coding as the transcoder would, without any container header,
+ * and tells if it decodes back to the original tokens. The writer and decoded are scratch space.
+ */
+bool survives_coding(const struct compressed_buf* container, const struct game_layout* layout, const struct token_list* original, enum move_coding coding, struct bit_writer* writer, struct token_list* decoded);
@@ -4,8 +4,6 @@
 #include <stdio.h>
 #include <stdint.h>
 
-#include "../include/log.h"
-
 #define SOURCE_LOCATION_STACK_MAX 32
 
 typedef uint32_t line_number; // C99 §6.10.4 (Line control) says it's undefined behavior to have more than 2147483647 lines, it fits in an int32_t, but uint32_t won't heart
@@ -21,10 +19,8 @@ struct source_location {
     const char* file;
     const char* func;
     line_number line;
-    size_t strsize; // Size of only this location, ignoring its possible callers
     struct _source_location call_stack[SOURCE_LOCATION_STACK_MAX];
     size_t call_stack_size;
-    size_t callers_str_cumulative_size; // Cumulative size of all callers when converted to string
 };
 
 // loc_here(NULL) if no caller
@@ -33,18 +29,20 @@ struct source_location loc_here(const struct source_location* caller, const char
 #define LOC_HERE_FROM(caller) loc_here((caller), __FILE__, __func__, __LINE__)
 #define LOC_HERE loc_here(NULL, __FILE__, __func__, __LINE__)
 
-const char* loc_str(struct source_location loc);
-void loc_exit(void);
+/**
+ * Prints the callers of the location, then the location, on lines starting with [LOG].
+ * They're printed right away rather than formatted into a buffer, so that nothing is shared between threads.
+ */
+void loc_print(FILE* output, struct source_location loc);
 
-#define LOG_BASE_FROM(loc, print_func, output, ...)             \
-if (log_enabled) {                                              \
-/* loc_str inserts [LOG] + \n on each line of the call stack */ \
-    print_func((output), "%s", loc_str((loc)));                 \
+#define LOG_BASE_FROM(enabled, loc, print_func, output, ...)    \
+if (enabled) {                                                  \
+    loc_print((output), (loc));                                 \
     print_func((output), "[LOG] ");                             \
     print_func((output), __VA_ARGS__);                          \
     print_func((output), "\n");                                 \
 }
 
-#define LOG_FROM(loc, ...) LOG_BASE_FROM(loc, fprintf, stdout, __VA_ARGS__)
-#define ERR_FROM(loc, ...) LOG_BASE_FROM(loc, fprintf, stderr, __VA_ARGS__)
-#define LOGFILE_FROM(loc, file, ...) LOG_BASE_FROM(loc, fprintf, file, __VA_ARGS__)
+#define LOG_FROM(enabled, loc, ...) LOG_BASE_FROM(enabled, loc, fprintf, stdout, __VA_ARGS__)
+#define ERR_FROM(enabled, loc, ...) LOG_BASE_FROM(enabled, loc, fprintf, stderr, __VA_ARGS__)
+#define LOGFILE_FROM(enabled, loc, file, ...) LOG_BASE_FROM(enabled, loc, fprintf, file, __VA_ARGS__)
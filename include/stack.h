@@ -3,6 +3,7 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 
 #define STACK_STRUCT_WITH_NAME(type, name)  \
 struct stack_##name {                       \
@@ -47,6 +48,9 @@ bool stack_##name##_push(struct stack_##name* stack, type elem) {
             free(stack->stack);                                                         \
             return false;                                                               \
         }                                                                               \
+        memcpy(new_stack, stack->stack, sizeof(type) * stack->size);                    \
+        free(stack->stack);                                                             \
+        stack->stack = new_stack;                                                       \
         stack->capacity *= 2;                                                           \
     }                                                                                   \
     stack->stack[stack->size++] = elem;                                                 \
@@ -1,7 +1,18 @@
 #pragma once
 
+#include "api.h"
+#include "arena.h"
 #include "args.h"
+#include "bits.h"
+#include "huffman.h"
+#include "move_model.h"
+#include "opening_trie.h"
+#include "piece.h"
+#include "position_cache.h"
+#include "safe_bool.h"
+#include "version.h"
 
+#define MAX_VARIATION_DEPTH 256 // alternative moves nested deeper make the game malformed
 #define MAX_EN_PASSANT 8
 #define N_EN_PASSANT_BITS 4 // 0 min to 8 en passant max, thus 9 possibilities = 4 bits
 
@@ -10,4 +21,125 @@ struct en_passant_header {
     bool has_en_passant_extra_ep_notation[MAX_EN_PASSANT];
 };
 
+/**
+ * Called on every token in the order of the stream, alternative moves being announced by a beginning token and closed by an end token.
+ * The token is freed after the call, a comment must be copied to be kept, unless it comes from the arena of the options.
+ */
+typedef void (*token_visitor)(const struct pgn_token* token, void* data);
+
+/**
+ * State of the range decoder of an arithmetic coded game, shared by its main line and its alternative moves.
+ */
+struct arithmetic_decoder {
+    struct range_decoder decoder;
+    struct move_model model;
+};
+
+struct uncompress_options {
+    bool print; // prints the tags and the tokens
+    struct position_cache* cache; // shared by the games of a container, may be NULL
+    token_visitor on_token; // may be NULL
+    void* token_data;
+    enum move_coding coding; // set from the version of each game while parsing it
+    struct arithmetic_decoder* arithmetic; // set while parsing an arithmetic coded game
+    const struct token_huffman* huffman; // token type codes of the container header, NULL if it has none
+    const struct opening_trie* trie; // opening trie of the container header, NULL if it has none
+    bool variation_lengths; // alternative moves start with their length, cleared for arithmetic coded games
+    bool mainline_only; // alternative moves are neither visited nor printed, and skipped without being parsed if they have their length
+    struct arena* arena; // comments are allocated from it, and live as long as it, instead of being freed after their visit, may be NULL
+    bool log; // logs the parsing, there's no global switch so that each decoding has its own
+};
+
+/**
+ * Bit offsets of the parts of a game in its container.
+ */
+struct game_layout {
+    uint8_t version;
+    size_t start;
+    size_t tags_start; // a duplicate game keeps its own tags right after its reference, the rest of the layout is the one of its first occurrence
+    size_t tags_end;
+    size_t en_passant_start;
+    size_t opening_start; // same as checkpoints_start if the game doesn't start from the opening trie
+    size_t opening_node; // 0, the starting position, if the game doesn't start from the opening trie
+    size_t checkpoints_start; // same as moves_start if there's no checkpoint table
+    size_t moves_start;
+    size_t end; // right after the end of the game token, or the end of the buffer
+};
+
+/**
+ * Called on each position of the main line of a game, ply 0 being the starting position.
+ * bit_offset is the offset in the container right after the move of the ply (the first move for ply 0).
+ */
+typedef void (*position_visitor)(const struct board_state* state, unsigned ply, size_t bit_offset, void* data);
+
+/**
+ * A container is made of games stored back to back, each one starting on a byte boundary after the end of the previous game,
+ * after the container header if there is one (see container.h).
+ * Parses the next game and replays its main line, layout and visitor may be NULL.
+ * A duplicate game is replayed from its first occurrence, which the layout and the bit offsets then refer to.
+ * Returns ERROR if the game is malformed, TRUE otherwise, the buffer is then at the start of the next game.
+ */
+enum safe_bool uncompress_game(struct compressed_buf* buf, const struct uncompress_options* options, struct game_layout* layout, position_visitor visitor, void* data);
+
+/**
+ * Copies the tags and the en passant header of a parsed game, so that it can be written again with other moves.
+ */
+bool copy_game_header(struct bit_writer* writer, const struct compressed_buf* buf, const struct game_layout* layout);
+
+/**
+ * Replays the main line of the next game up to the given ply, starting from the nearest checkpoint before it if the game has some.
+ * Returns TRUE if the ply is reached, FALSE if the game is shorter, ERROR if the game is malformed.
+ * Unless ERROR is returned, the state must be freed with free_board_state. The buffer is left in the middle of the game.
+ */
+enum safe_bool seek_game_to_ply(struct compressed_buf* buf, const struct uncompress_options* options, unsigned ply, struct board_state* board_state);
+
+/**
+ * Alternative moves being replayed, innermost last, their board states being kept by the board state.
+ */
+struct variation_stack {
+    struct variation_frame {
+        size_t start; // bit offset right after the length
+        uint64_t length; // 0 if the container has no variation lengths
+    } frames[MAX_VARIATION_DEPTH];
+    size_t depth;
+};
+
+/**
+ * Game decoded one token at a time, see start_game_replay. It must not be moved, its options referring to its range decoder.
+ */
+struct game_replay {
+    struct compressed_buf* buf;
+    struct uncompress_options options; // of the game
+    struct arithmetic_decoder arithmetic;
+    struct game_layout layout;
+    struct board_state state;
+    struct variation_stack variations;
+    size_t opening_path[MAX_OPENING_PLIES]; // opening trie nodes not yet visited, the next one last
+    unsigned n_opening_nodes;
+    size_t next_game; // bit offset right after the reference of a duplicate game
+    bool is_duplicate;
+    bool is_over;
+};
+
+/**
+ * Parses the header of the next game, whose tokens are then decoded by replay_next_token, the visitor and print of the options being ignored.
+ * Returns ERROR if the header is malformed, TRUE otherwise, the replay must then be ended with end_game_replay.
+ */
+enum safe_bool start_game_replay(struct compressed_buf* buf, const struct uncompress_options* options, struct game_replay* replay);
+
+/**
+ * Decodes the next token of the game, in the order of the stream, the moves leading to its opening trie node coming first.
+ * Returns TRUE if there's one, FALSE once the game is over, the buffer being then at the start of the next game, ERROR if it's malformed.
+ * A comment must be freed with free_token, unless it comes from the arena of the options.
+ */
+enum safe_bool replay_next_token(struct game_replay* replay, struct pgn_token* token);
+void end_game_replay(struct game_replay* replay);
+
+void free_token(struct pgn_token* token);
+
+/**
+ * Returns if there's another game in the container, padding bits after the last game are ignored.
+ */
+PGN_API bool has_next_game(const struct compressed_buf* buf);
+
 int uncompress(const struct args* args);
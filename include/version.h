@@ -0,0 +1,43 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Each game starts with a version byte telling how the rest of the game is stored :
+ * bit 0 is set if there's a checkpoint table, bits 1 to 3 are the move coding,
+ * bit 4 is set if the token types use the Huffman code of the container header,
+ * bit 5 is set if the game starts from a node of the opening trie of the container header, other bits must be 0.
+ * A duplicate game is its version byte, set to VERSION_DUPLICATE, followed by the byte offset of the first occurrence
+ * of the game in the container, on DUPLICATE_OFFSET_BITS bits, and by its own tags, the rest being the one of the first occurrence.
+ */
+#define VERSION_CHECKPOINTS 0x1
+#define VERSION_MOVE_CODING_SHIFT 1
+#define VERSION_MOVE_CODING_MASK 0x7
+#define VERSION_HUFFMAN_TOKENS 0x10
+#define VERSION_OPENING_TRIE 0x20
+#define VERSION_DUPLICATE 0x40
+#define DUPLICATE_OFFSET_BITS 40
+
+enum move_coding {
+    PREFIX_CODING, // piece type, destination square and disambiguation bits, see the README
+    LEGAL_INDEX_CODING, // index of the move among the legal moves
+    ARITHMETIC_CODING, // rank of the move among the legal moves sorted by likelihood, with an adaptive range coder
+    DESTINATION_CODING, // same as the prefix coding, except for the destination which is an index among the squares the pieces of its type can reach
+    N_MOVE_CODINGS
+};
+
+extern const char* MOVE_CODING_NAMES[N_MOVE_CODINGS];
+
+uint8_t make_version(enum move_coding coding, bool has_checkpoints);
+enum move_coding version_move_coding(uint8_t version);
+bool is_version_valid(uint8_t version);
+
+/**
+ * Whether the tokens of the coding start with their type, as in the prefix coding, which can then be Huffman coded.
+ */
+bool has_token_type_prefix(enum move_coding coding);
+
+/**
+ * Finds a move coding by its name, returns false if there's none.
+ */
+bool move_coding_from_name(const char* name, enum move_coding* coding);
@@ -0,0 +1,30 @@
+#pragma once
+#include <stdint.h>
+
+#include "piece.h"
+
+/**
+ * Every piece on every square, the side to move, each castling rights combination and each en passant file have a pseudo-random 64 bits key.
+ * The key of a position is the xor of the keys of what it contains, so that a move only xors in and out the few keys it changes.
+ */
+
+zobrist_key zobrist_piece_key(struct piece piece, uint8_t square);
+zobrist_key zobrist_castling_key(uint8_t castling_rights);
+zobrist_key zobrist_en_passant_key(int en_passant_file);
+zobrist_key zobrist_black_to_move_key(void);
+
+/**
+ * Returns if a pawn of the player can capture en passant on the given file, i.e. the en passant file matters for the position identity.
+ */
+bool can_capture_en_passant(const struct bitboards* bitboards, enum player player, int en_passant_file);
+
+/**
+ * Key of a position given by its parts, see position_key.
+ */
+zobrist_key position_key_of(const struct bitboards* bitboards, enum player player_to_move, uint8_t castling_rights, int en_passant_file);
+
+/**
+ * Key of the whole position : pieces, side to move, castling rights, and en passant file only if a capture is possible.
+ * The pieces part is maintained by the bitboards, so this is only a few xors.
+ */
+zobrist_key position_key(const struct board_state* state);
@@ -1,31 +1,144 @@
-#include <memory.h>
+#include <stdlib.h>
 
 #include "../include/apply_move.h"
-#include "../include/debug.h"
+#include "../include/bitboard.h"
 #include "../include/king.h"
-#include "../include/log.h"
-#include "../include/source_location.h"
 
 void move_piece(board board, const struct coord* from, const struct coord* to) {
     struct piece* const board_from = board_at_coord(board, *from);
 
     *board_at_coord(board, *to) = *board_from;
-    *board_from = (struct piece){ .player = INVALID_PLAYER, .type = EMPTY_SQUARE };
+    *board_from = EMPTY_PIECE;
 }
 
-static void apply_castling(const struct pgn_token* token, board board) {
-    const struct move move = token->move.move;
-    const struct king_move_infos castling = move.extra_infos.infos.king_infos;
+bool is_token_a_move(enum token_type type) {
+    switch (type) {
+        case MOVE_BISHOP:
+        case MOVE_KING:
+        case MOVE_KNIGHT:
+        case MOVE_PAWN:
+        case MOVE_QUEEN:
+        case MOVE_ROOK:
+        case CASTLING:
+        case PROMOTION:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+// moves a piece to an empty square, on both the board and the bitboards
+static void move_piece_and_bitboards(board board, struct bitboards* bitboards, const struct coord* from, const struct coord* to) {
+    const struct piece piece = *board_at_coord(board, *from);
+
+    bitboards_remove_piece(bitboards, piece, coord_to_square(*from));
+    bitboards_add_piece(bitboards, piece, coord_to_square(*to));
+    move_piece(board, from, to);
+}
+
+void make_move(board board, struct bitboards* bitboards, const struct coord* from, const struct coord* to, enum piece_type promotion_piece, struct move_undo* undo) {
+    struct piece* const board_from = board_at_coord(board, *from);
+    struct piece* const board_to = board_at_coord(board, *to);
+
+    *undo = (struct move_undo) {
+        .from = *from,
+        .to = *to,
+        .captured = *board_to,
+        .flags = MOVE_UNDO_NONE
+    };
+    if (board_to->type != EMPTY_SQUARE) {
+        bitboards_remove_piece(bitboards, *board_to, coord_to_square(*to));
+    } else if (board_from->type == PAWN && from->file != to->file) {
+        const struct coord en_passant_coord = { .file = to->file, .rank = from->rank };
+        struct piece* const en_passant_pawn = board_at_coord(board, en_passant_coord);
+        undo->captured = *en_passant_pawn;
+        undo->flags |= MOVE_UNDO_EN_PASSANT;
+        bitboards_remove_piece(bitboards, *en_passant_pawn, coord_to_square(en_passant_coord));
+        *en_passant_pawn = EMPTY_PIECE;
+    }
+    bitboards_remove_piece(bitboards, *board_from, coord_to_square(*from));
+    move_piece(board, from, to);
+    if (promotion_piece != EMPTY_SQUARE) {
+        board_to->type = promotion_piece;
+        undo->flags |= MOVE_UNDO_PROMOTION;
+    }
+    bitboards_add_piece(bitboards, *board_to, coord_to_square(*to));
+}
 
-    move_piece(board, &king_starting_coords[move.player], &king_ending_coords[move.player][castling.castling]);
-    move_piece(board, &rook_starting_coords[move.player][castling.castling], &rook_ending_coords[move.player][castling.castling]);
+void make_castling(board board, struct bitboards* bitboards, enum player player, enum castling castling, struct move_undo* undo) {
+    *undo = (struct move_undo) {
+        .from = king_starting_coords[player],
+        .to = king_ending_coords[player][castling],
+        .captured = EMPTY_PIECE,
+        .flags = MOVE_UNDO_CASTLING
+    };
+    move_piece_and_bitboards(board, bitboards, &king_starting_coords[player], &king_ending_coords[player][castling]);
+    move_piece_and_bitboards(board, bitboards, &rook_starting_coords[player][castling], &rook_ending_coords[player][castling]);
 }
 
-void apply_move_impl(const struct pgn_token* token, board board) {
-    move_piece(board, &token->move.move.from, &token->move.move.to);
+void unmake_move(board board, struct bitboards* bitboards, const struct move_undo* undo) {
+    if (undo->from.file == INVALID_COORD) {
+        return;
+    }
+
+    if (undo->flags & MOVE_UNDO_CASTLING) {
+        const enum player player = board_at_coord(board, undo->to)->player;
+        const enum castling castling = undo->to.file == king_ending_coords[player][KINGSIDE].file ? KINGSIDE : QUEENSIDE;
+        move_piece_and_bitboards(board, bitboards, &undo->to, &undo->from);
+        move_piece_and_bitboards(board, bitboards, &rook_ending_coords[player][castling], &rook_starting_coords[player][castling]);
+        return;
+    }
+
+    struct piece* const board_to = board_at_coord(board, undo->to);
+    struct piece* const board_from = board_at_coord(board, undo->from);
+    bitboards_remove_piece(bitboards, *board_to, coord_to_square(undo->to));
+    *board_from = *board_to;
+    if (undo->flags & MOVE_UNDO_PROMOTION) {
+        board_from->type = PAWN;
+    }
+    bitboards_add_piece(bitboards, *board_from, coord_to_square(undo->from));
+
+    const struct coord captured_coord = (undo->flags & MOVE_UNDO_EN_PASSANT) ?
+        (struct coord) { .file = undo->to.file, .rank = undo->from.rank } :
+        undo->to;
+    *board_to = EMPTY_PIECE;
+    *board_at_coord(board, captured_coord) = undo->captured;
+    if (undo->captured.type != EMPTY_SQUARE) {
+        bitboards_add_piece(bitboards, undo->captured, coord_to_square(captured_coord));
+    }
+}
+
+int en_passant_file_after(board board, const struct move_undo* undo) {
+    if (undo->from.file == INVALID_COORD || (undo->flags & MOVE_UNDO_CASTLING)) {
+        return INVALID_COORD;
+    } else if (board_at_coord(board, undo->to)->type != PAWN || abs(undo->to.rank - undo->from.rank) != 2) {
+        return INVALID_COORD;
+    }
+    return undo->to.file;
 }
 
-void apply_move_on_raw_board(const struct pgn_token* token, board board) {
+uint8_t castling_rights_after(uint8_t castling_rights, const struct move_undo* undo) {
+    if (undo->from.file == INVALID_COORD) {
+        return castling_rights;
+    }
+
+    // moving the king or a rook, or capturing a rook, on its starting square loses the right for good
+    for (enum player player = WHITE; player <= BLACK; player++) {
+        for (enum castling castling = KINGSIDE; castling < CASTLING_SIZE; castling++) {
+            const struct coord* const king = &king_starting_coords[player];
+            const struct coord* const rook = &rook_starting_coords[player][castling];
+            if (are_coords_equal(&undo->from, king) || are_coords_equal(&undo->from, rook) || are_coords_equal(&undo->to, rook)) {
+                castling_rights &= ~CASTLING_RIGHT(player, castling);
+            }
+        }
+    }
+    return castling_rights;
+}
+
+void apply_move_on_raw_board(const struct pgn_token* token, board board, struct bitboards* bitboards, struct move_undo* undo) {
+    const struct move* const move = &token->move.move;
+
     switch (token->type) {
         case MOVE_BISHOP:
         case MOVE_KING:
@@ -33,23 +146,34 @@ void apply_move_on_raw_board(const struct pgn_token* token, board board) {
         case MOVE_PAWN:
         case MOVE_QUEEN:
         case MOVE_ROOK:
-            apply_move_impl(token, board);
+            make_move(board, bitboards, &move->from, &move->to, EMPTY_SQUARE, undo);
+            return;
+
+        case PROMOTION:
+            make_move(board, bitboards, &move->from, &move->to, move->extra_infos.infos.pawn_infos.promotion_piece, undo);
             return;
 
         case CASTLING:
-            apply_castling(token, board);
+            make_castling(board, bitboards, move->player, move->extra_infos.infos.king_infos.castling, undo);
             return;
 
         default:
+            *undo = EMPTY_MOVE_UNDO;
             return;
     }
 }
 
-void apply_move(const struct pgn_token* token, struct board_state* state) {
-    memcpy(state->previous_board, state->board, sizeof(board));
-    LOG_FROM(LOC_HERE, "Saving board :");
-    print_board(state->previous_board);
-    apply_move_on_raw_board(token, state->board);
-    LOG_FROM(LOC_HERE, "Board after move :");
-    print_board(state->board);
+bool apply_move(const struct pgn_token* token, struct board_state* state) {
+    if (!is_token_a_move(token->type)) {
+        return true; // keeps the last move, as alternative moves may follow a comment or a NAG
+    }
+    const uint8_t castling_rights = state->castling_rights;
+    const int8_t en_passant_file = state->en_passant_file;
+
+    apply_move_on_raw_board(token, state->board, &state->bitboards, &state->last_move);
+    state->last_move.castling_rights = castling_rights;
+    state->last_move.en_passant_file = en_passant_file;
+    state->castling_rights = castling_rights_after(castling_rights, &state->last_move);
+    state->en_passant_file = en_passant_file_after(state->board, &state->last_move);
+    return board_log_last_move(state);
 }
@@ -0,0 +1,47 @@
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "../include/arena.h"
+#include "../include/error.h"
+
+void arena_init(struct arena* arena) {
+    arena->chunk = NULL;
+}
+
+void arena_free(struct arena* arena) {
+    while (arena->chunk != NULL) {
+        struct arena_chunk* const previous = arena->chunk->previous;
+        free(arena->chunk);
+        arena->chunk = previous;
+    }
+}
+
+// bytes to skip from the first free byte of the chunk so that the allocation is aligned
+static size_t alignment_padding(const struct arena_chunk* chunk) {
+    const uintptr_t address = (uintptr_t)(chunk->data + chunk->used);
+    return (ARENA_ALIGNMENT - address % ARENA_ALIGNMENT) % ARENA_ALIGNMENT;
+}
+
+void* arena_alloc(struct arena* arena, size_t size) {
+    struct arena_chunk* chunk = arena->chunk;
+    if (chunk == NULL || chunk->size - chunk->used < alignment_padding(chunk) + size) {
+        // a bigger allocation gets a chunk of its own
+        const size_t data_size = size + ARENA_ALIGNMENT > ARENA_CHUNK_SIZE ? size + ARENA_ALIGNMENT : ARENA_CHUNK_SIZE;
+        chunk = malloc(sizeof(struct arena_chunk) + data_size);
+        if (chunk == NULL) {
+            errprintf("Cannot allocate an arena chunk of %zu bytes !\n", data_size);
+            return NULL;
+        }
+        *chunk = (struct arena_chunk) {
+            .previous = arena->chunk,
+            .size = data_size,
+            .used = 0
+        };
+        arena->chunk = chunk;
+    }
+
+    chunk->used += alignment_padding(chunk);
+    void* const allocation = chunk->data + chunk->used;
+    chunk->used += size;
+    return allocation;
+}
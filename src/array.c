@@ -23,7 +23,7 @@ void* expand_array_if_needed(void* arr, size_t n_elems, size_t elem_size, size_t
         errprintf("Error while reallocating %zu bytes !\n", new_size * elem_size);
         return NULL;
     }
-    memset((uint8_t*)expanded_arr + n_elems, 0, elem_size * (new_size - n_elems));
+    memset((uint8_t*)expanded_arr + n_elems * elem_size, 0, elem_size * (new_size - n_elems));
     *size_threshold = new_size;
     return expanded_arr;
 }
@@ -0,0 +1,390 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/bitboard.h"
+#include "../include/coord_constants.h"
+#include "../include/zobrist.h"
+
+const bitboard KNIGHT_ATTACKS[N_SQUARES] = {
+    0x0000000000020400ULL, 0x0000000000050800ULL, 0x00000000000A1100ULL, 0x0000000000142200ULL,
+    0x0000000000284400ULL, 0x0000000000508800ULL, 0x0000000000A01000ULL, 0x0000000000402000ULL,
+    0x0000000002040004ULL, 0x0000000005080008ULL, 0x000000000A110011ULL, 0x0000000014220022ULL,
+    0x0000000028440044ULL, 0x0000000050880088ULL, 0x00000000A0100010ULL, 0x0000000040200020ULL,
+    0x0000000204000402ULL, 0x0000000508000805ULL, 0x0000000A1100110AULL, 0x0000001422002214ULL,
+    0x0000002844004428ULL, 0x0000005088008850ULL, 0x000000A0100010A0ULL, 0x0000004020002040ULL,
+    0x0000020400040200ULL, 0x0000050800080500ULL, 0x00000A1100110A00ULL, 0x0000142200221400ULL,
+    0x0000284400442800ULL, 0x0000508800885000ULL, 0x0000A0100010A000ULL, 0x0000402000204000ULL,
+    0x0002040004020000ULL, 0x0005080008050000ULL, 0x000A1100110A0000ULL, 0x0014220022140000ULL,
+    0x0028440044280000ULL, 0x0050880088500000ULL, 0x00A0100010A00000ULL, 0x0040200020400000ULL,
+    0x0204000402000000ULL, 0x0508000805000000ULL, 0x0A1100110A000000ULL, 0x1422002214000000ULL,
+    0x2844004428000000ULL, 0x5088008850000000ULL, 0xA0100010A0000000ULL, 0x4020002040000000ULL,
+    0x0400040200000000ULL, 0x0800080500000000ULL, 0x1100110A00000000ULL, 0x2200221400000000ULL,
+    0x4400442800000000ULL, 0x8800885000000000ULL, 0x100010A000000000ULL, 0x2000204000000000ULL,
+    0x0004020000000000ULL, 0x0008050000000000ULL, 0x00110A0000000000ULL, 0x0022140000000000ULL,
+    0x0044280000000000ULL, 0x0088500000000000ULL, 0x0010A00000000000ULL, 0x0020400000000000ULL
+};
+
+const bitboard KING_ATTACKS[N_SQUARES] = {
+    0x0000000000000302ULL, 0x0000000000000705ULL, 0x0000000000000E0AULL, 0x0000000000001C14ULL,
+    0x0000000000003828ULL, 0x0000000000007050ULL, 0x000000000000E0A0ULL, 0x000000000000C040ULL,
+    0x0000000000030203ULL, 0x0000000000070507ULL, 0x00000000000E0A0EULL, 0x00000000001C141CULL,
+    0x0000000000382838ULL, 0x0000000000705070ULL, 0x0000000000E0A0E0ULL, 0x0000000000C040C0ULL,
+    0x0000000003020300ULL, 0x0000000007050700ULL, 0x000000000E0A0E00ULL, 0x000000001C141C00ULL,
+    0x0000000038283800ULL, 0x0000000070507000ULL, 0x00000000E0A0E000ULL, 0x00000000C040C000ULL,
+    0x0000000302030000ULL, 0x0000000705070000ULL, 0x0000000E0A0E0000ULL, 0x0000001C141C0000ULL,
+    0x0000003828380000ULL, 0x0000007050700000ULL, 0x000000E0A0E00000ULL, 0x000000C040C00000ULL,
+    0x0000030203000000ULL, 0x0000070507000000ULL, 0x00000E0A0E000000ULL, 0x00001C141C000000ULL,
+    0x0000382838000000ULL, 0x0000705070000000ULL, 0x0000E0A0E0000000ULL, 0x0000C040C0000000ULL,
+    0x0003020300000000ULL, 0x0007050700000000ULL, 0x000E0A0E00000000ULL, 0x001C141C00000000ULL,
+    0x0038283800000000ULL, 0x0070507000000000ULL, 0x00E0A0E000000000ULL, 0x00C040C000000000ULL,
+    0x0302030000000000ULL, 0x0705070000000000ULL, 0x0E0A0E0000000000ULL, 0x1C141C0000000000ULL,
+    0x3828380000000000ULL, 0x7050700000000000ULL, 0xE0A0E00000000000ULL, 0xC040C00000000000ULL,
+    0x0203000000000000ULL, 0x0507000000000000ULL, 0x0A0E000000000000ULL, 0x141C000000000000ULL,
+    0x2838000000000000ULL, 0x5070000000000000ULL, 0xA0E0000000000000ULL, 0x40C0000000000000ULL
+};
+
+const bitboard PAWN_ATTACKS[PLAYER_SIZE][N_SQUARES] = {
+    [WHITE] = {
+        0x0000000000000200ULL, 0x0000000000000500ULL, 0x0000000000000A00ULL, 0x0000000000001400ULL,
+        0x0000000000002800ULL, 0x0000000000005000ULL, 0x000000000000A000ULL, 0x0000000000004000ULL,
+        0x0000000000020000ULL, 0x0000000000050000ULL, 0x00000000000A0000ULL, 0x0000000000140000ULL,
+        0x0000000000280000ULL, 0x0000000000500000ULL, 0x0000000000A00000ULL, 0x0000000000400000ULL,
+        0x0000000002000000ULL, 0x0000000005000000ULL, 0x000000000A000000ULL, 0x0000000014000000ULL,
+        0x0000000028000000ULL, 0x0000000050000000ULL, 0x00000000A0000000ULL, 0x0000000040000000ULL,
+        0x0000000200000000ULL, 0x0000000500000000ULL, 0x0000000A00000000ULL, 0x0000001400000000ULL,
+        0x0000002800000000ULL, 0x0000005000000000ULL, 0x000000A000000000ULL, 0x0000004000000000ULL,
+        0x0000020000000000ULL, 0x0000050000000000ULL, 0x00000A0000000000ULL, 0x0000140000000000ULL,
+        0x0000280000000000ULL, 0x0000500000000000ULL, 0x0000A00000000000ULL, 0x0000400000000000ULL,
+        0x0002000000000000ULL, 0x0005000000000000ULL, 0x000A000000000000ULL, 0x0014000000000000ULL,
+        0x0028000000000000ULL, 0x0050000000000000ULL, 0x00A0000000000000ULL, 0x0040000000000000ULL,
+        0x0200000000000000ULL, 0x0500000000000000ULL, 0x0A00000000000000ULL, 0x1400000000000000ULL,
+        0x2800000000000000ULL, 0x5000000000000000ULL, 0xA000000000000000ULL, 0x4000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL
+    },
+    [BLACK] = {
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000000002ULL, 0x0000000000000005ULL, 0x000000000000000AULL, 0x0000000000000014ULL,
+        0x0000000000000028ULL, 0x0000000000000050ULL, 0x00000000000000A0ULL, 0x0000000000000040ULL,
+        0x0000000000000200ULL, 0x0000000000000500ULL, 0x0000000000000A00ULL, 0x0000000000001400ULL,
+        0x0000000000002800ULL, 0x0000000000005000ULL, 0x000000000000A000ULL, 0x0000000000004000ULL,
+        0x0000000000020000ULL, 0x0000000000050000ULL, 0x00000000000A0000ULL, 0x0000000000140000ULL,
+        0x0000000000280000ULL, 0x0000000000500000ULL, 0x0000000000A00000ULL, 0x0000000000400000ULL,
+        0x0000000002000000ULL, 0x0000000005000000ULL, 0x000000000A000000ULL, 0x0000000014000000ULL,
+        0x0000000028000000ULL, 0x0000000050000000ULL, 0x00000000A0000000ULL, 0x0000000040000000ULL,
+        0x0000000200000000ULL, 0x0000000500000000ULL, 0x0000000A00000000ULL, 0x0000001400000000ULL,
+        0x0000002800000000ULL, 0x0000005000000000ULL, 0x000000A000000000ULL, 0x0000004000000000ULL,
+        0x0000020000000000ULL, 0x0000050000000000ULL, 0x00000A0000000000ULL, 0x0000140000000000ULL,
+        0x0000280000000000ULL, 0x0000500000000000ULL, 0x0000A00000000000ULL, 0x0000400000000000ULL,
+        0x0002000000000000ULL, 0x0005000000000000ULL, 0x000A000000000000ULL, 0x0014000000000000ULL,
+        0x0028000000000000ULL, 0x0050000000000000ULL, 0x00A0000000000000ULL, 0x0040000000000000ULL
+    }
+};
+
+struct direction {
+    int file;
+    int rank;
+};
+
+static const struct direction BISHOP_DIRECTIONS[4] = {
+    { .file = 1, .rank = 1 },
+    { .file = 1, .rank = -1 },
+    { .file = -1, .rank = 1 },
+    { .file = -1, .rank = -1 }
+};
+
+static const struct direction ROOK_DIRECTIONS[4] = {
+    { .file = 1, .rank = 0 },
+    { .file = -1, .rank = 0 },
+    { .file = 0, .rank = 1 },
+    { .file = 0, .rank = -1 }
+};
+
+static bool is_coord_on_board(struct coord coord) {
+    return coord.file >= 0 && coord.file < BOARD_SIZE && coord.rank >= 0 && coord.rank < BOARD_SIZE;
+}
+
+static int sign(int n) {
+    return (n > 0) - (n < 0);
+}
+
+uint8_t coord_to_square(struct coord coord) {
+    return coord.rank * BOARD_SIZE + coord.file;
+}
+
+struct coord square_to_coord(uint8_t square) {
+    return (struct coord) {
+        .file = square % BOARD_SIZE,
+        .rank = square / BOARD_SIZE
+    };
+}
+
+bitboard square_bit(uint8_t square) {
+    return (bitboard)1 << square;
+}
+
+bitboard coord_bit(struct coord coord) {
+    return square_bit(coord_to_square(coord));
+}
+
+uint8_t count_squares(bitboard bitboard) {
+    return __builtin_popcountll(bitboard);
+}
+
+uint8_t pop_lowest_square(bitboard* bitboard) {
+    const uint8_t square = __builtin_ctzll(*bitboard);
+    *bitboard &= *bitboard - 1;
+    return square;
+}
+
+uint8_t count_squares_below(bitboard bitboard, uint8_t square) {
+    return count_squares(bitboard & (square_bit(square) - 1));
+}
+
+uint8_t nth_square(bitboard bitboard, uint8_t n) {
+    while (bitboard) {
+        const uint8_t square = pop_lowest_square(&bitboard);
+        if (n-- == 0) {
+            return square;
+        }
+    }
+    return N_SQUARES;
+}
+
+static bitboard ray_attacks(uint8_t square, bitboard occupied, const struct direction directions[4]) {
+    bitboard attacks = EMPTY_BITBOARD;
+
+    for (uint8_t i = 0; i < 4; i++) {
+        struct coord coord = square_to_coord(square);
+        while (true) {
+            coord.file += directions[i].file;
+            coord.rank += directions[i].rank;
+            if (!is_coord_on_board(coord)) {
+                break;
+            }
+            const bitboard bit = coord_bit(coord);
+            attacks |= bit;
+            if (occupied & bit) { // sliding pieces stop on the first piece they meet
+                break;
+            }
+        }
+    }
+    return attacks;
+}
+
+bitboard bishop_attacks(uint8_t square, bitboard occupied) {
+    return ray_attacks(square, occupied, BISHOP_DIRECTIONS);
+}
+
+bitboard rook_attacks(uint8_t square, bitboard occupied) {
+    return ray_attacks(square, occupied, ROOK_DIRECTIONS);
+}
+
+bitboard queen_attacks(uint8_t square, bitboard occupied) {
+    return bishop_attacks(square, occupied) | rook_attacks(square, occupied);
+}
+
+bitboard piece_attacks(enum piece_type piece, enum player player, uint8_t square, bitboard occupied) {
+    switch (piece) {
+        case KING: return KING_ATTACKS[square];
+        case QUEEN: return queen_attacks(square, occupied);
+        case BISHOP: return bishop_attacks(square, occupied);
+        case KNIGHT: return KNIGHT_ATTACKS[square];
+        case ROOK: return rook_attacks(square, occupied);
+        case PAWN: return PAWN_ATTACKS[player][square];
+        default: return EMPTY_BITBOARD;
+    }
+}
+
+// fails if both squares aren't on the same line or diagonal
+static bool direction_between(uint8_t first, uint8_t second, struct direction* direction) {
+    const struct coord from = square_to_coord(first);
+    const struct coord to = square_to_coord(second);
+    const int file_diff = to.file - from.file;
+    const int rank_diff = to.rank - from.rank;
+
+    if (first == second) {
+        return false;
+    } else if (file_diff != 0 && rank_diff != 0 && abs(file_diff) != abs(rank_diff)) {
+        return false;
+    }
+    *direction = (struct direction) {
+        .file = sign(file_diff),
+        .rank = sign(rank_diff)
+    };
+    return true;
+}
+
+bitboard squares_between(uint8_t first, uint8_t second) {
+    struct direction direction;
+    if (!direction_between(first, second, &direction)) {
+        return EMPTY_BITBOARD;
+    }
+
+    bitboard between = EMPTY_BITBOARD;
+    struct coord coord = square_to_coord(first);
+    const struct coord end = square_to_coord(second);
+    while (true) {
+        coord.file += direction.file;
+        coord.rank += direction.rank;
+        if (are_coords_equal(&coord, &end)) {
+            return between;
+        }
+        between |= coord_bit(coord);
+    }
+}
+
+bitboard line_through(uint8_t first, uint8_t second) {
+    struct direction direction;
+    if (!direction_between(first, second, &direction)) {
+        return EMPTY_BITBOARD;
+    }
+
+    bitboard line = square_bit(first);
+    for (int way = -1; way <= 1; way += 2) {
+        struct coord coord = square_to_coord(first);
+        while (true) {
+            coord.file += way * direction.file;
+            coord.rank += way * direction.rank;
+            if (!is_coord_on_board(coord)) {
+                break;
+            }
+            line |= coord_bit(coord);
+        }
+    }
+    return line;
+}
+
+void compute_bitboards(board board, struct bitboards* bitboards) {
+    memset(bitboards, 0, sizeof(struct bitboards));
+    for (enum player player = 0; player < PLAYER_SIZE; player++) {
+        bitboards->king_square[player] = N_SQUARES;
+    }
+
+    for (uint8_t square = 0; square < N_SQUARES; square++) {
+        const struct piece* const piece = board_at_coord(board, square_to_coord(square));
+        if (piece->type != EMPTY_SQUARE) {
+            bitboards_add_piece(bitboards, *piece, square);
+        }
+    }
+}
+
+void bitboards_add_piece(struct bitboards* bitboards, struct piece piece, uint8_t square) {
+    if (piece.type == EMPTY_SQUARE) {
+        return;
+    }
+    bitboards->pieces[piece.player][piece.type] |= square_bit(square);
+    bitboards->occupied[piece.player] |= square_bit(square);
+    bitboards->pieces_key ^= zobrist_piece_key(piece, square);
+    if (piece.type == KING) {
+        bitboards->king_square[piece.player] = square;
+    }
+}
+
+void bitboards_remove_piece(struct bitboards* bitboards, struct piece piece, uint8_t square) {
+    if (piece.type == EMPTY_SQUARE) {
+        return;
+    }
+    bitboards->pieces[piece.player][piece.type] &= ~square_bit(square);
+    bitboards->occupied[piece.player] &= ~square_bit(square);
+    bitboards->pieces_key ^= zobrist_piece_key(piece, square);
+    if (piece.type == KING && bitboards->king_square[piece.player] == square) {
+        bitboards->king_square[piece.player] = N_SQUARES;
+    }
+}
+
+bitboard all_occupied(const struct bitboards* bitboards) {
+    return bitboards->occupied[WHITE] | bitboards->occupied[BLACK];
+}
+
+bitboard attackers_of(const struct bitboards* bitboards, uint8_t square, enum player attacker, bitboard occupied) {
+    const bitboard* const pieces = bitboards->pieces[attacker];
+
+    return
+        (PAWN_ATTACKS[opponent_player(attacker)][square] & pieces[PAWN]) | // a pawn attacks the square if a pawn of the opponent on this square would attack the pawn
+        (KNIGHT_ATTACKS[square] & pieces[KNIGHT]) |
+        (KING_ATTACKS[square] & pieces[KING]) |
+        (bishop_attacks(square, occupied) & (pieces[BISHOP] | pieces[QUEEN])) |
+        (rook_attacks(square, occupied) & (pieces[ROOK] | pieces[QUEEN]));
+}
+
+// pawns are the only pieces which don't move the way they attack, and pushes must go through empty squares
+static bitboard pawns_able_to_move_to(const struct bitboards* bitboards, enum player player, uint8_t to) {
+    const enum player opponent = opponent_player(player);
+    const bitboard pawns = bitboards->pieces[player][PAWN];
+    const int forward = player == WHITE ? BOARD_SIZE : -BOARD_SIZE;
+    const int to_rank = to / BOARD_SIZE;
+
+    if (bitboards->occupied[opponent] & square_bit(to)) {
+        return PAWN_ATTACKS[opponent][to] & pawns;
+    }
+
+    bitboard candidates = EMPTY_BITBOARD;
+    const int one_back = to - forward;
+    if (one_back >= 0 && one_back < N_SQUARES) {
+        if (pawns & square_bit(one_back)) {
+            candidates |= square_bit(one_back);
+        } else if (!(all_occupied(bitboards) & square_bit(one_back)) && to_rank == (player == WHITE ? RANK_4 : RANK_5)) {
+            candidates |= pawns & square_bit(one_back - forward);
+        }
+    }
+    // en passant, the captured pawn stands on the destination file, next to the starting square
+    if (to_rank == (player == WHITE ? RANK_6 : RANK_3) && (bitboards->pieces[opponent][PAWN] & square_bit(one_back))) {
+        candidates |= PAWN_ATTACKS[opponent][to] & pawns;
+    }
+    return candidates;
+}
+
+bitboard pieces_able_to_move_to(const struct bitboards* bitboards, enum player player, enum piece_type piece, uint8_t to) {
+    if (bitboards->occupied[player] & square_bit(to)) {
+        return EMPTY_BITBOARD;
+    } else if (piece == PAWN) {
+        return pawns_able_to_move_to(bitboards, player, to);
+    }
+    // every other piece attacks from the destination the squares it could come from
+    return piece_attacks(piece, player, to, all_occupied(bitboards)) & bitboards->pieces[player][piece];
+}
+
+static bitboard pawn_destinations(const struct bitboards* bitboards, enum player player, int en_passant_file) {
+    const enum player opponent = opponent_player(player);
+    const bitboard empty = ~all_occupied(bitboards);
+    const int forward = player == WHITE ? BOARD_SIZE : -BOARD_SIZE;
+    const int double_push_rank = player == WHITE ? RANK_4 : RANK_5;
+    bitboard pawns = bitboards->pieces[player][PAWN];
+    bitboard destinations = EMPTY_BITBOARD;
+
+    while (pawns) {
+        const uint8_t from = pop_lowest_square(&pawns);
+        const uint8_t one_forward = from + forward;
+        destinations |= PAWN_ATTACKS[player][from] & bitboards->occupied[opponent];
+        if (empty & square_bit(one_forward)) {
+            destinations |= square_bit(one_forward);
+            if (one_forward + forward >= 0 && one_forward + forward < N_SQUARES && (one_forward + forward) / BOARD_SIZE == double_push_rank) {
+                destinations |= empty & square_bit(one_forward + forward);
+            }
+        }
+    }
+    if (en_passant_file != INVALID_COORD) {
+        const uint8_t en_passant_square = (player == WHITE ? RANK_6 : RANK_3) * BOARD_SIZE + en_passant_file;
+        if (PAWN_ATTACKS[opponent][en_passant_square] & bitboards->pieces[player][PAWN]) {
+            destinations |= square_bit(en_passant_square);
+        }
+    }
+    const bitboard last_rank = (bitboard)0xFF << ((player == WHITE ? RANK_8 : RANK_1) * BOARD_SIZE);
+    return destinations & ~last_rank;
+}
+
+bitboard move_destinations(const struct bitboards* bitboards, enum player player, enum piece_type piece, int en_passant_file) {
+    if (piece == PAWN) {
+        return pawn_destinations(bitboards, player, en_passant_file);
+    }
+
+    const bitboard occupied = all_occupied(bitboards);
+    bitboard pieces = bitboards->pieces[player][piece];
+    bitboard destinations = EMPTY_BITBOARD;
+    while (pieces) {
+        destinations |= piece_attacks(piece, player, pop_lowest_square(&pieces), occupied);
+    }
+    return destinations & ~bitboards->occupied[player];
+}
@@ -1,6 +1,9 @@
 #include <ctype.h>
 #include <inttypes.h>
 #include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "../include/bits.h"
 #include "../include/log.h"
@@ -18,7 +21,7 @@ bool peek_n_bits(const struct compressed_buf* buf, uint8_t n_bits, uint8_t* n) {
     ASSERT_PRINTF(buf->remaining_bits >= n_bits, "Not enough bits to read !\nBuffer only has %zu but tried to read %" PRIu8 " !", buf->remaining_bits, n_bits);
 
     uint16_t next = buf->buf[buf->nth_byte] << 8;
-    if (n_bits >= 8 - buf->nth_bit) {
+    if (n_bits > 8 - buf->nth_bit) { // the next byte may be past the end of the buffer otherwise
         next |= buf->buf[buf->nth_byte + 1];
     }
 
@@ -52,6 +55,16 @@ bool read_n_bits(struct compressed_buf* buf, uint8_t n_bits, uint8_t* n) {
     return true;
 }
 
+void skip_to_next_byte(struct compressed_buf* buf) {
+    if (buf->nth_bit == 0) {
+        return;
+    }
+    const uint8_t skipped = 8 - buf->nth_bit;
+    buf->remaining_bits -= skipped < buf->remaining_bits ? skipped : buf->remaining_bits;
+    buf->nth_bit = 0;
+    buf->nth_byte++;
+}
+
 enum safe_bool memchr_bits(struct compressed_buf* buf, uint8_t byte, size_t* size) {
     ASSERT_PRINTF(buf != NULL, "Compressed buffer is NULL !");
     ASSERT_PRINTF(size != NULL, "size destination is NULL !");
@@ -131,11 +144,144 @@ bool make_compressed_buf(struct compressed_buf* dest, const uint8_t* buf, size_t
     return true;
 }
 
-uint8_t how_many_bits_to_hold_number(uint8_t n) {
+bool read_bits(struct compressed_buf* buf, uint8_t n_bits, uint64_t* n) {
+    ASSERT_PRINTF(n_bits <= 64, "Only 64 bits or less can be extracted at once, but %" PRIu8 " were requested !", n_bits);
+
+    *n = 0;
+    while (n_bits > 0) {
+        const uint8_t chunk_size = n_bits < 8 ? n_bits : 8;
+        uint8_t chunk;
+        if (!read_n_bits(buf, chunk_size, &chunk)) {
+            return false;
+        }
+        *n = (*n << chunk_size) | chunk;
+        n_bits -= chunk_size;
+    }
+    return true;
+}
+
+size_t bit_offset(const struct compressed_buf* buf) {
+    return buf->nth_byte * 8 + buf->nth_bit;
+}
+
+bool seek_bit_offset(struct compressed_buf* buf, size_t offset) {
+    ASSERT_PRINTF(offset <= buf->n_bytes * 8, "Cannot seek to bit %zu, the buffer only has %zu bits !", offset, buf->n_bytes * 8);
+
+    buf->nth_byte = offset / 8;
+    buf->nth_bit = offset % 8;
+    buf->remaining_bits = buf->n_bytes * 8 - offset;
+    return true;
+}
+
+bool bit_writer_init(struct bit_writer* writer) {
+    ASSERT_PRINTF(writer != NULL, "Bit writer is NULL !");
+
+    *writer = (struct bit_writer) {
+        .buf = calloc(BIT_WRITER_INITIAL_CAPACITY, 1),
+        .n_bits = 0,
+        .capacity = BIT_WRITER_INITIAL_CAPACITY
+    };
+    if (writer->buf == NULL) {
+        errprintf("Cannot allocate %d bytes !", BIT_WRITER_INITIAL_CAPACITY);
+        return false;
+    }
+    return true;
+}
+
+void bit_writer_free(struct bit_writer* writer) {
+    if (writer != NULL) {
+        free(writer->buf);
+        writer->buf = NULL;
+    }
+}
+
+void bit_writer_clear(struct bit_writer* writer) {
+    memset(writer->buf, 0, (writer->n_bits + 7) / 8); // bits are or'ed in
+    writer->n_bits = 0;
+}
+
+static bool write_bit(struct bit_writer* writer, bool bit) {
+    if (writer->n_bits == writer->capacity * 8) {
+        uint8_t* const expanded_buf = realloc(writer->buf, writer->capacity * 2);
+        if (expanded_buf == NULL) {
+            errprintf("Cannot allocate %zu bytes !", writer->capacity * 2);
+            return false;
+        }
+        memset(expanded_buf + writer->capacity, 0, writer->capacity);
+        writer->buf = expanded_buf;
+        writer->capacity *= 2;
+    }
+    if (bit) {
+        writer->buf[writer->n_bits / 8] |= 0x80 >> (writer->n_bits % 8);
+    }
+    writer->n_bits++;
+    return true;
+}
+
+bool write_bits(struct bit_writer* writer, uint8_t n_bits, uint64_t n) {
+    ASSERT_PRINTF(writer != NULL, "Bit writer is NULL !");
+    ASSERT_PRINTF(n_bits <= 64, "Only 64 bits or less can be written at once, but %" PRIu8 " were requested !", n_bits);
+
+    while (n_bits > 0) {
+        n_bits--;
+        if (!write_bit(writer, (n >> n_bits) & 1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool copy_bits(struct bit_writer* writer, const struct compressed_buf* src, size_t offset, size_t n_bits) {
+    struct compressed_buf copy = *src;
+    if (!seek_bit_offset(&copy, offset)) {
+        return false;
+    }
+    while (n_bits > 0) {
+        const uint8_t chunk_size = n_bits < 8 ? n_bits : 8;
+        uint8_t chunk;
+        if (!read_n_bits(&copy, chunk_size, &chunk) || !write_bits(writer, chunk_size, chunk)) {
+            return false;
+        }
+        n_bits -= chunk_size;
+    }
+    return true;
+}
+
+bool bit_writer_align(struct bit_writer* writer) {
+    while (writer->n_bits % 8 != 0) {
+        if (!write_bit(writer, false)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool write_string(struct bit_writer* writer, const char* string) {
+    do {
+        if (!write_bits(writer, 8, (uint8_t)*string)) {
+            return false;
+        }
+    } while (*string++ != '\0');
+    return true;
+}
+
+bool bit_writer_save(const struct bit_writer* writer, const char* path) {
+    const size_t n_bytes = writer->n_bits / 8;
+    FILE* const file = fopen(path, "wb");
+    bool status = file != NULL && fwrite(writer->buf, 1, n_bytes, file) == n_bytes;
+
+    if (file == NULL || fclose(file) != 0 || !status) {
+        errprintf("Error while writing %s\n", path);
+        status = false;
+    }
+    return status;
+}
+
+uint8_t how_many_bits_to_hold_number(uint64_t n) {
     uint8_t count = 0;
 
     while (n) {
-        count += n & 1;
+        count++;
         n >>= 1;
     }
     return count;
@@ -1,16 +1,11 @@
-#include <memory.h>
-
+#include "../include/apply_move.h"
+#include "../include/bitboard.h"
 #include "../include/error.h"
-#include "../include/piece.h"
-
-#include "../include/bishop.h"
 #include "../include/king.h"
-#include "../include/knight.h"
-#include "../include/pawn.h"
-#include "../include/queen.h"
-#include "../include/rook.h"
+#include "../include/piece.h"
 
-STACK_IMPL_WITH_NAME(struct previous_board_state, previous_board_state, ({ .current_player = INVALID_PLAYER, .move_turn = 0, .board = {{ 0 }} }))
+STACK_IMPL_WITH_NAME(struct previous_board_state, previous_board_state, ({ .current_player = INVALID_PLAYER, .move_turn = 0, .castling_rights = 0, .en_passant_file = INVALID_COORD, .last_move = EMPTY_MOVE_UNDO, .last_moved = EMPTY_SQUARE, .undo_log_size = 0 }))
+STACK_IMPL_WITH_NAME(struct move_undo, move_undo, EMPTY_MOVE_UNDO)
 
 struct board_state empty_board_state(void) {
     struct board_state state = {
@@ -43,12 +38,17 @@ struct board_state empty_board_state(void) {
         }
     }
     state.previous_states = stack_previous_board_state_empty();
-    memcpy(state.previous_board, state.board, sizeof(board));
+    state.undo_log = stack_move_undo_empty();
+    compute_bitboards(state.board, &state.bitboards);
+    state.castling_rights = ALL_CASTLING_RIGHTS;
+    state.en_passant_file = INVALID_COORD;
+    state.last_move = EMPTY_MOVE_UNDO;
     return state;
 }
 
 void free_board_state(struct board_state* state) {
     stack_previous_board_state_free(&state->previous_states);
+    stack_move_undo_free(&state->undo_log);
 }
 
 void next_turn(struct board_state* state) {
@@ -67,14 +67,22 @@ bool board_start_alternative_moves(struct board_state* state) {
 
     struct previous_board_state prev_state = {
         .move_turn = state->move_turn,
-        .current_player = state->current_player
+        .current_player = state->current_player,
+        .castling_rights = state->castling_rights,
+        .en_passant_file = state->en_passant_file,
+        .last_move = state->last_move,
+        .last_moved = EMPTY_SQUARE,
+        .undo_log_size = state->undo_log.size
     };
-    memcpy(prev_state.board, state->board, sizeof(board));
 
-    board prev_board;
-    memcpy(prev_board, state->previous_board, sizeof(board));
-    memcpy(state->previous_board, state->board, sizeof(board));
-    memcpy(state->board, prev_board, sizeof(board));
+    // alternative moves replace the last move
+    if (state->last_move.from.file != INVALID_COORD) {
+        prev_state.last_moved = board_at_coord(state->board, state->last_move.to)->type;
+        unmake_move(state->board, &state->bitboards, &state->last_move);
+        state->castling_rights = state->last_move.castling_rights;
+        state->en_passant_file = state->last_move.en_passant_file;
+    }
+    state->last_move = EMPTY_MOVE_UNDO;
 
     if (state->current_player == WHITE) { // if white must play at the nth turn, then the last move was a previous turn
         state->move_turn--;
@@ -91,9 +99,34 @@ bool board_end_alternative_moves(struct board_state* state) {
     if (!stack_previous_board_state_pop(&state->previous_states, &prev_state)) {
         return false;
     }
+    struct move_undo undo;
+    while (state->undo_log.size > prev_state.undo_log_size && stack_move_undo_pop(&state->undo_log, &undo)) {
+        unmake_move(state->board, &state->bitboards, &undo);
+    }
+
+    const struct move_undo* const last_move = &prev_state.last_move;
+    if (last_move->from.file != INVALID_COORD) {
+        struct move_undo replayed;
+        if (last_move->flags & MOVE_UNDO_CASTLING) {
+            const enum player player = board_at_coord(state->board, last_move->from)->player;
+            make_castling(state->board, &state->bitboards, player, last_move->to.file == king_ending_coords[player][KINGSIDE].file ? KINGSIDE : QUEENSIDE, &replayed);
+        } else {
+            make_move(state->board, &state->bitboards, &last_move->from, &last_move->to, (last_move->flags & MOVE_UNDO_PROMOTION) ? prev_state.last_moved : EMPTY_SQUARE, &replayed);
+        }
+    }
     state->move_turn = prev_state.move_turn;
     state->current_player = prev_state.current_player;
-    memcpy(state->board, prev_state.board, sizeof(board));
+    state->castling_rights = prev_state.castling_rights;
+    state->en_passant_file = prev_state.en_passant_file;
+    state->last_move = prev_state.last_move;
+    return true;
+}
+
+bool board_log_last_move(struct board_state* state) {
+    if (state->previous_states.size == 0) {
+        return true;
+    }
+    ASSERT_PRINTF_RETURN_FALSE(stack_move_undo_push(&state->undo_log, state->last_move), "Cannot log the move of alternative moves !");
     return true;
 }
 
@@ -102,81 +135,3 @@ const char* PLAYER_NAMES[PLAYER_SIZE] = {
     [BLACK] = "black",
     [INVALID_PLAYER] = "<invalid player>"
 };
-
-// static void find_king(board board, enum player player, struct coord* coord) {
-//     ASSERT_PRINTF_RETURN(player != INVALID_PLAYER, "Invalid player !");
-//     const struct piece king = {
-//         .player = player,
-//         .type = KING
-//     };
-//     for (unsigned rank = 0; rank < BOARD_SIZE; rank++) {
-//         for (unsigned file = 0; file < BOARD_SIZE; file++) {
-//             if (are_pieces_equal(board_at(board, file, rank), &king)) {
-//                 *coord = (struct coord) {
-//                     .file = file,
-//                     .rank = rank
-//                 };
-//                 return;
-//             }
-//         }
-//     }
-//     FAIL("Cannot find %s king on the board !", PLAYER_NAMES[player]);
-// }
-
-// checks if player is in check
-static bool is_in_check(board board, enum player player, struct coord* checking_piece_coord) {
-    ASSERT_PRINTF(player != INVALID_PLAYER, "Invalid player !");
-
-    const struct coord king_coord = find_king(board, player);
-    const enum player opponent = opponent_player(player);
-    for (int rank = 0; rank < BOARD_SIZE; rank++) {
-        for (int file = 0; file < BOARD_SIZE; file++) {
-            struct piece* const piece = board_at(board, file, rank);
-            if (piece->player == opponent) {
-                const struct coord from = {
-                    .file = file,
-                    .rank = rank
-                };
-                if (can_move_to[piece->type](from, king_coord, opponent, board)) {
-                    *checking_piece_coord = from;
-                    return true;
-                }
-            }
-        }
-    }
-    return false;
-}
-
-// bool apply_move(struct board_state* state, const struct move* move) {
-//     ASSERT_PRINTF(state != NULL, "Board state is NULL !");
-//     ASSERT_PRINTF(move != NULL, "Move is NULL !");
-//     ASSERT_PRINTF(state->current_player == move->player, "Bad player (%s instead of %s) !", PLAYER_NAMES[move->player], PLAYER_NAMES[state->current_player]);
-
-//     if (!can_move_to[move->player](move->from, move->to, move->player, state->board)) {
-//         return false;
-//     }
-
-//     struct piece* const from = board_at_coord(state->board, move->from);
-//     struct piece* const to = board_at_coord(state->board, move->to);
-//     const struct piece copy_to = *to;
-//     *to = *from;
-//     *from = (struct piece) {
-//         .player = INVALID_PLAYER,
-//         .type = EMPTY_SQUARE
-//     };
-
-//     struct coord checking_piece_coord;
-//     if (is_in_check(state->board, move->player, &checking_piece_coord)) {
-//         *from = *to; // moving back the piece to its starting square
-//         *to = copy_to;
-//         return false;
-//     }
-
-//     state->current_player = opponent_player(state->move_turn);
-//     if (state->current_player == WHITE) {
-//         state->move_turn++;
-//     }
-//     return true;
-// }
-
-
@@ -0,0 +1,340 @@
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/array.h"
+#include "../include/bitboard.h"
+#include "../include/checkpoint.h"
+#include "../include/container.h"
+#include "../include/error.h"
+#include "../include/read.h"
+#include "../include/uncompress.h"
+
+#define SQUARE_BITS 6
+#define CASTLING_RIGHTS_BITS 4
+#define MOVE_UNDO_FLAGS_BITS 3
+#define MAX_PIECE_CODE_BITS 4
+
+/**
+ * Prefix code of the piece types, the pawns being the most common.
+ */
+static const struct piece_code {
+    uint8_t code;
+    uint8_t n_bits;
+} PIECE_CODES[EMPTY_SQUARE] = {
+    [PAWN] = { .code = 0x0, .n_bits = 1 }, // 0
+    [KNIGHT] = { .code = 0x4, .n_bits = 3 }, // 100
+    [BISHOP] = { .code = 0x5, .n_bits = 3 }, // 101
+    [ROOK] = { .code = 0x6, .n_bits = 3 }, // 110
+    [QUEEN] = { .code = 0xE, .n_bits = 4 }, // 1110
+    [KING] = { .code = 0xF, .n_bits = 4 } // 1111
+};
+
+void make_checkpoint(const struct board_state* state, unsigned ply, size_t bit_offset, struct checkpoint* checkpoint) {
+    *checkpoint = (struct checkpoint) {
+        .ply = ply,
+        .bit_offset = bit_offset,
+        .castling_rights = state->castling_rights,
+        .en_passant_file = state->en_passant_file,
+        .last_move = state->last_move
+    };
+    memcpy(checkpoint->board, state->board, sizeof(board));
+}
+
+void restore_checkpoint(const struct checkpoint* checkpoint, struct board_state* state) {
+    *state = empty_board_state();
+    memcpy(state->board, checkpoint->board, sizeof(board));
+    compute_bitboards(state->board, &state->bitboards);
+    state->castling_rights = checkpoint->castling_rights;
+    state->en_passant_file = checkpoint->en_passant_file;
+    state->last_move = checkpoint->last_move;
+    state->current_player = checkpoint->ply % 2 == 0 ? WHITE : BLACK;
+    state->move_turn = 1 + checkpoint->ply / 2;
+}
+
+static bool write_piece(struct bit_writer* writer, struct piece piece) {
+    const struct piece_code* const code = &PIECE_CODES[piece.type];
+    return write_bits(writer, 1, piece.player == BLACK) && write_bits(writer, code->n_bits, code->code);
+}
+
+static bool read_piece(struct compressed_buf* buf, struct piece* piece) {
+    uint8_t player;
+    if (!read_n_bits(buf, 1, &player)) {
+        return false;
+    }
+    uint8_t code = 0;
+    for (uint8_t n_bits = 1; n_bits <= MAX_PIECE_CODE_BITS; n_bits++) {
+        uint8_t bit;
+        if (!read_n_bits(buf, 1, &bit)) {
+            return false;
+        }
+        code = (code << 1) | bit;
+        for (enum piece_type type = KING; type < EMPTY_SQUARE; type++) {
+            if (PIECE_CODES[type].n_bits == n_bits && PIECE_CODES[type].code == code) {
+                *piece = (struct piece) {
+                    .type = type,
+                    .player = player ? BLACK : WHITE
+                };
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// the number of bits of the value on size_bits bits, then the value on these bits
+static bool write_sized_value(struct bit_writer* writer, uint8_t size_bits, uint64_t value) {
+    const uint8_t n_bits = how_many_bits_to_hold_number(value);
+    return write_bits(writer, size_bits, n_bits) && write_bits(writer, n_bits, value);
+}
+
+static bool read_sized_value(struct compressed_buf* buf, uint8_t size_bits, uint64_t* value) {
+    uint8_t n_bits;
+    return read_n_bits(buf, size_bits, &n_bits) && read_bits(buf, n_bits, value);
+}
+
+// the ply and the bit offset are relative to the ones of the previous checkpoint, 0 for the first one
+static bool write_checkpoint(struct bit_writer* writer, const struct checkpoint* checkpoint, unsigned previous_ply, size_t previous_offset) {
+    ASSERT_PRINTF(checkpoint->ply >= previous_ply && checkpoint->ply < (1 << CHECKPOINT_MAX_PLY_BITS), "Invalid checkpoint ply %u after ply %u !", checkpoint->ply, previous_ply);
+    ASSERT_PRINTF(checkpoint->bit_offset >= previous_offset, "Checkpoint offset %zu is before the previous one, %zu !", checkpoint->bit_offset, previous_offset);
+
+    bitboard occupied = EMPTY_BITBOARD;
+    for (uint8_t square = 0; square < N_SQUARES; square++) {
+        const struct coord coord = square_to_coord(square);
+        if (checkpoint->board[coord.rank][coord.file].type != EMPTY_SQUARE) {
+            occupied |= square_bit(square);
+        }
+    }
+
+    bool status =
+        write_sized_value(writer, CHECKPOINT_PLY_SIZE_BITS, checkpoint->ply - previous_ply) &&
+        write_sized_value(writer, CHECKPOINT_OFFSET_SIZE_BITS, checkpoint->bit_offset - previous_offset) &&
+        write_bits(writer, N_SQUARES, occupied);
+    while (status && occupied) {
+        const struct coord coord = square_to_coord(pop_lowest_square(&occupied));
+        status = write_piece(writer, checkpoint->board[coord.rank][coord.file]);
+    }
+    status = status && write_bits(writer, CASTLING_RIGHTS_BITS, checkpoint->castling_rights);
+    status = status && write_bits(writer, 1, checkpoint->en_passant_file != INVALID_COORD);
+    if (status && checkpoint->en_passant_file != INVALID_COORD) {
+        status = write_bits(writer, 3, checkpoint->en_passant_file);
+    }
+
+    const struct move_undo* const last_move = &checkpoint->last_move;
+    const bool has_last_move = last_move->from.file != INVALID_COORD;
+    status = status && write_bits(writer, 1, has_last_move);
+    if (status && has_last_move) {
+        status =
+            write_bits(writer, SQUARE_BITS, coord_to_square(last_move->from)) &&
+            write_bits(writer, SQUARE_BITS, coord_to_square(last_move->to)) &&
+            write_bits(writer, MOVE_UNDO_FLAGS_BITS, last_move->flags) &&
+            write_bits(writer, 1, last_move->captured.type != EMPTY_SQUARE);
+        if (status && last_move->captured.type != EMPTY_SQUARE) {
+            status = write_piece(writer, last_move->captured);
+        }
+    }
+    return status;
+}
+
+static bool read_checkpoint(struct compressed_buf* buf, unsigned previous_ply, size_t previous_offset, struct checkpoint* checkpoint) {
+    uint64_t value;
+    uint64_t occupied;
+    uint8_t byte;
+
+    *checkpoint = (struct checkpoint) {
+        .en_passant_file = INVALID_COORD,
+        .last_move = EMPTY_MOVE_UNDO
+    };
+    ASSERT_PRINTF(read_sized_value(buf, CHECKPOINT_PLY_SIZE_BITS, &value), "Cannot read checkpoint ply !");
+    ASSERT_PRINTF(value < (1 << CHECKPOINT_MAX_PLY_BITS) - previous_ply, "Invalid checkpoint ply %" PRIu64 " plies after ply %u !", value, previous_ply);
+    checkpoint->ply = previous_ply + value;
+    ASSERT_PRINTF(read_sized_value(buf, CHECKPOINT_OFFSET_SIZE_BITS, &value), "Cannot read checkpoint offset !");
+    checkpoint->bit_offset = previous_offset + value;
+    ASSERT_PRINTF(read_bits(buf, N_SQUARES, &occupied), "Cannot read checkpoint occupied squares !");
+
+    for (uint8_t square = 0; square < N_SQUARES; square++) {
+        *board_at_coord(checkpoint->board, square_to_coord(square)) = EMPTY_PIECE;
+    }
+    unsigned n_kings[PLAYER_SIZE] = { 0 };
+    while (occupied) {
+        struct piece* const piece = board_at_coord(checkpoint->board, square_to_coord(pop_lowest_square(&occupied)));
+        ASSERT_PRINTF(read_piece(buf, piece), "Cannot read checkpoint piece !");
+        n_kings[piece->player] += piece->type == KING;
+    }
+    // the move generation relies on both kings, a damaged checkpoint mustn't get there
+    ASSERT_PRINTF(n_kings[WHITE] == 1 && n_kings[BLACK] == 1, "Checkpoint of ply %u must have one king of each player !", checkpoint->ply);
+    ASSERT_PRINTF(read_n_bits(buf, CASTLING_RIGHTS_BITS, &checkpoint->castling_rights), "Cannot read checkpoint castling rights !");
+    ASSERT_PRINTF(read_n_bits(buf, 1, &byte), "Cannot read checkpoint en passant !");
+    if (byte) {
+        ASSERT_PRINTF(read_n_bits(buf, 3, &byte), "Cannot read checkpoint en passant file !");
+        checkpoint->en_passant_file = byte;
+    }
+
+    ASSERT_PRINTF(read_n_bits(buf, 1, &byte), "Cannot read checkpoint last move !");
+    if (byte) {
+        uint8_t from;
+        uint8_t to;
+        uint8_t has_capture;
+        struct move_undo* const last_move = &checkpoint->last_move;
+        ASSERT_PRINTF(read_n_bits(buf, SQUARE_BITS, &from) && read_n_bits(buf, SQUARE_BITS, &to), "Cannot read checkpoint last move squares !");
+        ASSERT_PRINTF(read_n_bits(buf, MOVE_UNDO_FLAGS_BITS, &last_move->flags), "Cannot read checkpoint last move flags !");
+        ASSERT_PRINTF(read_n_bits(buf, 1, &has_capture), "Cannot read checkpoint last move capture !");
+        last_move->from = square_to_coord(from);
+        last_move->to = square_to_coord(to);
+        if (has_capture) {
+            ASSERT_PRINTF(read_piece(buf, &last_move->captured), "Cannot read checkpoint captured piece !");
+        }
+    }
+    return true;
+}
+
+bool write_checkpoint_table(struct bit_writer* writer, const struct checkpoint* checkpoints, size_t n_checkpoints) {
+    ASSERT_PRINTF(n_checkpoints < (1 << N_CHECKPOINTS_BITS), "Too many checkpoints (%zu) !", n_checkpoints);
+
+    bool status = write_bits(writer, N_CHECKPOINTS_BITS, n_checkpoints);
+    for (size_t i = 0; status && i < n_checkpoints; i++) {
+        status = i == 0 ?
+            write_checkpoint(writer, &checkpoints[i], 0, 0) :
+            write_checkpoint(writer, &checkpoints[i], checkpoints[i - 1].ply, checkpoints[i - 1].bit_offset);
+    }
+    return status;
+}
+
+bool read_checkpoint_table(struct compressed_buf* buf, struct checkpoint** checkpoints, size_t* n_checkpoints) {
+    uint64_t count;
+    ASSERT_PRINTF(read_bits(buf, N_CHECKPOINTS_BITS, &count), "Cannot read the number of checkpoints !");
+
+    struct checkpoint checkpoint = { .ply = 0, .bit_offset = 0 };
+    if (checkpoints == NULL) {
+        for (uint64_t i = 0; i < count; i++) {
+            if (!read_checkpoint(buf, checkpoint.ply, checkpoint.bit_offset, &checkpoint)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    *n_checkpoints = 0;
+    *checkpoints = malloc(sizeof(struct checkpoint) * (count > 0 ? count : 1));
+    if (*checkpoints == NULL) {
+        errprintf("Cannot allocate %zu checkpoints !", (size_t)count);
+        return false;
+    }
+    for (; *n_checkpoints < count; (*n_checkpoints)++) {
+        const struct checkpoint* const previous = *n_checkpoints > 0 ? &(*checkpoints)[*n_checkpoints - 1] : &checkpoint;
+        if (!read_checkpoint(buf, previous->ply, previous->bit_offset, &(*checkpoints)[*n_checkpoints])) {
+            free(*checkpoints);
+            *checkpoints = NULL;
+            *n_checkpoints = 0;
+            return false;
+        }
+    }
+    return true;
+}
+
+struct checkpoints_builder {
+    unsigned every_n_plies;
+    struct checkpoint* checkpoints;
+    size_t n_checkpoints;
+    size_t max_checkpoints;
+    bool failed;
+};
+
+static void add_checkpoint(const struct board_state* state, unsigned ply, size_t bit_offset, void* data) {
+    struct checkpoints_builder* const builder = data;
+
+    if (builder->failed || ply == 0 || ply % builder->every_n_plies != 0) {
+        return;
+    }
+    struct checkpoint* const expanded = expand_array_if_needed(builder->checkpoints, builder->n_checkpoints + 1, sizeof(struct checkpoint), &builder->max_checkpoints, 2);
+    if (expanded == NULL) {
+        builder->failed = true;
+        return;
+    }
+    builder->checkpoints = expanded;
+    make_checkpoint(state, ply, bit_offset, &builder->checkpoints[builder->n_checkpoints++]);
+}
+
+static bool rewrite_game_with_checkpoints(struct compressed_buf* buf, struct bit_writer* writer, struct checkpoints_builder* builder, const struct uncompress_options* options) {
+    struct game_layout layout;
+    builder->n_checkpoints = 0;
+    if (uncompress_game(buf, options, &layout, add_checkpoint, builder) != TRUE || builder->failed) {
+        return false;
+    }
+    // the range decoder state cannot be restored from a bit offset
+    ASSERT_PRINTF(version_move_coding(layout.version) != ARITHMETIC_CODING, "Cannot add checkpoints to an arithmetic coded game !");
+
+    // the plies of the opening trie are restored from its nodes, and don't have a bit offset of their own
+    const unsigned opening_plies = layout.opening_node != 0 ? options->trie->nodes[layout.opening_node].state.ply : 0;
+    size_t n_kept = 0;
+    for (size_t i = 0; i < builder->n_checkpoints; i++) {
+        if (builder->checkpoints[i].ply > opening_plies) {
+            builder->checkpoints[n_kept] = builder->checkpoints[i];
+            builder->checkpoints[n_kept++].bit_offset -= layout.moves_start;
+        }
+    }
+    builder->n_checkpoints = n_kept;
+    return
+        write_bits(writer, 8, layout.version | VERSION_CHECKPOINTS) &&
+        copy_game_header(writer, buf, &layout) &&
+        copy_bits(writer, buf, layout.opening_start, layout.checkpoints_start - layout.opening_start) &&
+        write_checkpoint_table(writer, builder->checkpoints, builder->n_checkpoints) &&
+        copy_bits(writer, buf, layout.moves_start, layout.end - layout.moves_start) &&
+        bit_writer_align(writer);
+}
+
+int add_checkpoints(const struct args* args) {
+    ASSERT_PRINTF_EXIT_FAILURE(args != NULL, "args is NULL !");
+    ASSERT_PRINTF_EXIT_FAILURE(args->input != NULL && args->output != NULL, "Adding checkpoints requires an input and an output (-o) !");
+    ASSERT_PRINTF_EXIT_FAILURE(args->checkpoints > 0, "Checkpoints interval must be positive !");
+
+    size_t size;
+    unsigned char* const raw_buf = read_compressed_file(args->input, &size);
+    if (raw_buf == NULL) {
+        fprintf(stderr, "Error while reading %s\n", args->input);
+        return EXIT_FAILURE;
+    }
+    struct compressed_buf buf;
+    make_compressed_buf(&buf, raw_buf, size);
+
+    struct checkpoints_builder builder = {
+        .every_n_plies = args->checkpoints,
+        .max_checkpoints = 16
+    };
+    struct bit_writer writer = { 0 };
+    struct container_header header = { 0 };
+    struct uncompress_options options = {
+        .print = false,
+        .cache = NULL,
+        .mainline_only = true, // the moves are copied as is
+        .log = args->log
+    };
+    builder.checkpoints = malloc(sizeof(struct checkpoint) * builder.max_checkpoints);
+    bool status = builder.checkpoints != NULL && read_container_header(&buf, &header);
+    options.huffman = container_huffman(&header);
+    options.trie = container_trie(&header);
+    options.variation_lengths = container_has_variation_lengths(&header);
+    status = status && bit_writer_init(&writer) && write_container_header(&writer, &header);
+    // the games are kept in the same blocks
+    struct block_writer block = { 0 };
+    size_t nth_block = 0;
+    enum safe_bool has_game = FALSE;
+    while (status && (has_game = next_game(&buf, &header)) == TRUE) {
+        if (header.flags & CONTAINER_BLOCKS) {
+            status = (header.block.nth_block == nth_block || end_block(&writer, &block)) && begin_block_game(&writer, &block, SIZE_MAX) != ERROR;
+            nth_block = header.block.nth_block;
+        }
+        status = status && rewrite_game_with_checkpoints(&buf, &writer, &builder, &options);
+    }
+    status = status && has_game != ERROR && end_block(&writer, &block);
+
+    status = status && bit_writer_save(&writer, args->output);
+
+    free_container_header(&header);
+    bit_writer_free(&writer);
+    free(builder.checkpoints);
+    free(raw_buf);
+    return status ? EXIT_SUCCESS : EXIT_FAILURE;
+}
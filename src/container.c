@@ -0,0 +1,201 @@
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../include/container.h"
+#include "../include/crc32c.h"
+#include "../include/error.h"
+#include "../include/read.h"
+#include "../include/uncompress.h"
+
+bool read_container_header(struct compressed_buf* buf, struct container_header* header) {
+    header->flags = 0;
+    header->block = (struct block_cursor) { 0 };
+
+    uint8_t first_byte;
+    if (buf->remaining_bits < 8 || !peek_n_bits(buf, 8, &first_byte) || !(first_byte & CONTAINER_HEADER_MARK)) {
+        return true;
+    }
+    read_n_bits(buf, 8, &first_byte);
+    const uint8_t flags = first_byte & ~CONTAINER_HEADER_MARK;
+    if (flags & ~(CONTAINER_HUFFMAN_TOKENS | CONTAINER_OPENING_TRIE | CONTAINER_BLOCKS | CONTAINER_VARIATION_LENGTHS)) {
+        fprintf(stderr, "Unknown container header flags %" PRIx8 " !\n", flags);
+        return false;
+    }
+    if (flags & CONTAINER_HUFFMAN_TOKENS) {
+        ASSERT_PRINTF(read_token_huffman(buf, &header->huffman), "Cannot read the token type codes !");
+    }
+    if (flags & CONTAINER_OPENING_TRIE) {
+        ASSERT_PRINTF(read_opening_trie(buf, &header->trie), "Cannot read the opening trie !");
+    }
+    header->flags = flags; // only once everything is read, so that there's nothing to free otherwise
+    skip_to_next_byte(buf);
+    return true;
+}
+
+bool write_container_header(struct bit_writer* writer, const struct container_header* header) {
+    if (header->flags == 0) {
+        return true;
+    }
+    return
+        write_bits(writer, 8, CONTAINER_HEADER_MARK | header->flags) &&
+        (!(header->flags & CONTAINER_HUFFMAN_TOKENS) || write_token_huffman(writer, &header->huffman)) &&
+        (!(header->flags & CONTAINER_OPENING_TRIE) || write_opening_trie(writer, &header->trie)) &&
+        bit_writer_align(writer);
+}
+
+void free_container_header(struct container_header* header) {
+    if (header->flags & CONTAINER_OPENING_TRIE) {
+        opening_trie_free(&header->trie);
+    }
+    header->flags = 0;
+}
+
+const struct token_huffman* container_huffman(const struct container_header* header) {
+    return (header->flags & CONTAINER_HUFFMAN_TOKENS) ? &header->huffman : NULL;
+}
+
+const struct opening_trie* container_trie(const struct container_header* header) {
+    return (header->flags & CONTAINER_OPENING_TRIE) ? &header->trie : NULL;
+}
+
+bool container_has_variation_lengths(const struct container_header* header) {
+    return header->flags & CONTAINER_VARIATION_LENGTHS;
+}
+
+// sets the cursor to the next block, whose games are only readable if TRUE is returned
+static enum safe_bool read_block_header(struct compressed_buf* buf, struct block_cursor* block) {
+    const size_t start = bit_offset(buf) / 8;
+    uint64_t n_games;
+    uint64_t n_bytes;
+    uint64_t checksum;
+
+    block->nth_block++;
+    block->games_left = 0;
+    block->end = buf->n_bytes;
+    if (buf->remaining_bits < BLOCK_HEADER_SIZE * 8) {
+        fprintf(stderr, "Block %zu is truncated, its header is incomplete !\n", block->nth_block);
+        return ERROR;
+    }
+    read_bits(buf, BLOCK_FIELD_BITS, &n_games);
+    read_bits(buf, BLOCK_FIELD_BITS, &n_bytes);
+    read_bits(buf, BLOCK_FIELD_BITS, &checksum);
+    if (n_bytes > buf->remaining_bits / 8) {
+        fprintf(stderr, "Block %zu is truncated, %zu of its %" PRIu64 " bytes are missing !\n", block->nth_block, (size_t)n_bytes - buf->remaining_bits / 8, n_bytes);
+        return ERROR;
+    }
+    block->end = start + BLOCK_HEADER_SIZE + n_bytes;
+    if (crc32c(buf->buf + start + BLOCK_HEADER_SIZE, n_bytes) != checksum) {
+        fprintf(stderr, "Block %zu doesn't match its checksum, its %" PRIu64 " game%s skipped !\n", block->nth_block, n_games, n_games >= 2 ? "s are" : " is");
+        return ERROR;
+    }
+    block->games_left = n_games;
+    return TRUE;
+}
+
+enum safe_bool next_game(struct compressed_buf* buf, struct container_header* header) {
+    if (!(header->flags & CONTAINER_BLOCKS)) {
+        return has_next_game(buf) ? TRUE : FALSE;
+    }
+
+    struct block_cursor* const block = &header->block;
+    while (block->games_left == 0) {
+        if (block->nth_block > 0) {
+            seek_bit_offset(buf, block->end * 8);
+        }
+        if (!has_next_game(buf)) {
+            return FALSE;
+        }
+        if (read_block_header(buf, block) != TRUE) {
+            return ERROR;
+        }
+    }
+    block->games_left--;
+    return TRUE;
+}
+
+static void write_block_field(uint8_t* bytes, uint32_t value) {
+    for (int i = 0; i < BLOCK_FIELD_BITS / 8; i++) {
+        bytes[i] = value >> (BLOCK_FIELD_BITS - 8 * (i + 1));
+    }
+}
+
+enum safe_bool begin_block_game(struct bit_writer* writer, struct block_writer* block, size_t block_size) {
+    if (block->is_open && writer->n_bits / 8 - block->start - BLOCK_HEADER_SIZE < block_size) {
+        ASSERT_PRINTF_RETURN_ERROR(block->n_games < UINT32_MAX, "Too many games in a block !");
+        block->n_games++;
+        return FALSE;
+    }
+    if (!end_block(writer, block)) {
+        return ERROR;
+    }
+
+    // the header is filled by end_block
+    *block = (struct block_writer) {
+        .is_open = true,
+        .start = writer->n_bits / 8,
+        .n_games = 1
+    };
+    for (int field = 0; field < BLOCK_HEADER_SIZE * 8 / BLOCK_FIELD_BITS; field++) {
+        if (!write_bits(writer, BLOCK_FIELD_BITS, 0)) {
+            return ERROR;
+        }
+    }
+    return TRUE;
+}
+
+bool end_block(struct bit_writer* writer, struct block_writer* block) {
+    if (!block->is_open) {
+        return true;
+    }
+    const size_t games_start = block->start + BLOCK_HEADER_SIZE;
+    const size_t n_bytes = writer->n_bits / 8 - games_start;
+    ASSERT_PRINTF(n_bytes <= UINT32_MAX, "Block of %zu bytes is too large !", n_bytes);
+
+    uint8_t* const header = writer->buf + block->start;
+    write_block_field(header, block->n_games);
+    write_block_field(header + BLOCK_FIELD_BITS / 8, n_bytes);
+    write_block_field(header + 2 * BLOCK_FIELD_BITS / 8, crc32c(writer->buf + games_start, n_bytes));
+    block->is_open = false;
+    return true;
+}
+
+int verify_container(const struct args* args) {
+    ASSERT_PRINTF_EXIT_FAILURE(args != NULL, "args is NULL !");
+    ASSERT_PRINTF_EXIT_FAILURE(args->input != NULL, "Verifying requires an input container !");
+
+    size_t size;
+    unsigned char* const raw_buf = read_compressed_file(args->input, &size);
+    if (raw_buf == NULL) {
+        fprintf(stderr, "Error while reading %s\n", args->input);
+        return EXIT_FAILURE;
+    }
+    struct compressed_buf buf;
+    make_compressed_buf(&buf, raw_buf, size);
+    struct container_header header = { 0 };
+    bool status = read_container_header(&buf, &header);
+    if (status && !(header.flags & CONTAINER_BLOCKS)) {
+        fprintf(stderr, "%s has no blocks, so no checksums to verify !\n", args->input);
+        status = false;
+    }
+
+    // only the block headers are read, the games are skipped as a whole
+    struct block_cursor* const block = &header.block;
+    size_t n_games = 0;
+    size_t n_damaged_blocks = 0;
+    while (status && (block->nth_block == 0 || seek_bit_offset(&buf, block->end * 8)) && has_next_game(&buf)) {
+        if (read_block_header(&buf, block) == TRUE) {
+            n_games += block->games_left;
+        } else {
+            n_damaged_blocks++;
+        }
+    }
+    if (status) {
+        printf("%zu block%s, %zu game%s, %zu damaged block%s\n", block->nth_block, block->nth_block >= 2 ? "s" : "", n_games, n_games >= 2 ? "s" : "", n_damaged_blocks, n_damaged_blocks >= 2 ? "s" : "");
+    }
+
+    free_container_header(&header);
+    free(raw_buf);
+    return status && n_damaged_blocks == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
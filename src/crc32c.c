@@ -0,0 +1,51 @@
+#include <string.h>
+
+#include "../include/crc32c.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <nmmintrin.h>
+#define HAS_CRC32_INSTRUCTION
+#endif
+
+// CRC of each nibble for the reflected polynomial 0x82F63B78, so that no table has to be built
+static const uint32_t NIBBLE_CRCS[16] = {
+    0x00000000, 0x105EC76F, 0x20BD8EDE, 0x30E349B1, 0x417B1DBC, 0x5125DAD3, 0x61C69362, 0x7198540D,
+    0x82F63B78, 0x92A8FC17, 0xA24BB5A6, 0xB21572C9, 0xC38D26C4, 0xD3D3E1AB, 0xE330A81A, 0xF36E6F75
+};
+
+uint32_t crc32c_portable(const uint8_t* data, size_t size) {
+    uint32_t crc = 0xFFFFFFFF;
+
+    for (size_t i = 0; i < size; i++) {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ NIBBLE_CRCS[crc & 0xF];
+        crc = (crc >> 4) ^ NIBBLE_CRCS[crc & 0xF];
+    }
+    return ~crc;
+}
+
+#ifdef HAS_CRC32_INSTRUCTION
+// compiled for SSE4.2 whatever the flags of the build, only called once the CPU is known to support it
+__attribute__((target("sse4.2"))) static uint32_t crc32c_sse42(const uint8_t* data, size_t size) {
+    uint64_t crc = 0xFFFFFFFF;
+
+    for (; size >= sizeof(uint64_t); data += sizeof(uint64_t), size -= sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, data, sizeof(uint64_t)); // unaligned, the instruction reads it little endian as the table does
+        crc = _mm_crc32_u64(crc, word);
+    }
+    for (; size > 0; data++, size--) {
+        crc = _mm_crc32_u8((uint32_t)crc, *data);
+    }
+    return ~(uint32_t)crc;
+}
+#endif
+
+uint32_t crc32c(const uint8_t* data, size_t size) {
+#ifdef HAS_CRC32_INSTRUCTION
+    if (__builtin_cpu_supports("sse4.2")) {
+        return crc32c_sse42(data, size);
+    }
+#endif
+    return crc32c_portable(data, size);
+}
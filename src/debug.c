@@ -4,11 +4,9 @@
 
 #include "../include/debug.h"
 #include "../include/error.h"
-#include "../include/log.h"
 #include "../include/strings.h"
 
 void print_move(const struct move* move, FILE* file) {
-    LOG("%s", PIECES_NAME[move->piece]);
     if (move->piece == KING && move->extra_infos.infos.king_infos.is_castling) {
         fputs(move->extra_infos.infos.king_infos.castling == KINGSIDE ? "O-O\n" : "O-O-O\n", file);
         return;
@@ -38,7 +36,7 @@ void print_pgn_token(struct pgn_token* token, FILE* file) {
     ASSERT_PRINTF_RETURN(file != NULL, "Output file is NULL !");
 
     switch (token->type) {
-    case CASTLING:
+    case COMMENT:
         fprintf(file, "{%s}", token->move.comment);
         break;
 
@@ -159,3 +157,20 @@ void print_token(const struct pgn_token* token) {
         break;
     }
 }
+
+void print_token_huffman(const struct token_huffman* huffman) {
+    static const char* const SYMBOL_NAMES[N_TOKEN_SYMBOLS] = {
+        "King", "Queen", "Bishop", "Knight", "Rook", "Pawn",
+        "Castling", "Promotion", "Comment", "Alternative moves", "NAG", "End of the game"
+    };
+
+    puts("Token type codes :");
+    for (uint8_t symbol = 0; symbol < N_TOKEN_SYMBOLS; symbol++) {
+        printf("- %s : ", SYMBOL_NAMES[symbol]);
+        for (uint8_t nth = huffman->lengths[symbol]; nth > 0; nth--) {
+            putchar('0' + ((huffman->codes[symbol] >> (nth - 1)) & 1));
+        }
+        putchar('\n');
+    }
+    putchar('\n');
+}
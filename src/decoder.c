@@ -0,0 +1,84 @@
+#include "../include/decoder.h"
+#include "../include/error.h"
+
+bool decoder_open(struct decoder* decoder, const uint8_t* buf, size_t len) {
+    ASSERT_PRINTF(decoder != NULL, "Decoder is NULL !");
+
+    decoder->is_game_open = false;
+    decoder->is_malformed = false;
+    arena_init(&decoder->arena);
+    if (!make_compressed_buf(&decoder->buf, buf, len) || !read_container_header(&decoder->buf, &decoder->header)) {
+        return false;
+    }
+    if (!position_cache_init(&decoder->cache, POSITION_CACHE_DEFAULT_SIZE)) {
+        free_container_header(&decoder->header);
+        return false;
+    }
+    return true;
+}
+
+static void close_game(struct decoder* decoder) {
+    if (decoder->is_game_open) {
+        end_game_replay(&decoder->game);
+        decoder->is_game_open = false;
+    }
+    arena_free(&decoder->arena);
+}
+
+void decoder_close(struct decoder* decoder) {
+    close_game(decoder);
+    position_cache_free(&decoder->cache);
+    free_container_header(&decoder->header);
+}
+
+// the games after a malformed one can only be found again at the next block
+static void skip_malformed_game(struct decoder* decoder) {
+    if (decoder->header.flags & CONTAINER_BLOCKS) {
+        decoder->header.block.games_left = 0;
+    } else {
+        decoder->is_malformed = true;
+    }
+}
+
+enum safe_bool decoder_next_game(struct decoder* decoder) {
+    ASSERT_PRINTF_RETURN_ERROR(decoder != NULL, "Decoder is NULL !");
+
+    struct pgn_token token;
+    while (decoder_next_token(decoder, &token) == TRUE) {
+    }
+    close_game(decoder);
+    if (decoder->is_malformed) {
+        return FALSE;
+    }
+
+    const enum safe_bool has_game = next_game(&decoder->buf, &decoder->header);
+    if (has_game != TRUE) {
+        return has_game;
+    }
+    const struct uncompress_options options = {
+        .cache = &decoder->cache,
+        .huffman = container_huffman(&decoder->header),
+        .trie = container_trie(&decoder->header),
+        .variation_lengths = container_has_variation_lengths(&decoder->header),
+        .arena = &decoder->arena
+    };
+    if (start_game_replay(&decoder->buf, &options, &decoder->game) != TRUE) {
+        skip_malformed_game(decoder);
+        return ERROR;
+    }
+    decoder->is_game_open = true;
+    return TRUE;
+}
+
+enum safe_bool decoder_next_token(struct decoder* decoder, struct pgn_token* token) {
+    ASSERT_PRINTF_RETURN_ERROR(decoder != NULL, "Decoder is NULL !");
+
+    if (!decoder->is_game_open) {
+        return FALSE;
+    }
+    const enum safe_bool status = replay_next_token(&decoder->game, token);
+    if (status == ERROR) {
+        skip_malformed_game(decoder);
+    }
+    return status;
+}
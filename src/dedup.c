@@ -0,0 +1,190 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/dedup.h"
+#include "../include/error.h"
+
+#define FNV_OFFSET_BASIS 0xCBF29CE484222325ULL
+#define FNV_PRIME 0x100000001B3ULL
+#define MIX_MULTIPLIER 0x9E3779B97F4A7C15ULL
+
+// two unrelated 64 bits hashes, FNV-1a and a multiply and xorshift one
+static void hash_bytes(struct game_hash* hash, const void* data, size_t size) {
+    const uint8_t* const bytes = data;
+
+    for (size_t i = 0; i < size; i++) {
+        hash->high = (hash->high ^ bytes[i]) * FNV_PRIME;
+        hash->low = (hash->low ^ bytes[i]) * MIX_MULTIPLIER;
+        hash->low ^= hash->low >> 29;
+    }
+}
+
+static void hash_byte(struct game_hash* hash, uint8_t byte) {
+    hash_bytes(hash, &byte, 1);
+}
+
+static void hash_token(struct game_hash* hash, const struct pgn_token* token) {
+    const struct move* const move = &token->move.move;
+
+    hash_byte(hash, token->type);
+    switch (token->type) {
+        case CASTLING: // the squares of a castling depend on the coding it was decoded from
+            hash_byte(hash, move->player);
+            hash_byte(hash, move->extra_infos.infos.king_infos.castling);
+            return;
+
+        case COMMENT:
+            hash_bytes(hash, token->move.comment, strlen(token->move.comment) + 1);
+            return;
+
+        case ALTERNATIVE_MOVE:
+            hash_byte(hash, token->move.alternative_moves_is_end);
+            return;
+
+        case NAG:
+            hash_byte(hash, token->move.nag);
+            return;
+
+        case END_OF_THE_GAME:
+            hash_byte(hash, token->move.winner.is_draw);
+            hash_byte(hash, token->move.winner.winner);
+            return;
+
+        default:
+            hash_byte(hash, move->from.file);
+            hash_byte(hash, move->from.rank);
+            hash_byte(hash, move->to.file);
+            hash_byte(hash, move->to.rank);
+            if (token->type == PROMOTION) {
+                hash_byte(hash, move->extra_infos.infos.pawn_infos.promotion_piece);
+            }
+            return;
+    }
+}
+
+static bool is_tag_selected(const char* name, size_t name_len, const char* selected_tags) {
+    while (selected_tags != NULL) {
+        const char* const end = strchr(selected_tags, ',');
+        const size_t len = end != NULL ? (size_t)(end - selected_tags) : strlen(selected_tags);
+        if (len == name_len && strncmp(name, selected_tags, len) == 0) {
+            return true;
+        }
+        selected_tags = end != NULL ? end + 1 : NULL;
+    }
+    return false;
+}
+
+// strnlen isn't C99
+static size_t bounded_length(const uint8_t* string, size_t max_length) {
+    const uint8_t* const nul = memchr(string, '\0', max_length);
+    return nul != NULL ? (size_t)(nul - string) : max_length;
+}
+
+struct game_hash hash_game(const struct token_list* tokens, const uint8_t* tags, size_t tags_size, const char* selected_tags) {
+    struct game_hash hash = {
+        .high = FNV_OFFSET_BASIS,
+        .low = FNV_OFFSET_BASIS
+    };
+
+    for (size_t i = 0; i < tokens->n_tokens; i++) {
+        hash_token(&hash, &tokens->tokens[i]);
+    }
+
+    // tags are name and value pairs of NUL terminated strings, ending with an empty name
+    for (size_t i = 0; selected_tags != NULL && i < tags_size && tags[i] != '\0'; ) {
+        const char* const name = (const char*)tags + i;
+        const size_t name_len = bounded_length(tags + i, tags_size - i);
+        const size_t value_start = i + name_len + 1;
+        if (value_start >= tags_size) {
+            break;
+        }
+        const size_t value_len = bounded_length(tags + value_start, tags_size - value_start);
+        if (is_tag_selected(name, name_len, selected_tags)) {
+            hash_bytes(&hash, tags + i, name_len + 1 + value_len);
+            hash_byte(&hash, '\0');
+        }
+        i = value_start + value_len + 1;
+    }
+    return hash;
+}
+
+bool dedup_set_init(struct dedup_set* set) {
+    *set = (struct dedup_set) {
+        .entries = calloc(DEDUP_SET_INITIAL_SIZE, sizeof(struct dedup_entry)),
+        .mask = DEDUP_SET_INITIAL_SIZE - 1,
+        .n_entries = 0,
+        .max_entries = DEDUP_SET_MAX_ENTRIES
+    };
+    if (set->entries == NULL) {
+        errprintf("Cannot allocate %d duplicate detection entries !\n", DEDUP_SET_INITIAL_SIZE);
+        return false;
+    }
+    return true;
+}
+
+void dedup_set_free(struct dedup_set* set) {
+    free(set->entries);
+    set->entries = NULL;
+}
+
+void dedup_set_clear(struct dedup_set* set) {
+    memset(set->entries, 0, sizeof(struct dedup_entry) * (set->mask + 1));
+    set->n_entries = 0;
+}
+
+static bool are_hashes_equal(struct game_hash first, struct game_hash second) {
+    return first.high == second.high && first.low == second.low;
+}
+
+// linear probing, the set is never more than half full
+static struct dedup_entry* find_slot(struct dedup_entry* entries, size_t mask, struct game_hash hash) {
+    size_t slot = hash.low & mask;
+
+    while (entries[slot].is_used && !are_hashes_equal(entries[slot].hash, hash)) {
+        slot = (slot + 1) & mask;
+    }
+    return &entries[slot];
+}
+
+static bool grow(struct dedup_set* set) {
+    const size_t n_slots = (set->mask + 1) * 2;
+    struct dedup_entry* const entries = calloc(n_slots, sizeof(struct dedup_entry));
+    if (entries == NULL) {
+        errprintf("Cannot allocate %zu duplicate detection entries !\n", n_slots);
+        return false;
+    }
+
+    for (size_t i = 0; i <= set->mask; i++) {
+        if (set->entries[i].is_used) {
+            *find_slot(entries, n_slots - 1, set->entries[i].hash) = set->entries[i];
+        }
+    }
+    free(set->entries);
+    set->entries = entries;
+    set->mask = n_slots - 1;
+    return true;
+}
+
+enum safe_bool dedup_set_find_or_add(struct dedup_set* set, struct game_hash hash, uint64_t* offset) {
+    struct dedup_entry* entry = find_slot(set->entries, set->mask, hash);
+    if (entry->is_used) {
+        *offset = entry->offset;
+        return TRUE;
+    }
+
+    ASSERT_PRINTF_RETURN_ERROR(set->n_entries < set->max_entries,
+        "More than %zu different games to deduplicate, split the container into blocks with --block-size, each one being deduplicated on its own !", set->max_entries);
+    if ((set->n_entries + 1) * 2 > set->mask + 1) {
+        if (!grow(set)) {
+            return ERROR;
+        }
+        entry = find_slot(set->entries, set->mask, hash);
+    }
+    *entry = (struct dedup_entry) {
+        .hash = hash,
+        .offset = *offset,
+        .is_used = true
+    };
+    set->n_entries++;
+    return FALSE;
+}
@@ -0,0 +1,591 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/apply_move.h"
+#include "../include/array.h"
+#include "../include/bitboard.h"
+#include "../include/bits_constants.h"
+#include "../include/container.h"
+#include "../include/dedup.h"
+#include "../include/encode.h"
+#include "../include/error.h"
+#include "../include/legal_index.h"
+#include "../include/move_model.h"
+#include "../include/movegen.h"
+#include "../include/pawn.h"
+#include "../include/range_coder.h"
+#include "../include/read.h"
+#include "../include/string.h"
+#include "../include/uncompress.h"
+
+#define TOKEN_LIST_INITIAL_SIZE 128
+
+bool token_list_push(struct token_list* list, const struct pgn_token* token) {
+    if (list->tokens == NULL) {
+        list->max_tokens = TOKEN_LIST_INITIAL_SIZE;
+        list->tokens = malloc(sizeof(struct pgn_token) * list->max_tokens);
+    }
+    struct pgn_token* const expanded = expand_array_if_needed(list->tokens, list->n_tokens + 1, sizeof(struct pgn_token), &list->max_tokens, 2);
+    if (expanded == NULL) {
+        errprintf("Cannot allocate space for %zu tokens !\n", list->n_tokens + 1);
+        return false;
+    }
+    list->tokens = expanded;
+
+    struct pgn_token copy = *token;
+    size_t comment_len;
+    if (token->type == COMMENT && (copy.move.comment = my_strndup(token->move.comment, strlen(token->move.comment), &comment_len)) == NULL) {
+        errprintf("Cannot copy comment '%s' !\n", token->move.comment);
+        return false;
+    }
+    list->tokens[list->n_tokens++] = copy;
+    return true;
+}
+
+void record_token(const struct pgn_token* token, void* data) {
+    struct token_list* const list = data;
+
+    if (!list->failed && !token_list_push(list, token)) {
+        list->failed = true;
+    }
+}
+
+void token_list_clear(struct token_list* list) {
+    for (size_t i = 0; i < list->n_tokens; i++) {
+        if (list->tokens[i].type == COMMENT) {
+            free(list->tokens[i].move.comment);
+        }
+    }
+    list->n_tokens = 0;
+    list->failed = false;
+}
+
+void token_list_free(struct token_list* list) {
+    token_list_clear(list);
+    free(list->tokens);
+    *list = (struct token_list) { 0 };
+}
+
+struct move_encoder {
+    enum move_coding coding;
+    struct bit_writer* writer;
+    const struct token_huffman* huffman; // prefixed codings only, NULL for the fixed prefix codes
+    struct range_encoder range_encoder; // arithmetic coding only
+    struct move_model model; // arithmetic coding only
+    struct bit_writer* output; // of the whole game, writer is the one of the innermost alternative moves while they're written apart
+    struct bit_writer* variations; // alternative moves being written, innermost last, NULL if their length isn't written
+    size_t depth;
+    size_t max_depth;
+};
+
+#define VARIATIONS_INITIAL_DEPTH 8
+
+static uint8_t end_of_the_game_bits(const struct winner* winner) {
+    return winner->is_draw ? _0b10 : (winner->winner == WHITE ? _0b00 : _0b01);
+}
+
+static bool encode_end_of_the_game(struct bit_writer* writer, const struct winner* winner) {
+    return write_bits(writer, 2, end_of_the_game_bits(winner));
+}
+
+// the token types are their own prefix code, see enum token_type
+static bool encode_token_type(const struct move_encoder* encoder, enum token_type type) {
+    if (encoder->huffman != NULL) {
+        return write_token_type(encoder->writer, encoder->huffman, type);
+    }
+    const uint8_t n_bits = type < CASTLING_OR_PROMOTION ? 3 : (type <= PROMOTION ? 4 : 5);
+    return write_bits(encoder->writer, n_bits, type);
+}
+
+static bool encode_prefixed_promotion(const struct move_encoder* encoder, struct board_state* state, const struct move* move) {
+    struct bit_writer* const writer = encoder->writer;
+    uint8_t piece_index = 0;
+    while (piece_index < 4 && PROMOTION_PIECE[piece_index] != move->extra_infos.infos.pawn_infos.promotion_piece) {
+        piece_index++;
+    }
+    ASSERT_PRINTF(piece_index < 4, "Invalid promotion piece %d !", move->extra_infos.infos.pawn_infos.promotion_piece);
+
+    struct coord pawns[BOARD_SIZE];
+    const uint8_t n_pawns = count_pawns_ready_to_promote(&state->bitboards, state->current_player, pawns);
+    uint8_t nth_pawn = 0;
+    while (nth_pawn < n_pawns && !are_coords_equal(&pawns[nth_pawn], &move->from)) {
+        nth_pawn++;
+    }
+    ASSERT_PRINTF(nth_pawn < n_pawns, "No pawn can promote from %c%d !", 'a' + move->from.file, 1 + move->from.rank);
+
+    struct coord squares[3];
+    const uint8_t n_squares = list_promotion_squares(state->board, move->from, state->current_player, squares);
+    uint8_t nth_square = 0;
+    while (nth_square < n_squares && !are_coords_equal(&squares[nth_square], &move->to)) {
+        nth_square++;
+    }
+    ASSERT_PRINTF(nth_square < n_squares, "The pawn cannot promote on %c%d !", 'a' + move->to.file, 1 + move->to.rank);
+
+    return
+        encode_token_type(encoder, PROMOTION) &&
+        write_bits(writer, 2, piece_index) &&
+        (n_pawns <= 1 || write_bits(writer, how_many_bits_to_hold_number(n_pawns - 1), nth_pawn)) &&
+        (n_squares <= 1 || write_bits(writer, how_many_bits_to_hold_number(n_squares - 1), nth_square));
+}
+
+static bool encode_destination_index(struct bit_writer* writer, struct board_state* state, enum piece_type piece, struct coord to) {
+    const bitboard destinations = move_destinations(&state->bitboards, state->current_player, piece, state->en_passant_file);
+    const uint8_t square = coord_to_square(to);
+    ASSERT_PRINTF(destinations & square_bit(square), "No %s can move to %c%d !", PIECES_NAME[piece], 'a' + to.file, 1 + to.rank);
+
+    const uint8_t n_destinations = count_squares(destinations);
+    return n_destinations <= 1 || write_bits(writer, how_many_bits_to_hold_number(n_destinations - 1), count_squares_below(destinations, square));
+}
+
+static bool encode_prefixed_move(const struct move_encoder* encoder, struct board_state* state, const struct move* move) {
+    struct bit_writer* const writer = encoder->writer;
+    const enum piece_type piece = board_at_coord(state->board, move->from)->type;
+    struct coord to = move->to;
+    struct coord coords[MAX_PIECES_TO_GO_TO_SAME_SQUARE];
+    const uint8_t count = count_how_many_pieces_of_same_type_can_move_to_square(&state->bitboards, state->current_player, piece, &to, coords);
+    uint8_t nth = 0;
+    while (nth < count && !are_coords_equal(&coords[nth], &move->from)) {
+        nth++;
+    }
+    ASSERT_PRINTF(nth < count, "No %s can move from %c%d to %c%d !", PIECES_NAME[piece], 'a' + move->from.file, 1 + move->from.rank, 'a' + to.file, 1 + to.rank);
+
+    if (!encode_token_type(encoder, (enum token_type)piece)) {
+        return false;
+    }
+    const bool is_destination_written = encoder->coding == DESTINATION_CODING ?
+        encode_destination_index(writer, state, piece, to) :
+        write_bits(writer, 3, to.file) && write_bits(writer, 3, to.rank);
+    return
+        is_destination_written &&
+        (count <= 1 || write_bits(writer, how_many_bits_to_hold_number(count - 1), nth));
+}
+
+static bool encode_prefixed_token(const struct move_encoder* encoder, struct board_state* state, const struct pgn_token* token) {
+    struct bit_writer* const writer = encoder->writer;
+
+    switch (token->type) {
+        case CASTLING:
+            return encode_token_type(encoder, CASTLING) && write_bits(writer, 1, token->move.move.extra_infos.infos.king_infos.castling == QUEENSIDE);
+
+        case PROMOTION:
+            return encode_prefixed_promotion(encoder, state, &token->move.move);
+
+        case COMMENT:
+            return encode_token_type(encoder, COMMENT) && write_string(writer, token->move.comment);
+
+        case ALTERNATIVE_MOVE:
+            return encode_token_type(encoder, ALTERNATIVE_MOVE) && write_bits(writer, 1, !token->move.alternative_moves_is_end);
+
+        case NAG:
+            return encode_token_type(encoder, NAG) && write_bits(writer, 8, token->move.nag);
+
+        case END_OF_THE_GAME:
+            return encode_token_type(encoder, END_OF_THE_GAME) && encode_end_of_the_game(writer, &token->move.winner);
+
+        default:
+            ASSERT_PRINTF(is_token_a_move(token->type), "Cannot encode token of type %d !", token->type);
+            return encode_prefixed_move(encoder, state, &token->move.move);
+    }
+}
+
+static bool encode_indexed_token(struct bit_writer* writer, struct board_state* state, const struct pgn_token* token) {
+    struct legal_move moves[MAX_LEGAL_MOVES];
+    const uint8_t n_moves = generate_legal_moves(&state->bitboards, state->current_player, state->castling_rights, state->en_passant_file, moves);
+    const uint8_t n_bits = legal_index_bits(n_moves);
+
+    switch (token->type) {
+        case COMMENT:
+            return write_bits(writer, n_bits, n_moves + COMMENT_INDEX) && write_string(writer, token->move.comment);
+
+        case ALTERNATIVE_MOVE:
+            return write_bits(writer, n_bits, n_moves + (token->move.alternative_moves_is_end ? ALTERNATIVE_MOVES_END_INDEX : ALTERNATIVE_MOVES_START_INDEX));
+
+        case NAG:
+            return write_bits(writer, n_bits, n_moves + NAG_INDEX) && write_bits(writer, 8, token->move.nag);
+
+        case END_OF_THE_GAME:
+            return write_bits(writer, n_bits, n_moves + END_OF_THE_GAME_INDEX) && encode_end_of_the_game(writer, &token->move.winner);
+
+        default: {
+            uint8_t index;
+            ASSERT_PRINTF(is_token_a_move(token->type), "Cannot encode token of type %d !", token->type);
+            ASSERT_PRINTF(find_legal_move_index(moves, n_moves, token, &index), "Move from %c%d to %c%d isn't legal !",
+                'a' + token->move.move.from.file, 1 + token->move.move.from.rank, 'a' + token->move.move.to.file, 1 + token->move.move.to.rank);
+            return write_bits(writer, n_bits, index);
+        }
+    }
+}
+
+static bool encode_arithmetic_comment(struct range_encoder* encoder, const char* comment) {
+    do {
+        if (!encode_direct_bits(encoder, 8, (uint8_t)*comment)) {
+            return false;
+        }
+    } while (*comment++ != '\0');
+    return true;
+}
+
+static bool encode_arithmetic_token(struct move_encoder* encoder, struct board_state* state, const struct pgn_token* token) {
+    struct range_encoder* const range_encoder = &encoder->range_encoder;
+    struct move_model* const model = &encoder->model;
+
+    if (is_token_a_move(token->type)) {
+        struct legal_move moves[MAX_LEGAL_MOVES];
+        const uint8_t n_moves = generate_legal_moves(&state->bitboards, state->current_player, state->castling_rights, state->en_passant_file, moves);
+        uint8_t rank = 0;
+        if (n_moves > 1) {
+            rank_legal_moves(model, state, moves, n_moves);
+        }
+        ASSERT_PRINTF(find_legal_move_index(moves, n_moves, token, &rank), "Move from %c%d to %c%d isn't legal !",
+            'a' + token->move.move.from.file, 1 + token->move.move.from.rank, 'a' + token->move.move.to.file, 1 + token->move.move.to.rank);
+        move_model_played(model, state->current_player, moves[rank].from, moves[rank].to);
+        return encode_bit(range_encoder, &model->is_move, true) && (n_moves <= 1 || encode_rank(range_encoder, model, rank));
+    }
+
+    if (!encode_bit(range_encoder, &model->is_move, false)) {
+        return false;
+    }
+    switch (token->type) {
+        case COMMENT:
+            return encode_special_index(range_encoder, model, COMMENT_INDEX) && encode_arithmetic_comment(range_encoder, token->move.comment);
+
+        case ALTERNATIVE_MOVE:
+            return encode_special_index(range_encoder, model, token->move.alternative_moves_is_end ? ALTERNATIVE_MOVES_END_INDEX : ALTERNATIVE_MOVES_START_INDEX);
+
+        case NAG:
+            return encode_special_index(range_encoder, model, NAG_INDEX) && encode_direct_bits(range_encoder, 8, token->move.nag);
+
+        case END_OF_THE_GAME:
+            return encode_special_index(range_encoder, model, END_OF_THE_GAME_INDEX) && encode_direct_bits(range_encoder, 2, end_of_the_game_bits(&token->move.winner));
+
+        default:
+            fprintf(stderr, "Cannot encode token of type %d !\n", token->type);
+            return false;
+    }
+}
+
+static bool encode_token(struct move_encoder* encoder, struct board_state* state, const struct pgn_token* token) {
+    switch (encoder->coding) {
+        case LEGAL_INDEX_CODING:
+            return encode_indexed_token(encoder->writer, state, token);
+
+        case ARITHMETIC_CODING:
+            return encode_arithmetic_token(encoder, state, token);
+
+        default:
+            return encode_prefixed_token(encoder, state, token);
+    }
+}
+
+// alternative moves are written apart until their end, as their length comes before them
+static bool start_variation(struct move_encoder* encoder) {
+    struct bit_writer* const expanded = expand_array_if_needed(encoder->variations, encoder->depth + 1, sizeof(struct bit_writer), &encoder->max_depth, 2);
+    if (expanded == NULL) {
+        errprintf("Cannot allocate space for %zu nested alternative moves !\n", encoder->depth + 1);
+        return false;
+    }
+    encoder->variations = expanded;
+    if (!bit_writer_init(&encoder->variations[encoder->depth])) {
+        return false;
+    }
+    encoder->writer = &encoder->variations[encoder->depth++];
+    return true;
+}
+
+static bool write_variation_length(struct bit_writer* writer, uint64_t length) {
+    ASSERT_PRINTF(length <= MAX_VARIATION_LENGTH, "Alternative moves of %" PRIu64 " bits are too long to be skipped !", length);
+    const uint8_t n_bits = how_many_bits_to_hold_number(length);
+    return write_bits(writer, VARIATION_LENGTH_SIZE_BITS, n_bits) && write_bits(writer, n_bits, length);
+}
+
+// writes the length of the innermost alternative moves, then their bits, in the enclosing writer
+static bool end_variation(struct move_encoder* encoder) {
+    ASSERT_PRINTF(encoder->depth > 0, "Alternative moves end without having started !");
+    struct bit_writer* const variation = &encoder->variations[--encoder->depth];
+    encoder->writer = encoder->depth > 0 ? &encoder->variations[encoder->depth - 1] : encoder->output;
+
+    struct compressed_buf buf;
+    const bool status =
+        write_variation_length(encoder->writer, variation->n_bits) &&
+        make_compressed_buf(&buf, variation->buf, (variation->n_bits + 7) / 8) &&
+        copy_bits(encoder->writer, &buf, 0, variation->n_bits);
+    bit_writer_free(variation);
+    return status;
+}
+
+bool encode_moves(struct bit_writer* writer, const struct token_list* tokens, size_t first_token, enum move_coding coding, const struct token_huffman* huffman, bool variation_lengths) {
+    // the range decoder reads ahead, only the end of the game token tells it where the game stops
+    ASSERT_PRINTF(coding != ARITHMETIC_CODING || (tokens->n_tokens > first_token && tokens->tokens[tokens->n_tokens - 1].type == END_OF_THE_GAME),
+        "Arithmetic coded games must end with an end of the game token !");
+    ASSERT_PRINTF(huffman == NULL || has_token_type_prefix(coding), "The %s coding has no token types to Huffman code !", MOVE_CODING_NAMES[coding]);
+    ASSERT_PRINTF(!variation_lengths || coding != ARITHMETIC_CODING, "Arithmetic coded alternative moves cannot be skipped, they have no length !");
+
+    struct move_encoder* const encoder = malloc(sizeof(struct move_encoder));
+    if (encoder == NULL) {
+        errprintf("Cannot allocate move encoder !\n");
+        return false;
+    }
+    encoder->coding = coding;
+    encoder->writer = writer;
+    encoder->huffman = huffman;
+    encoder->output = writer;
+    encoder->variations = NULL;
+    encoder->depth = 0;
+    encoder->max_depth = VARIATIONS_INITIAL_DEPTH;
+    if (variation_lengths && (encoder->variations = malloc(sizeof(struct bit_writer) * encoder->max_depth)) == NULL) {
+        errprintf("Cannot allocate the alternative moves writers !\n");
+        free(encoder);
+        return false;
+    }
+    if (coding == ARITHMETIC_CODING) {
+        range_encoder_init(&encoder->range_encoder, writer);
+        move_model_init(&encoder->model);
+    }
+
+    struct board_state state = empty_board_state();
+    bool status = true;
+    for (size_t i = 0; status && i < tokens->n_tokens; i++) {
+        const struct pgn_token* const token = &tokens->tokens[i];
+        if (i < first_token) {
+            ASSERT_PRINTF(is_token_a_move(token->type), "Only main line moves can be skipped !");
+            apply_move(token, &state);
+            next_turn(&state);
+        } else if (!encode_token(encoder, &state, token)) {
+            status = false;
+        } else if (is_token_a_move(token->type)) {
+            status = apply_move(token, &state);
+            next_turn(&state);
+        } else if (token->type == ALTERNATIVE_MOVE) {
+            status = token->move.alternative_moves_is_end ? board_end_alternative_moves(&state) : board_start_alternative_moves(&state);
+            if (status && variation_lengths) {
+                status = token->move.alternative_moves_is_end ? end_variation(encoder) : start_variation(encoder);
+            }
+        }
+    }
+    if (status && coding == ARITHMETIC_CODING) {
+        status = range_encoder_flush(&encoder->range_encoder);
+    }
+    if (status && encoder->depth > 0) {
+        fprintf(stderr, "%zu alternative moves never end !\n", encoder->depth);
+        status = false;
+    }
+    while (encoder->depth > 0) {
+        bit_writer_free(&encoder->variations[--encoder->depth]);
+    }
+    free_board_state(&state);
+    free(encoder->variations);
+    free(encoder);
+    return status;
+}
+
+bool encode_game(struct bit_writer* writer, const struct tag* tags, size_t n_tags, const struct token_list* tokens, enum move_coding coding) {
+    ASSERT_PRINTF(writer != NULL, "Bit writer is NULL !");
+    ASSERT_PRINTF(tokens != NULL, "Token list is NULL !");
+
+    if (!write_bits(writer, 8, make_version(coding, false))) {
+        return false;
+    }
+    for (size_t i = 0; i < n_tags; i++) {
+        if (!write_string(writer, tags[i].name) || !write_string(writer, tags[i].value)) {
+            return false;
+        }
+    }
+    return
+        write_bits(writer, 8, '\0') && // end of the tags
+        write_bits(writer, N_EN_PASSANT_BITS, 0) &&
+        encode_moves(writer, tokens, 0, coding, NULL, false) &&
+        bit_writer_align(writer);
+}
+
+/**
+ * State of a transcoding, shared by the passes over the games.
+ */
+struct transcoder {
+    enum move_coding coding;
+    unsigned opening_plies; // 0 without opening trie
+    struct container_header header; // of the output
+    uint64_t frequencies[N_TOKEN_SYMBOLS];
+    const struct args* args;
+    struct dedup_set* written_games; // NULL without deduplication
+    size_t n_duplicates;
+    struct bit_writer writer;
+    struct block_writer block;
+};
+
+typedef bool (*game_pass)(struct compressed_buf* buf, const struct game_layout* layout, const struct token_list* tokens, struct transcoder* transcoder);
+
+// decodes every game of the container into the token list and gives it to the pass, then rewinds the buffer to the first game
+static bool run_pass(struct compressed_buf* buf, struct container_header* header, const struct uncompress_options* options, struct token_list* tokens, game_pass pass, struct transcoder* transcoder) {
+    const size_t games_start = bit_offset(buf);
+    bool status = true;
+    enum safe_bool has_game = FALSE;
+
+    while (status && (has_game = next_game(buf, header)) == TRUE) {
+        struct game_layout layout;
+        token_list_clear(tokens);
+        status = uncompress_game(buf, options, &layout, NULL, NULL) == TRUE && !tokens->failed && pass(buf, &layout, tokens, transcoder);
+    }
+    header->block = (struct block_cursor) { 0 };
+    return status && has_game != ERROR && seek_bit_offset(buf, games_start);
+}
+
+// node of the output opening trie the game starts from, 0 if there's none
+static size_t opening_node_of(const struct transcoder* transcoder, const struct token_list* tokens) {
+    const struct opening_trie* const trie = container_trie(&transcoder->header);
+    return trie != NULL ? opening_trie_find(trie, tokens->tokens, tokens->n_tokens) : 0;
+}
+
+static bool add_to_opening_trie(struct compressed_buf* buf, const struct game_layout* layout, const struct token_list* tokens, struct transcoder* transcoder) {
+    (void)buf;
+    (void)layout;
+    return opening_trie_add_game(&transcoder->header.trie, tokens->tokens, tokens->n_tokens, transcoder->opening_plies);
+}
+
+static bool count_token_types(struct compressed_buf* buf, const struct game_layout* layout, const struct token_list* tokens, struct transcoder* transcoder) {
+    (void)buf;
+    (void)layout;
+    const size_t opening_node = opening_node_of(transcoder, tokens);
+    for (size_t i = opening_node != 0 ? transcoder->header.trie.nodes[opening_node].state.ply : 0; i < tokens->n_tokens; i++) {
+        const uint8_t symbol = token_symbol(tokens->tokens[i].type);
+        if (symbol < N_TOKEN_SYMBOLS) {
+            transcoder->frequencies[symbol]++;
+        }
+    }
+    return true;
+}
+
+// writes the game as a reference to the moves of its first occurrence in the output if it has one, followed by its own tags, otherwise records the game there
+static enum safe_bool write_if_duplicate(struct compressed_buf* buf, const struct game_layout* layout, const struct token_list* tokens, struct transcoder* transcoder) {
+    if (transcoder->written_games == NULL) {
+        return FALSE;
+    }
+
+    const size_t tags_start = layout->tags_start / 8; // the tags are whole bytes
+    const size_t tags_end = layout->tags_end / 8;
+    const struct game_hash hash = hash_game(tokens, buf->buf + tags_start, tags_end - tags_start, transcoder->args->dedup_tags);
+    uint64_t offset = transcoder->writer.n_bits / 8;
+    const enum safe_bool is_duplicate = dedup_set_find_or_add(transcoder->written_games, hash, &offset);
+    if (is_duplicate != TRUE) {
+        return is_duplicate;
+    }
+
+    transcoder->n_duplicates++;
+    const bool status =
+        write_bits(&transcoder->writer, 8, VERSION_DUPLICATE) &&
+        write_bits(&transcoder->writer, DUPLICATE_OFFSET_BITS, offset) &&
+        copy_bits(&transcoder->writer, buf, layout->tags_start, layout->tags_end - layout->tags_start) &&
+        bit_writer_align(&transcoder->writer);
+    return status ? TRUE : ERROR;
+}
+
+static bool transcode_game(struct compressed_buf* buf, const struct game_layout* layout, const struct token_list* tokens, struct transcoder* transcoder) {
+    if (transcoder->args->block_size > 0) {
+        const enum safe_bool is_new_block = begin_block_game(&transcoder->writer, &transcoder->block, transcoder->args->block_size);
+        if (is_new_block == ERROR) {
+            return false;
+        }
+        // references stay inside their block, so that it can be decoded on its own
+        if (is_new_block == TRUE && transcoder->written_games != NULL) {
+            dedup_set_clear(transcoder->written_games);
+        }
+    }
+    const enum safe_bool is_duplicate = write_if_duplicate(buf, layout, tokens, transcoder);
+    if (is_duplicate != FALSE) {
+        return is_duplicate == TRUE;
+    }
+
+    const struct token_huffman* const huffman = container_huffman(&transcoder->header);
+    const size_t opening_node = opening_node_of(transcoder, tokens);
+    uint8_t version = make_version(transcoder->coding, false) | (huffman != NULL ? VERSION_HUFFMAN_TOKENS : 0);
+    if (opening_node != 0) {
+        version |= VERSION_OPENING_TRIE;
+    }
+
+    return
+        write_bits(&transcoder->writer, 8, version) &&
+        copy_game_header(&transcoder->writer, buf, layout) &&
+        (opening_node == 0 || write_bits(&transcoder->writer, opening_node_id_bits(&transcoder->header.trie), opening_node)) &&
+        encode_moves(&transcoder->writer, tokens, opening_node != 0 ? transcoder->header.trie.nodes[opening_node].state.ply : 0, transcoder->coding, huffman, transcoder->args->variation_lengths) &&
+        bit_writer_align(&transcoder->writer);
+}
+
+int transcode(const struct args* args) {
+    ASSERT_PRINTF_EXIT_FAILURE(args != NULL, "args is NULL !");
+    ASSERT_PRINTF_EXIT_FAILURE(args->input != NULL && args->output != NULL, "Transcoding requires an input and an output (-o) !");
+
+    enum move_coding coding;
+    if (!move_coding_from_name(args->transcode, &coding)) {
+        fprintf(stderr, "Unknown move coding '%s' !\n", args->transcode);
+        return EXIT_FAILURE;
+    } else if (args->huffman && !has_token_type_prefix(coding)) {
+        fprintf(stderr, "The %s coding has no token types to Huffman code !\n", MOVE_CODING_NAMES[coding]);
+        return EXIT_FAILURE;
+    } else if (args->variation_lengths && coding == ARITHMETIC_CODING) {
+        fprintf(stderr, "The %s coding cannot skip alternative moves, they have no length !\n", MOVE_CODING_NAMES[coding]);
+        return EXIT_FAILURE;
+    }
+
+    size_t size;
+    unsigned char* const raw_buf = read_compressed_file(args->input, &size);
+    if (raw_buf == NULL) {
+        fprintf(stderr, "Error while reading %s\n", args->input);
+        return EXIT_FAILURE;
+    }
+    struct compressed_buf buf;
+    make_compressed_buf(&buf, raw_buf, size);
+    struct container_header input_header = { 0 };
+
+    struct token_list tokens = { 0 };
+    struct dedup_set written_games = { 0 };
+    struct transcoder transcoder = {
+        .coding = coding,
+        .opening_plies = args->opening_trie,
+        .args = args,
+        .written_games = args->dedup ? &written_games : NULL
+    };
+    struct uncompress_options options = {
+        .print = false,
+        .cache = NULL,
+        .on_token = record_token,
+        .token_data = &tokens,
+        .log = args->log
+    };
+    bool status = read_container_header(&buf, &input_header);
+    options.huffman = container_huffman(&input_header);
+    options.trie = container_trie(&input_header);
+    options.variation_lengths = container_has_variation_lengths(&input_header);
+
+    // the opening trie comes first, as the moves it holds aren't counted by the Huffman code
+    if (status && args->opening_trie > 0 && (status = opening_trie_init(&transcoder.header.trie))) {
+        transcoder.header.flags |= CONTAINER_OPENING_TRIE;
+        status = run_pass(&buf, &input_header, &options, &tokens, add_to_opening_trie, &transcoder) && opening_trie_prune(&transcoder.header.trie, OPENING_TRIE_MIN_GAMES);
+    }
+    if (status && args->huffman) {
+        status = run_pass(&buf, &input_header, &options, &tokens, count_token_types, &transcoder);
+        token_huffman_from_frequencies(&transcoder.header.huffman, transcoder.frequencies);
+        transcoder.header.flags |= CONTAINER_HUFFMAN_TOKENS;
+    }
+    if (args->block_size > 0) {
+        transcoder.header.flags |= CONTAINER_BLOCKS;
+    }
+    if (args->variation_lengths) {
+        transcoder.header.flags |= CONTAINER_VARIATION_LENGTHS;
+    }
+    status = status && bit_writer_init(&transcoder.writer) && write_container_header(&transcoder.writer, &transcoder.header);
+    status = status && (!args->dedup || dedup_set_init(&written_games));
+    status = status && run_pass(&buf, &input_header, &options, &tokens, transcode_game, &transcoder) && end_block(&transcoder.writer, &transcoder.block);
+    status = status && bit_writer_save(&transcoder.writer, args->output);
+    if (status && args->dedup) {
+        printf("%zu duplicate game%s stored as reference%s\n", transcoder.n_duplicates, transcoder.n_duplicates >= 2 ? "s" : "", transcoder.n_duplicates >= 2 ? "s" : "");
+    }
+
+    dedup_set_free(&written_games);
+    bit_writer_free(&transcoder.writer);
+    free_container_header(&transcoder.header);
+    free_container_header(&input_header);
+    token_list_free(&tokens);
+    free(raw_buf);
+    return status ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,118 @@
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/bitboard.h"
+#include "../include/error.h"
+#include "../include/fen.h"
+#include "../include/parse.h"
+
+static bool parse_placement(const char** fen, board board) {
+    int rank = BOARD_SIZE - 1;
+    int file = 0;
+
+    for (; **fen != '\0' && **fen != ' '; (*fen)++) {
+        const char c = **fen;
+        if (c == '/') {
+            ASSERT_PRINTF(file == BOARD_SIZE && rank > 0, "Invalid FEN rank %d !", rank + 1);
+            rank--;
+            file = 0;
+        } else if (c >= '1' && c <= '8') {
+            ASSERT_PRINTF(file + (c - '0') <= BOARD_SIZE, "Too many squares in FEN rank %d !", rank + 1);
+            for (int i = 0; i < c - '0'; i++) {
+                board[rank][file++] = EMPTY_PIECE;
+            }
+        } else {
+            const enum piece_type piece = toupper(c) == 'P' ? PAWN : to_piece(toupper(c));
+            ASSERT_PRINTF(piece != EMPTY_SQUARE, "Invalid FEN piece '%c' !", c);
+            ASSERT_PRINTF(file < BOARD_SIZE, "Too many squares in FEN rank %d !", rank + 1);
+            board[rank][file++] = (struct piece) {
+                .type = piece,
+                .player = isupper(c) ? WHITE : BLACK
+            };
+        }
+    }
+    ASSERT_PRINTF(rank == 0 && file == BOARD_SIZE, "Incomplete FEN piece placement !");
+    return true;
+}
+
+static bool parse_castling_rights(const char** fen, uint8_t* castling_rights) {
+    *castling_rights = 0;
+    if (**fen == '-') {
+        (*fen)++;
+        return true;
+    }
+    for (; **fen != '\0' && **fen != ' '; (*fen)++) {
+        switch (**fen) {
+            case 'K': *castling_rights |= CASTLING_RIGHT(WHITE, KINGSIDE); break;
+            case 'Q': *castling_rights |= CASTLING_RIGHT(WHITE, QUEENSIDE); break;
+            case 'k': *castling_rights |= CASTLING_RIGHT(BLACK, KINGSIDE); break;
+            case 'q': *castling_rights |= CASTLING_RIGHT(BLACK, QUEENSIDE); break;
+            default:
+                fprintf(stderr, "Invalid FEN castling right '%c' !\n", **fen);
+                return false;
+        }
+    }
+    return true;
+}
+
+static void skip_spaces(const char** fen) {
+    while (**fen == ' ') {
+        (*fen)++;
+    }
+}
+
+bool board_state_from_fen(const char* fen, struct board_state* state) {
+    ASSERT_PRINTF(fen != NULL, "FEN is NULL !");
+    ASSERT_PRINTF(state != NULL, "Board state is NULL !");
+
+    *state = empty_board_state();
+    skip_spaces(&fen);
+    if (!parse_placement(&fen, state->board)) {
+        goto error;
+    }
+    compute_bitboards(state->board, &state->bitboards);
+    if (state->bitboards.king_square[WHITE] == N_SQUARES || state->bitboards.king_square[BLACK] == N_SQUARES) {
+        fputs("A king is missing in the FEN !\n", stderr);
+        goto error;
+    }
+
+    skip_spaces(&fen);
+    if (*fen != 'w' && *fen != 'b') {
+        fputs("Invalid FEN side to move !\n", stderr);
+        goto error;
+    }
+    state->current_player = *fen++ == 'w' ? WHITE : BLACK;
+
+    skip_spaces(&fen);
+    if (!parse_castling_rights(&fen, &state->castling_rights)) {
+        goto error;
+    }
+
+    skip_spaces(&fen);
+    state->en_passant_file = INVALID_COORD;
+    if (*fen == '-') {
+        fen++;
+    } else if (is_file(fen[0]) && is_rank(fen[1])) {
+        state->en_passant_file = to_file(fen[0]);
+        fen += 2;
+    } else {
+        fputs("Invalid FEN en passant square !\n", stderr);
+        goto error;
+    }
+
+    // move counters are optional, the halfmove clock isn't tracked
+    skip_spaces(&fen);
+    strtoul(fen, (char**)&fen, 10);
+    skip_spaces(&fen);
+    const unsigned long move_turn = strtoul(fen, NULL, 10);
+    if (move_turn > 0) {
+        state->move_turn = move_turn;
+    }
+    return true;
+
+error:
+    free_board_state(state);
+    return false;
+}
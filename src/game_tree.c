@@ -0,0 +1,90 @@
+#include "../include/error.h"
+#include "../include/game_tree.h"
+
+/**
+ * Lines being built, the main line being at depth 0.
+ */
+struct tree_builder {
+    struct game_tree* tree;
+    struct game_node* last[MAX_VARIATION_DEPTH + 1]; // last node of the line at each depth, NULL before its first node
+    struct game_node* parent[MAX_VARIATION_DEPTH + 1]; // node each alternative line comes right after
+    size_t depth;
+    bool failed;
+};
+
+static void add_node(struct tree_builder* builder, const struct pgn_token* token) {
+    struct game_node* const node = arena_alloc(&builder->tree->arena, sizeof(struct game_node));
+    if (node == NULL) {
+        builder->failed = true;
+        return;
+    }
+    *node = (struct game_node) {
+        .token = *token
+    };
+
+    struct game_node* const last = builder->last[builder->depth];
+    if (last != NULL) {
+        last->next = node;
+    } else if (builder->depth == 0) {
+        builder->tree->main_line = node;
+    } else {
+        struct game_node** line = &builder->parent[builder->depth]->variations;
+        while (*line != NULL) {
+            line = &(*line)->next_variation;
+        }
+        *line = node;
+    }
+    builder->last[builder->depth] = node;
+    builder->tree->n_nodes++;
+}
+
+static void add_token(const struct pgn_token* token, void* data) {
+    struct tree_builder* const builder = data;
+
+    if (builder->failed) {
+        return;
+    } else if (token->type != ALTERNATIVE_MOVE) {
+        add_node(builder, token);
+    } else if (token->move.alternative_moves_is_end) {
+        builder->depth--; // the decoder already checked the nesting
+    } else if (builder->last[builder->depth] == NULL) {
+        errprintf("Alternative moves cannot start a line !\n");
+        builder->failed = true;
+    } else {
+        builder->parent[builder->depth + 1] = builder->last[builder->depth];
+        builder->last[++builder->depth] = NULL;
+    }
+}
+
+enum safe_bool uncompress_game_tree(struct compressed_buf* buf, const struct uncompress_options* options, struct game_layout* layout, struct game_tree* tree) {
+    ASSERT_PRINTF_RETURN_ERROR(options != NULL, "Uncompress options are NULL !");
+    ASSERT_PRINTF_RETURN_ERROR(tree != NULL, "Game tree is NULL !");
+
+    *tree = (struct game_tree) {
+        .main_line = NULL,
+        .n_nodes = 0
+    };
+    arena_init(&tree->arena);
+    struct tree_builder builder = {
+        .tree = tree,
+        .depth = 0,
+        .failed = false
+    };
+    builder.last[0] = NULL;
+    struct uncompress_options tree_options = *options;
+    tree_options.on_token = add_token;
+    tree_options.token_data = &builder;
+    tree_options.arena = &tree->arena;
+
+    if (uncompress_game(buf, &tree_options, layout, NULL, NULL) != TRUE || builder.failed) {
+        game_tree_free(tree);
+        return ERROR;
+    }
+    return TRUE;
+}
+
+void game_tree_free(struct game_tree* tree) {
+    arena_free(&tree->arena);
+    tree->main_line = NULL;
+    tree->n_nodes = 0;
+}
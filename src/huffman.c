@@ -0,0 +1,144 @@
+#include <inttypes.h>
+#include <string.h>
+
+#include "../include/error.h"
+#include "../include/huffman.h"
+
+const enum token_type TOKEN_SYMBOLS[N_TOKEN_SYMBOLS] = {
+    MOVE_KING, MOVE_QUEEN, MOVE_BISHOP, MOVE_KNIGHT, MOVE_ROOK, MOVE_PAWN,
+    CASTLING, PROMOTION, COMMENT, ALTERNATIVE_MOVE, NAG, END_OF_THE_GAME
+};
+
+uint8_t token_symbol(enum token_type type) {
+    uint8_t symbol = 0;
+    while (symbol < N_TOKEN_SYMBOLS && TOKEN_SYMBOLS[symbol] != type) {
+        symbol++;
+    }
+    return symbol;
+}
+
+// Huffman's algorithm, returns false if a code is longer than MAX_TOKEN_CODE_LENGTH
+static bool compute_code_lengths(const uint64_t weights[N_TOKEN_SYMBOLS], uint8_t lengths[N_TOKEN_SYMBOLS]) {
+    uint64_t node_weights[2 * N_TOKEN_SYMBOLS - 1];
+    uint8_t parents[2 * N_TOKEN_SYMBOLS - 1];
+    bool is_merged[2 * N_TOKEN_SYMBOLS - 1] = { false };
+    uint8_t n_nodes = N_TOKEN_SYMBOLS;
+
+    memcpy(node_weights, weights, sizeof(uint64_t) * N_TOKEN_SYMBOLS);
+    while (n_nodes < 2 * N_TOKEN_SYMBOLS - 1) {
+        uint8_t lightest[2] = { n_nodes, n_nodes };
+        for (uint8_t node = 0; node < n_nodes; node++) {
+            if (is_merged[node]) {
+                continue;
+            } else if (lightest[0] == n_nodes || node_weights[node] < node_weights[lightest[0]]) {
+                lightest[1] = lightest[0];
+                lightest[0] = node;
+            } else if (lightest[1] == n_nodes || node_weights[node] < node_weights[lightest[1]]) {
+                lightest[1] = node;
+            }
+        }
+        node_weights[n_nodes] = node_weights[lightest[0]] + node_weights[lightest[1]];
+        for (uint8_t i = 0; i < 2; i++) {
+            is_merged[lightest[i]] = true;
+            parents[lightest[i]] = n_nodes;
+        }
+        n_nodes++;
+    }
+
+    for (uint8_t symbol = 0; symbol < N_TOKEN_SYMBOLS; symbol++) {
+        uint8_t length = 0;
+        for (uint8_t node = symbol; node != n_nodes - 1; node = parents[node]) {
+            length++;
+        }
+        if (length > MAX_TOKEN_CODE_LENGTH) {
+            return false;
+        }
+        lengths[symbol] = length;
+    }
+    return true;
+}
+
+void token_huffman_from_frequencies(struct token_huffman* huffman, const uint64_t frequencies[N_TOKEN_SYMBOLS]) {
+    uint64_t weights[N_TOKEN_SYMBOLS];
+    uint8_t lengths[N_TOKEN_SYMBOLS];
+
+    for (uint8_t symbol = 0; symbol < N_TOKEN_SYMBOLS; symbol++) {
+        weights[symbol] = frequencies[symbol] + 1;
+    }
+    // flattening the weights until the longest code fits, it ends up balanced at worst
+    while (!compute_code_lengths(weights, lengths)) {
+        for (uint8_t symbol = 0; symbol < N_TOKEN_SYMBOLS; symbol++) {
+            weights[symbol] = weights[symbol] / 2 + 1;
+        }
+    }
+    token_huffman_from_lengths(huffman, lengths);
+}
+
+bool token_huffman_from_lengths(struct token_huffman* huffman, const uint8_t lengths[N_TOKEN_SYMBOLS]) {
+    unsigned table_entries = 0;
+    for (uint8_t symbol = 0; symbol < N_TOKEN_SYMBOLS; symbol++) {
+        ASSERT_PRINTF(lengths[symbol] >= 1 && lengths[symbol] <= MAX_TOKEN_CODE_LENGTH, "Invalid code length %" PRIu8 " for token symbol %" PRIu8 " !", lengths[symbol], symbol);
+        table_entries += 1 << (MAX_TOKEN_CODE_LENGTH - lengths[symbol]);
+    }
+    ASSERT_PRINTF(table_entries == 1 << MAX_TOKEN_CODE_LENGTH, "Token code lengths don't make a complete prefix code !");
+
+    // canonical codes : shorter codes first, then by symbol
+    unsigned code = 0;
+    for (uint8_t length = 1; length <= MAX_TOKEN_CODE_LENGTH; length++) {
+        for (uint8_t symbol = 0; symbol < N_TOKEN_SYMBOLS; symbol++) {
+            if (lengths[symbol] != length) {
+                continue;
+            }
+            huffman->lengths[symbol] = length;
+            huffman->codes[symbol] = code;
+            const unsigned first = code << (MAX_TOKEN_CODE_LENGTH - length);
+            for (unsigned entry = first; entry < first + (1u << (MAX_TOKEN_CODE_LENGTH - length)); entry++) {
+                huffman->table[entry] = (struct token_code) { .symbol = symbol, .length = length };
+            }
+            code++;
+        }
+        code <<= 1;
+    }
+    return true;
+}
+
+bool write_token_huffman(struct bit_writer* writer, const struct token_huffman* huffman) {
+    for (uint8_t symbol = 0; symbol < N_TOKEN_SYMBOLS; symbol++) {
+        if (!write_bits(writer, TOKEN_CODE_LENGTH_BITS, huffman->lengths[symbol])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool read_token_huffman(struct compressed_buf* buf, struct token_huffman* huffman) {
+    uint8_t lengths[N_TOKEN_SYMBOLS];
+    for (uint8_t symbol = 0; symbol < N_TOKEN_SYMBOLS; symbol++) {
+        ASSERT_PRINTF(read_n_bits(buf, TOKEN_CODE_LENGTH_BITS, &lengths[symbol]), "Cannot read the code length of token symbol %" PRIu8 " !", symbol);
+    }
+    return token_huffman_from_lengths(huffman, lengths);
+}
+
+bool write_token_type(struct bit_writer* writer, const struct token_huffman* huffman, enum token_type type) {
+    const uint8_t symbol = token_symbol(type);
+    ASSERT_PRINTF(symbol < N_TOKEN_SYMBOLS, "Token type %d has no code !", type);
+    return write_bits(writer, huffman->lengths[symbol], huffman->codes[symbol]);
+}
+
+bool read_token_type(struct compressed_buf* buf, const struct token_huffman* huffman, enum token_type* type) {
+    if (is_buf_empty(buf)) {
+        return false;
+    }
+    // the last code of the buffer may be shorter than the peek, the missing bits are read as 0
+    const uint8_t n_peeked = buf->remaining_bits < MAX_TOKEN_CODE_LENGTH ? buf->remaining_bits : MAX_TOKEN_CODE_LENGTH;
+    uint8_t bits;
+    if (!peek_n_bits(buf, n_peeked, &bits)) {
+        return false;
+    }
+    const struct token_code code = huffman->table[(uint8_t)(bits << (MAX_TOKEN_CODE_LENGTH - n_peeked))];
+    ASSERT_PRINTF(code.length <= n_peeked, "Truncated token type code !");
+
+    uint8_t discarded;
+    *type = TOKEN_SYMBOLS[code.symbol];
+    return read_n_bits(buf, code.length, &discarded);
+}
@@ -10,7 +10,7 @@
 bool can_king_move_to(struct coord from, struct coord to, enum player moving_player, board board, bool check_is_is_dest_square_safe) {
     if (abs(from.file - to.file) > 1 || abs(from.rank - to.rank) > 1) {
         return false; // king can only move 1 square
-    } else if (board_at_coord(board, to)->type != EMPTY_SQUARE) {
+    } else if (board_at_coord(board, to)->type != EMPTY_SQUARE && board_at_coord(board, to)->player == moving_player) {
         return false;
     }
 
@@ -125,13 +125,13 @@ static bool check_castling_move(const struct move* move, board board) {
 }
 
 // forwards last argument
-static bool _can_king_move_to(struct coord from, struct coord to, enum player moving_player, board board) {
+bool can_king_safely_move_to(struct coord from, struct coord to, enum player moving_player, board board) {
     return can_king_move_to(from, to, moving_player, board, true);
 }
 
 bool parse_king_move(struct move* move, const char* str, enum player moving_player, board board) {
     if (parse_move(move, KING, str, moving_player)) {
-        ASSERT_PRINTF(find_starting_square(board, move, _can_king_move_to), "Cannot find a starting square !\nMove: '%s'", move->algebraic_move);
+        ASSERT_PRINTF(find_starting_square(board, move, can_king_safely_move_to), "Cannot find a starting square !\nMove: '%s'", move->algebraic_move);
         return true;
     } else if (parse_castling_move(move, str, moving_player)) {
         ASSERT_PRINTF(check_castling_move(move, board), "Forbidden castling !\nMove: %s", move->algebraic_move);
@@ -0,0 +1,72 @@
+#include <string.h>
+
+#include "../include/bits.h"
+#include "../include/legal_index.h"
+
+uint8_t legal_index_bits(uint8_t n_moves) {
+    return how_many_bits_to_hold_number(n_moves + N_SPECIAL_INDICES - 1);
+}
+
+static bool is_token_the_legal_move(const struct pgn_token* token, const struct legal_move* move) {
+    const struct move* const token_move = &token->move.move;
+
+    switch (token->type) {
+        case CASTLING:
+            return move->is_castling && move->castling == token_move->extra_infos.infos.king_infos.castling;
+
+        case PROMOTION:
+            return
+                move->promotion_piece == token_move->extra_infos.infos.pawn_infos.promotion_piece &&
+                are_coords_equal(&move->from, &token_move->from) &&
+                are_coords_equal(&move->to, &token_move->to);
+
+        default:
+            return
+                !move->is_castling &&
+                move->promotion_piece == EMPTY_SQUARE &&
+                are_coords_equal(&move->from, &token_move->from) &&
+                are_coords_equal(&move->to, &token_move->to);
+    }
+}
+
+bool find_legal_move_index(const struct legal_move moves[], uint8_t n_moves, const struct pgn_token* token, uint8_t* index) {
+    for (uint8_t i = 0; i < n_moves; i++) {
+        if (is_token_the_legal_move(token, &moves[i])) {
+            *index = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void legal_move_to_token(board board, enum player player, const struct legal_move* move, struct pgn_token* token) {
+    memset(token, 0, sizeof(struct pgn_token));
+    struct move* const token_move = &token->move.move;
+    token_move->player = player;
+    token_move->piece = move->piece;
+    token_move->from = move->from;
+    token_move->to = move->to;
+    token_move->capture = board_at_coord(board, move->to)->type != EMPTY_SQUARE;
+    token_move->extra_infos.piece_type = move->piece;
+
+    if (move->is_castling) {
+        token->type = CASTLING;
+        token_move->algebraic_move = move->castling == QUEENSIDE ? "O-O-O" : "O-O";
+        token_move->extra_infos.infos.king_infos = (struct king_move_infos) {
+            .is_castling = true,
+            .castling = move->castling
+        };
+    } else if (move->promotion_piece != EMPTY_SQUARE) {
+        token->type = PROMOTION;
+        token_move->extra_infos.infos.pawn_infos = (struct pawn_move_infos) {
+            .promoted = true,
+            .promotion_piece = move->promotion_piece
+        };
+    } else {
+        token->type = (enum token_type)move->piece;
+        if (move->piece == PAWN && move->from.file != move->to.file && !token_move->capture) {
+            token_move->capture = true;
+            token_move->extra_infos.infos.pawn_infos.en_passant = true;
+        }
+    }
+}
@@ -1,3 +0,0 @@
-#include "../include/log.h"
-
-bool log_enabled = true;
@@ -1,14 +1,21 @@
+#include <inttypes.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "../include/args.h"
+#include "../include/checkpoint.h"
 #include "../include/compress.h"
+#include "../include/container.h"
+#include "../include/encode.h"
 #include "../include/error.h"
+#include "../include/opening_trie.h"
+#include "../include/position_index.h"
 #include "../include/read.h"
+#include "../include/roundtrip.h"
 #include "../include/safe_bool.h"
-#include "../include/source_location.h"
 #include "../include/uncompress.h"
 
 static void print_args(const struct args* args) {
@@ -17,12 +24,42 @@ static void print_args(const struct args* args) {
         "\tcompress = %d\n"
         "\tuncompress = %d\n"
         "\thelp = %d\n"
+        "\tindex = %d\n"
+        "\tverify = %d\n"
+        "\troundtrip = %d\n"
+        "\tfind_position = '%s'\n"
+        "\tcheckpoints = %u\n"
+        "\tply = %ld\n"
+        "\ttranscode = '%s'\n"
+        "\thuffman = %d\n"
+        "\topening_trie = %u\n"
+        "\tdedup = %d\n"
+        "\tdedup_tags = '%s'\n"
+        "\tblock_size = %lu\n"
+        "\tvariation_lengths = %d\n"
+        "\tmainline_only = %d\n"
+        "\tlog = %d\n"
         "\tinput = '%s'\n"
         "\toutput = '%s'\n"
         "}\n",
         args->compress,
         args->uncompress,
         args->help,
+        args->index,
+        args->verify,
+        args->roundtrip,
+        (args->find_position == NULL) ? "NULL" : args->find_position,
+        args->checkpoints,
+        args->ply,
+        (args->transcode == NULL) ? "NULL" : args->transcode,
+        args->huffman,
+        args->opening_trie,
+        args->dedup,
+        (args->dedup_tags == NULL) ? "NULL" : args->dedup_tags,
+        args->block_size,
+        args->variation_lengths,
+        args->mainline_only,
+        args->log,
         (args->input == NULL) ? "NULL" : args->input,
         (args->output == NULL) ? "NULL" : args->output
     );
@@ -32,12 +69,34 @@ static const struct args EMPTY_ARGS = {
     .compress = false,
     .uncompress = false,
     .help = false,
+    .index = false,
+    .verify = false,
+    .roundtrip = false,
+    .find_position = NULL,
+    .checkpoints = 0,
+    .ply = -1,
+    .transcode = NULL,
+    .huffman = false,
+    .opening_trie = 0,
+    .dedup = false,
+    .dedup_tags = NULL,
+    .block_size = 0,
+    .variation_lengths = false,
+    .mainline_only = false,
+    .log = true,
     .input = NULL,
     .output = NULL
 };
 
 static void help(void) {
-    puts("./pgn_compressor -c|--compress|-u|--uncompress file [-o output]");
+    puts("./pgn_compressor -c|--compress|-u|--uncompress file [-o output] [--mainline-only]");
+    puts("./pgn_compressor -i|--index container [-o index]");
+    puts("./pgn_compressor --find-position FEN index");
+    puts("./pgn_compressor --verify container");
+    puts("./pgn_compressor --roundtrip container");
+    puts("./pgn_compressor --checkpoints plies container -o output");
+    puts("./pgn_compressor -u|--uncompress file --ply ply");
+    puts("./pgn_compressor --transcode prefix|indices|max|destinations container -o output [--huffman] [--opening-trie plies] [--dedup [--dedup-tags tag,...]] [--block-size bytes] [--variation-lengths]");
 }
 
 static enum safe_bool parse_bool_arg(bool* flag, const char* flag_names[], size_t n_names, const char* arg) {
@@ -59,21 +118,84 @@ static bool parse_args(struct args* args, int argc, char* argv[]) {
     *args = EMPTY_ARGS;
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "--no-log") == 0) {
-            log_enabled = false;
+            args->log = false;
             continue;
         } else if (strcmp(argv[i], "-o") == 0) {
-            if (is_reading_input) {
+            if (!is_reading_input) {
                 fputs("Cannot have multiple -o !\n", stderr);
                 return false;
             }
             is_reading_input = false;
             continue;
+        } else if (strcmp(argv[i], "--find-position") == 0) {
+            if (args->find_position != NULL || i + 1 == argc) {
+                fputs("--find-position expects a single FEN !\n", stderr);
+                return false;
+            }
+            args->find_position = argv[++i];
+            continue;
+        } else if (strcmp(argv[i], "--transcode") == 0) {
+            if (args->transcode != NULL || i + 1 == argc) {
+                fputs("--transcode expects a single move coding !\n", stderr);
+                return false;
+            }
+            args->transcode = argv[++i];
+            continue;
+        } else if (strcmp(argv[i], "--dedup-tags") == 0) {
+            if (args->dedup_tags != NULL || i + 1 == argc) {
+                fputs("--dedup-tags expects a single comma separated list of tag names !\n", stderr);
+                return false;
+            }
+            args->dedup_tags = argv[++i];
+            continue;
+        } else if (strcmp(argv[i], "--checkpoints") == 0 || strcmp(argv[i], "--ply") == 0) {
+            const bool is_checkpoints = strcmp(argv[i], "--checkpoints") == 0;
+            char* end = NULL;
+            const long value = i + 1 < argc ? strtol(argv[i + 1], &end, 10) : -1;
+            if (end == NULL || *end != '\0' || value < (is_checkpoints ? 1 : 0) || value > UINT16_MAX) {
+                fprintf(stderr, "%s expects a number of plies !\n", argv[i]);
+                return false;
+            }
+            if (is_checkpoints) {
+                args->checkpoints = value;
+            } else {
+                args->ply = value;
+            }
+            i++;
+            continue;
+        } else if (strcmp(argv[i], "--opening-trie") == 0) {
+            char* end = NULL;
+            const long value = i + 1 < argc ? strtol(argv[i + 1], &end, 10) : -1;
+            if (end == NULL || *end != '\0' || value < 1 || value > MAX_OPENING_PLIES) {
+                fprintf(stderr, "--opening-trie expects a number of plies between 1 and %d !\n", MAX_OPENING_PLIES);
+                return false;
+            }
+            args->opening_trie = value;
+            i++;
+            continue;
+        } else if (strcmp(argv[i], "--block-size") == 0) {
+            char* end = NULL;
+            const long value = i + 1 < argc ? strtol(argv[i + 1], &end, 10) : -1;
+            if (end == NULL || *end != '\0' || value < 1 || value > UINT32_MAX) {
+                fprintf(stderr, "--block-size expects a number of bytes between 1 and %" PRIu32 " !\n", UINT32_MAX);
+                return false;
+            }
+            args->block_size = value;
+            i++;
+            continue;
         }
 
         enum safe_bool flag_found = FALSE;
         flag_found = parse_bool_arg(&args->compress, (const char*[]){ "-c", "--compress" }, 2, argv[i]);
         flag_found = safe_bool_or(flag_found, parse_bool_arg(&args->uncompress, (const char*[]){ "-u", "--uncompress" }, 2, argv[i]));
         flag_found = safe_bool_or(flag_found, parse_bool_arg(&args->help, (const char*[]){ "-h", "--help" }, 2, argv[i]));
+        flag_found = safe_bool_or(flag_found, parse_bool_arg(&args->index, (const char*[]){ "-i", "--index" }, 2, argv[i]));
+        flag_found = safe_bool_or(flag_found, parse_bool_arg(&args->verify, (const char*[]){ "--verify" }, 1, argv[i]));
+        flag_found = safe_bool_or(flag_found, parse_bool_arg(&args->roundtrip, (const char*[]){ "--roundtrip" }, 1, argv[i]));
+        flag_found = safe_bool_or(flag_found, parse_bool_arg(&args->huffman, (const char*[]){ "--huffman" }, 1, argv[i]));
+        flag_found = safe_bool_or(flag_found, parse_bool_arg(&args->dedup, (const char*[]){ "--dedup" }, 1, argv[i]));
+        flag_found = safe_bool_or(flag_found, parse_bool_arg(&args->variation_lengths, (const char*[]){ "--variation-lengths" }, 1, argv[i]));
+        flag_found = safe_bool_or(flag_found, parse_bool_arg(&args->mainline_only, (const char*[]){ "--mainline-only" }, 1, argv[i]));
         if (flag_found == FALSE) {
             if (is_reading_input) {
                 if (args->input != NULL) {
@@ -94,8 +216,6 @@ static bool parse_args(struct args* args, int argc, char* argv[]) {
 }
 
 int main(int argc, char* argv[]) {
-    atexit(loc_exit);
-
     struct args args;
     if (!parse_args(&args, argc, argv)) {
         return EXIT_FAILURE;
@@ -104,15 +224,43 @@ int main(int argc, char* argv[]) {
     if (args.help || argc == 1) {
         help();
         return EXIT_SUCCESS;
-    } else if (args.compress && args.uncompress) {
-        fputs("Cannot compress and uncompress at the same time !\n", stderr);
+    }
+    const int n_modes = args.compress + args.uncompress + args.index + (args.find_position != NULL) + (args.checkpoints > 0) + (args.transcode != NULL) + args.verify + args.roundtrip;
+    if (n_modes > 1) {
+        fputs("Only one of compress, uncompress, index, find position, checkpoints, transcode, verify and round trip can be done at a time !\n", stderr);
+        return EXIT_FAILURE;
+    } else if (n_modes == 0) {
+        fputs("Must compress, uncompress, index, find a position, add checkpoints, transcode, verify or round trip !\n", stderr);
+        return EXIT_FAILURE;
+    } else if (args.ply >= 0 && !args.uncompress) {
+        fputs("--ply can only be used when uncompressing !\n", stderr);
+        return EXIT_FAILURE;
+    } else if (args.mainline_only && !args.uncompress) {
+        fputs("--mainline-only can only be used when uncompressing !\n", stderr);
         return EXIT_FAILURE;
-    } else if (!args.compress && !args.uncompress) {
-        fputs("Must compress or uncompress !\n", stderr);
+    } else if ((args.huffman || args.opening_trie > 0 || args.dedup || args.block_size > 0 || args.variation_lengths) && args.transcode == NULL) {
+        fputs("--huffman, --opening-trie, --dedup, --block-size and --variation-lengths can only be used when transcoding !\n", stderr);
         return EXIT_FAILURE;
-    } else if (args.uncompress && args.input == NULL) {
-        fputs("Reading from the standard input isn't supported when uncompressing !\n", stderr);
+    } else if (args.dedup_tags != NULL && !args.dedup) {
+        fputs("--dedup-tags can only be used with --dedup !\n", stderr);
         return EXIT_FAILURE;
+    } else if (!args.compress && args.input == NULL) {
+        fputs("Reading from the standard input is only supported when compressing !\n", stderr);
+        return EXIT_FAILURE;
+    }
+
+    if (args.index) {
+        return build_position_index(&args);
+    } else if (args.find_position != NULL) {
+        return find_position(&args);
+    } else if (args.checkpoints > 0) {
+        return add_checkpoints(&args);
+    } else if (args.transcode != NULL) {
+        return transcode(&args);
+    } else if (args.verify) {
+        return verify_container(&args);
+    } else if (args.roundtrip) {
+        return roundtrip(&args);
     }
     return args.compress ? compress(&args) : uncompress(&args);
 }
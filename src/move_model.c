@@ -0,0 +1,221 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/apply_move.h"
+#include "../include/bitboard.h"
+#include "../include/move_model.h"
+
+#define CAPTURE_SCORE 64
+#define PROMOTION_SCORE 64
+#define UNDERPROMOTION_SCORE (-32)
+#define CHECK_SCORE 48
+#define RECAPTURE_SCORE 32
+#define CASTLING_SCORE 24
+#define ESCAPE_SCORE 16
+#define PAWN_ATTACKED_SCORE (-32)
+#define HISTORY_SCORE 4
+#define MAX_HISTORY 15
+
+static const int PIECE_VALUES[N_PIECE_TYPES] = {
+    [KING] = 0,
+    [QUEEN] = 9,
+    [ROOK] = 5,
+    [BISHOP] = 3,
+    [KNIGHT] = 3,
+    [PAWN] = 1
+};
+
+void move_model_init(struct move_model* model) {
+    memset(model->history, 0, sizeof(model->history));
+    model->is_move = BIT_PROBABILITY_INIT;
+    for (size_t i = 0; i < sizeof(model->special) / sizeof(model->special[0]); i++) {
+        model->special[i] = BIT_PROBABILITY_INIT;
+    }
+    for (size_t length = 0; length <= MAX_RANK_BITS; length++) {
+        model->rank_length[length] = BIT_PROBABILITY_INIT;
+        for (size_t bit = 0; bit < MAX_RANK_BITS; bit++) {
+            model->rank_bits[length][bit] = BIT_PROBABILITY_INIT;
+        }
+    }
+}
+
+// 1 for the 4 central squares, up to 7 on the edges
+static int distance_to_center(struct coord coord) {
+    const int file = abs(2 * coord.file - (BOARD_SIZE - 1));
+    const int rank = abs(2 * coord.rank - (BOARD_SIZE - 1));
+    return file > rank ? file : rank;
+}
+
+static bitboard pawn_attacks_of(const struct bitboards* bitboards, enum player player) {
+    bitboard pawns = bitboards->pieces[player][PAWN];
+    bitboard attacks = EMPTY_BITBOARD;
+
+    while (pawns) {
+        attacks |= PAWN_ATTACKS[player][pop_lowest_square(&pawns)];
+    }
+    return attacks;
+}
+
+static bool gives_check(struct board_state* state, const struct legal_move* move) {
+    const enum player opponent = opponent_player(state->current_player);
+    struct move_undo undo;
+
+    make_legal_move(state->board, &state->bitboards, move, &undo);
+    const uint8_t king = state->bitboards.king_square[opponent];
+    const bool check = king != N_SQUARES && attackers_of(&state->bitboards, king, state->current_player, all_occupied(&state->bitboards)) != EMPTY_BITBOARD;
+    unmake_move(state->board, &state->bitboards, &undo);
+    return check;
+}
+
+static int score_move(const struct move_model* model, struct board_state* state, const struct legal_move* move, bitboard opponent_pawn_attacks) {
+    if (move->is_castling) {
+        return CASTLING_SCORE + (gives_check(state, move) ? CHECK_SCORE : 0);
+    }
+
+    const struct piece captured = *board_at_coord(state->board, move->to);
+    const bool is_en_passant = move->piece == PAWN && move->from.file != move->to.file && captured.type == EMPTY_SQUARE;
+    const uint8_t from = coord_to_square(move->from);
+    const uint8_t to = coord_to_square(move->to);
+    int score = 0;
+
+    if (captured.type != EMPTY_SQUARE || is_en_passant) {
+        score += CAPTURE_SCORE + 8 * PIECE_VALUES[is_en_passant ? PAWN : captured.type] - PIECE_VALUES[move->piece];
+        if (state->last_move.from.file != INVALID_COORD && are_coords_equal(&move->to, &state->last_move.to)) {
+            score += RECAPTURE_SCORE;
+        }
+    }
+    if (move->promotion_piece != EMPTY_SQUARE) {
+        score += move->promotion_piece == QUEEN ? PROMOTION_SCORE + 8 * PIECE_VALUES[QUEEN] : UNDERPROMOTION_SCORE;
+    }
+    if (move->piece != KING && move->piece != PAWN) {
+        if (opponent_pawn_attacks & square_bit(to)) {
+            score += PAWN_ATTACKED_SCORE;
+        }
+        if (opponent_pawn_attacks & square_bit(from)) {
+            score += ESCAPE_SCORE;
+        }
+    }
+    if (move->piece != KING) {
+        score += 2 * (distance_to_center(move->from) - distance_to_center(move->to));
+    }
+    score += HISTORY_SCORE * model->history[state->current_player][from][to];
+    if (gives_check(state, move)) {
+        score += CHECK_SCORE;
+    }
+    return score;
+}
+
+struct scored_move {
+    int score;
+    uint8_t index; // generation order, breaks ties so that the order doesn't depend on the sort
+};
+
+static int compare_scored_moves(const void* first, const void* second) {
+    const struct scored_move* const a = first;
+    const struct scored_move* const b = second;
+
+    if (a->score != b->score) {
+        return a->score > b->score ? -1 : 1;
+    }
+    return (int)a->index - (int)b->index;
+}
+
+void rank_legal_moves(const struct move_model* model, struct board_state* state, struct legal_move moves[], uint8_t n_moves) {
+    struct scored_move scored[MAX_LEGAL_MOVES];
+    struct legal_move sorted[MAX_LEGAL_MOVES];
+    const bitboard opponent_pawn_attacks = pawn_attacks_of(&state->bitboards, opponent_player(state->current_player));
+
+    for (uint8_t i = 0; i < n_moves; i++) {
+        scored[i] = (struct scored_move) {
+            .score = score_move(model, state, &moves[i], opponent_pawn_attacks),
+            .index = i
+        };
+    }
+    qsort(scored, n_moves, sizeof(struct scored_move), compare_scored_moves);
+    for (uint8_t i = 0; i < n_moves; i++) {
+        sorted[i] = moves[scored[i].index];
+    }
+    memcpy(moves, sorted, sizeof(struct legal_move) * n_moves);
+}
+
+void move_model_played(struct move_model* model, enum player player, struct coord from, struct coord to) {
+    uint8_t* const count = &model->history[player][coord_to_square(from)][coord_to_square(to)];
+    if (*count < MAX_HISTORY) {
+        (*count)++;
+    }
+}
+
+// rank + 1 is coded as its number of bits in unary, then its bits after the leading 1
+bool encode_rank(struct range_encoder* encoder, struct move_model* model, uint8_t rank) {
+    const unsigned value = rank + 1u;
+    uint8_t length = 0;
+    while ((value >> length) > 1) {
+        length++;
+    }
+
+    for (uint8_t i = 0; i < length; i++) {
+        if (!encode_bit(encoder, &model->rank_length[i], true)) {
+            return false;
+        }
+    }
+    if (length < MAX_RANK_BITS && !encode_bit(encoder, &model->rank_length[length], false)) {
+        return false;
+    }
+    for (uint8_t bit = length; bit-- > 0;) {
+        if (!encode_bit(encoder, &model->rank_bits[length][bit], (value >> bit) & 1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool decode_rank(struct range_decoder* decoder, struct move_model* model, uint8_t* rank) {
+    uint8_t length = 0;
+    bool bit = true;
+    while (length < MAX_RANK_BITS) {
+        if (!decode_bit(decoder, &model->rank_length[length], &bit)) {
+            return false;
+        } else if (!bit) {
+            break;
+        }
+        length++;
+    }
+
+    unsigned value = 1;
+    for (uint8_t i = length; i-- > 0;) {
+        if (!decode_bit(decoder, &model->rank_bits[length][i], &bit)) {
+            return false;
+        }
+        value = (value << 1) | bit;
+    }
+    if (value - 1 > UINT8_MAX) {
+        return false;
+    }
+    *rank = value - 1;
+    return true;
+}
+
+bool encode_special_index(struct range_encoder* encoder, struct move_model* model, enum special_index index) {
+    unsigned node = 1;
+    for (uint8_t bit = SPECIAL_INDEX_BITS; bit-- > 0;) {
+        const bool value = (index >> bit) & 1;
+        if (!encode_bit(encoder, &model->special[node], value)) {
+            return false;
+        }
+        node = (node << 1) | value;
+    }
+    return true;
+}
+
+bool decode_special_index(struct range_decoder* decoder, struct move_model* model, enum special_index* index) {
+    unsigned node = 1;
+    for (uint8_t i = 0; i < SPECIAL_INDEX_BITS; i++) {
+        bool bit;
+        if (!decode_bit(decoder, &model->special[node], &bit)) {
+            return false;
+        }
+        node = (node << 1) | bit;
+    }
+    *index = node - (1 << SPECIAL_INDEX_BITS);
+    return true;
+}
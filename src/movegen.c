@@ -0,0 +1,209 @@
+#include <stdlib.h>
+
+#include "../include/apply_move.h"
+#include "../include/coord_constants.h"
+#include "../include/error.h"
+#include "../include/king.h"
+#include "../include/movegen.h"
+
+#define ALL_SQUARES (~EMPTY_BITBOARD)
+
+struct generation {
+    const struct bitboards* bitboards;
+    enum player player;
+    enum player opponent;
+    uint8_t castling_rights;
+    bitboard occupied;
+    uint8_t king;
+    bitboard evasion_mask; // squares where a non-king piece can go to block or capture the checking piece
+    bitboard pinned;
+    struct legal_move* moves;
+    uint8_t n_moves;
+};
+
+static void add_move(struct generation* generation, uint8_t from, uint8_t to, enum piece_type piece, enum piece_type promotion_piece) {
+    generation->moves[generation->n_moves++] = (struct legal_move) {
+        .from = square_to_coord(from),
+        .to = square_to_coord(to),
+        .piece = piece,
+        .promotion_piece = promotion_piece,
+        .is_castling = false,
+        .castling = KINGSIDE
+    };
+}
+
+static void add_moves(struct generation* generation, uint8_t from, enum piece_type piece, bitboard targets) {
+    const uint8_t promotion_rank = generation->player == WHITE ? RANK_8 : RANK_1;
+
+    while (targets) {
+        const uint8_t to = pop_lowest_square(&targets);
+        if (piece == PAWN && to / BOARD_SIZE == promotion_rank) {
+            for (uint8_t i = 0; i < 4; i++) {
+                add_move(generation, from, to, piece, PROMOTION_PIECE[i]);
+            }
+        } else {
+            add_move(generation, from, to, piece, EMPTY_SQUARE);
+        }
+    }
+}
+
+static bool is_square_safe_for_king(const struct generation* generation, uint8_t square) {
+    // the king is removed, otherwise it would hide the squares behind it from sliding pieces
+    const bitboard occupied = generation->occupied & ~square_bit(generation->king);
+    return attackers_of(generation->bitboards, square, generation->opponent, occupied) == EMPTY_BITBOARD;
+}
+
+static bitboard castling_targets(const struct generation* generation) {
+    const enum player player = generation->player;
+    const bitboard* const pieces = generation->bitboards->pieces[player];
+    bitboard targets = EMPTY_BITBOARD;
+
+    if (generation->king != coord_to_square(king_starting_coords[player])) {
+        return EMPTY_BITBOARD;
+    }
+    for (enum castling castling = KINGSIDE; castling < CASTLING_SIZE; castling++) {
+        const uint8_t rook = coord_to_square(rook_starting_coords[player][castling]);
+        const uint8_t king_end = coord_to_square(king_ending_coords[player][castling]);
+        if (!(generation->castling_rights & CASTLING_RIGHT(player, castling)) || !(pieces[ROOK] & square_bit(rook))) {
+            continue;
+        } else if (squares_between(generation->king, rook) & generation->occupied) {
+            continue;
+        }
+
+        bitboard crossed = squares_between(generation->king, king_end) | square_bit(king_end);
+        bool is_safe = true;
+        while (crossed && is_safe) {
+            is_safe = is_square_safe_for_king(generation, pop_lowest_square(&crossed));
+        }
+        if (is_safe) {
+            targets |= square_bit(king_end);
+        }
+    }
+    return targets;
+}
+
+static void generate_king_moves(struct generation* generation, bool is_checked) {
+    const uint8_t from = generation->king;
+    bitboard targets = KING_ATTACKS[from] & ~generation->bitboards->occupied[generation->player];
+    bitboard castling = is_checked ? EMPTY_BITBOARD : castling_targets(generation);
+
+    targets |= castling;
+    while (targets) {
+        const uint8_t to = pop_lowest_square(&targets);
+        if (castling & square_bit(to)) {
+            add_move(generation, from, to, KING, EMPTY_SQUARE);
+            struct legal_move* const move = &generation->moves[generation->n_moves - 1];
+            move->is_castling = true;
+            move->castling = move->to.file > move->from.file ? KINGSIDE : QUEENSIDE;
+        } else if (is_square_safe_for_king(generation, to)) {
+            add_move(generation, from, to, KING, EMPTY_SQUARE);
+        }
+    }
+}
+
+static bool is_en_passant_legal(const struct generation* generation, uint8_t from, uint8_t to, uint8_t captured) {
+    // both pawns leave their squares at once, which may reveal a sliding piece on the king's rank or diagonal
+    const bitboard occupied = (generation->occupied & ~square_bit(from) & ~square_bit(captured)) | square_bit(to);
+    return (attackers_of(generation->bitboards, generation->king, generation->opponent, occupied) & ~square_bit(captured)) == EMPTY_BITBOARD;
+}
+
+static bitboard pawn_targets(const struct generation* generation, uint8_t from, int en_passant_file) {
+    const enum player player = generation->player;
+    const int direction = player == WHITE ? BOARD_SIZE : -BOARD_SIZE;
+    const uint8_t starting_rank = player == WHITE ? RANK_2 : RANK_7;
+    const uint8_t en_passant_rank = player == WHITE ? RANK_5 : RANK_4;
+    bitboard targets = PAWN_ATTACKS[player][from] & generation->bitboards->occupied[generation->opponent];
+
+    const uint8_t one_step = from + direction;
+    if (!(generation->occupied & square_bit(one_step))) {
+        targets |= square_bit(one_step);
+        const uint8_t two_steps = one_step + direction;
+        if (from / BOARD_SIZE == starting_rank && !(generation->occupied & square_bit(two_steps))) {
+            targets |= square_bit(two_steps);
+        }
+    }
+    targets &= generation->evasion_mask;
+
+    const int file = from % BOARD_SIZE;
+    if (en_passant_file != INVALID_COORD && from / BOARD_SIZE == en_passant_rank && abs(file - en_passant_file) == 1) {
+        const uint8_t captured = en_passant_rank * BOARD_SIZE + en_passant_file;
+        const uint8_t to = captured + direction;
+        if (is_en_passant_legal(generation, from, to, captured)) {
+            targets |= square_bit(to);
+        }
+    }
+    return targets;
+}
+
+uint8_t generate_legal_moves(const struct bitboards* bitboards, enum player player, uint8_t castling_rights, int en_passant_file, struct legal_move moves[MAX_LEGAL_MOVES]) {
+    ASSERT_PRINTF_EXIT_PROGRAM(bitboards->king_square[player] != N_SQUARES, "Couldn't find %s's king !", PLAYER_NAMES[player]);
+
+    struct generation generation = {
+        .bitboards = bitboards,
+        .player = player,
+        .opponent = opponent_player(player),
+        .castling_rights = castling_rights,
+        .occupied = all_occupied(bitboards),
+        .king = bitboards->king_square[player],
+        .evasion_mask = ALL_SQUARES,
+        .pinned = EMPTY_BITBOARD,
+        .moves = moves,
+        .n_moves = 0
+    };
+    const bitboard* const opponent_pieces = bitboards->pieces[generation.opponent];
+    const bitboard checkers = attackers_of(bitboards, generation.king, generation.opponent, generation.occupied);
+
+    if (count_squares(checkers) >= 2) { // double check, only the king can move
+        generate_king_moves(&generation, true);
+        return generation.n_moves;
+    } else if (checkers) {
+        const uint8_t checker = __builtin_ctzll(checkers);
+        generation.evasion_mask = checkers | squares_between(generation.king, checker);
+    }
+
+    // own pieces are transparent, so that sliding pieces see through them to find pins
+    bitboard snipers =
+        (rook_attacks(generation.king, bitboards->occupied[generation.opponent]) & (opponent_pieces[ROOK] | opponent_pieces[QUEEN])) |
+        (bishop_attacks(generation.king, bitboards->occupied[generation.opponent]) & (opponent_pieces[BISHOP] | opponent_pieces[QUEEN]));
+    while (snipers) {
+        const bitboard blockers = squares_between(generation.king, pop_lowest_square(&snipers)) & generation.occupied;
+        if (count_squares(blockers) == 1 && (blockers & bitboards->occupied[player])) {
+            generation.pinned |= blockers;
+        }
+    }
+
+    bitboard own_pieces = bitboards->occupied[player];
+    while (own_pieces) {
+        const uint8_t from = pop_lowest_square(&own_pieces);
+        enum piece_type piece = KING;
+        while (!(bitboards->pieces[player][piece] & square_bit(from))) {
+            piece++;
+        }
+
+        if (piece == KING) {
+            generate_king_moves(&generation, checkers != EMPTY_BITBOARD);
+            continue;
+        }
+        bitboard targets = piece == PAWN ?
+            pawn_targets(&generation, from, en_passant_file) :
+            piece_attacks(piece, player, from, generation.occupied) & ~bitboards->occupied[player] & generation.evasion_mask;
+        if (generation.pinned & square_bit(from)) { // a pinned piece can only move along the pin
+            targets &= line_through(generation.king, from);
+        }
+        add_moves(&generation, from, piece, targets);
+    }
+    return generation.n_moves;
+}
+
+bool has_legal_move(const struct bitboards* bitboards, enum player player, int en_passant_file) {
+    struct legal_move moves[MAX_LEGAL_MOVES];
+    return generate_legal_moves(bitboards, player, 0, en_passant_file, moves) > 0;
+}
+
+void make_legal_move(board board, struct bitboards* bitboards, const struct legal_move* move, struct move_undo* undo) {
+    if (move->is_castling) {
+        make_castling(board, bitboards, board_at_coord(board, move->from)->player, move->castling, undo);
+    } else {
+        make_move(board, bitboards, &move->from, &move->to, move->promotion_piece, undo);
+    }
+}
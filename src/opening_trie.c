@@ -0,0 +1,203 @@
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../include/apply_move.h"
+#include "../include/array.h"
+#include "../include/error.h"
+#include "../include/legal_index.h"
+#include "../include/movegen.h"
+#include "../include/opening_trie.h"
+
+#define OPENING_TRIE_INITIAL_SIZE 256
+
+bool opening_trie_init(struct opening_trie* trie) {
+    *trie = (struct opening_trie) {
+        .max_nodes = OPENING_TRIE_INITIAL_SIZE
+    };
+    trie->nodes = malloc(sizeof(struct opening_node) * trie->max_nodes);
+    if (trie->nodes == NULL) {
+        errprintf("Cannot allocate the opening trie !\n");
+        return false;
+    }
+
+    struct board_state state = empty_board_state();
+    trie->nodes[0] = (struct opening_node) { .parent = 0 };
+    make_checkpoint(&state, 0, 0, &trie->nodes[0].state);
+    free_board_state(&state);
+    trie->n_nodes = 1;
+    return true;
+}
+
+void opening_trie_free(struct opening_trie* trie) {
+    free(trie->nodes);
+    *trie = (struct opening_trie) { 0 };
+}
+
+static uint8_t legal_moves_of(const struct opening_node* node, struct legal_move moves[MAX_LEGAL_MOVES]) {
+    struct board_state state;
+    restore_checkpoint(&node->state, &state);
+    const uint8_t n_moves = generate_legal_moves(&state.bitboards, state.current_player, state.castling_rights, state.en_passant_file, moves);
+    free_board_state(&state);
+    return n_moves;
+}
+
+static size_t find_child(const struct opening_trie* trie, size_t parent, uint8_t move_index) {
+    for (size_t child = trie->nodes[parent].first_child; child != 0; child = trie->nodes[child].next_sibling) {
+        if (trie->nodes[child].move_index == move_index) {
+            return child;
+        }
+    }
+    return 0;
+}
+
+static bool add_child(struct opening_trie* trie, size_t parent, uint8_t move_index, size_t* child) {
+    ASSERT_PRINTF(trie->nodes[parent].state.ply < MAX_OPENING_PLIES, "Opening trie nodes cannot be deeper than %d plies !", MAX_OPENING_PLIES);
+    struct opening_node* const expanded = expand_array_if_needed(trie->nodes, trie->n_nodes + 1, sizeof(struct opening_node), &trie->max_nodes, 2);
+    if (expanded == NULL) {
+        errprintf("Cannot allocate space for %zu opening trie nodes !\n", trie->n_nodes + 1);
+        return false;
+    }
+    trie->nodes = expanded;
+
+    struct legal_move moves[MAX_LEGAL_MOVES];
+    const uint8_t n_moves = legal_moves_of(&trie->nodes[parent], moves);
+    ASSERT_PRINTF(move_index < n_moves, "Invalid opening move index %" PRIu8 " among %" PRIu8 " legal moves !", move_index, n_moves);
+
+    struct opening_node* const node = &trie->nodes[trie->n_nodes];
+    struct board_state state;
+    restore_checkpoint(&trie->nodes[parent].state, &state);
+    *node = (struct opening_node) {
+        .parent = parent,
+        .move_index = move_index,
+        .next_sibling = trie->nodes[parent].first_child
+    };
+    legal_move_to_token(state.board, state.current_player, &moves[move_index], &node->token);
+    apply_move(&node->token, &state);
+    next_turn(&state);
+    if (node->token.type != CASTLING && node->token.type != PROMOTION) { // same as the prefix coding
+        node->token.move.move.check = is_player_checked(&state.bitboards, state.current_player, true, state.en_passant_file);
+    }
+    make_checkpoint(&state, trie->nodes[parent].state.ply + 1, 0, &node->state);
+    free_board_state(&state);
+
+    *child = trie->n_nodes++;
+    trie->nodes[parent].first_child = *child;
+    return true;
+}
+
+// index of the move token among the legal moves of the node, false if it isn't legal there
+static bool move_index_at(const struct opening_node* node, const struct pgn_token* token, uint8_t* index) {
+    struct legal_move moves[MAX_LEGAL_MOVES];
+    const uint8_t n_moves = legal_moves_of(node, moves);
+    return find_legal_move_index(moves, n_moves, token, index);
+}
+
+bool opening_trie_add_game(struct opening_trie* trie, const struct pgn_token* tokens, size_t n_tokens, unsigned max_plies) {
+    size_t node = 0;
+
+    trie->nodes[0].n_games++;
+    for (size_t i = 0; i < n_tokens && i < max_plies && is_token_a_move(tokens[i].type); i++) {
+        uint8_t index;
+        ASSERT_PRINTF(move_index_at(&trie->nodes[node], &tokens[i], &index), "Opening move %zu isn't legal !", i + 1);
+        size_t child = find_child(trie, node, index);
+        if (child == 0 && !add_child(trie, node, index, &child)) {
+            return false;
+        }
+        node = child;
+        trie->nodes[node].n_games++;
+    }
+    return true;
+}
+
+size_t opening_trie_find(const struct opening_trie* trie, const struct pgn_token* tokens, size_t n_tokens) {
+    size_t node = 0;
+
+    for (size_t i = 0; i < n_tokens && is_token_a_move(tokens[i].type); i++) {
+        uint8_t index;
+        if (!move_index_at(&trie->nodes[node], &tokens[i], &index)) {
+            break;
+        }
+        const size_t child = find_child(trie, node, index);
+        if (child == 0) {
+            break;
+        }
+        node = child;
+    }
+    return node;
+}
+
+bool opening_trie_prune(struct opening_trie* trie, size_t min_games) {
+    size_t* const new_ids = malloc(sizeof(size_t) * trie->n_nodes);
+    if (new_ids == NULL) {
+        errprintf("Cannot allocate space to prune %zu opening trie nodes !\n", trie->n_nodes);
+        return false;
+    }
+
+    // a child never has more games than its parent, so the kept nodes still have their parent
+    size_t n_kept = 1;
+    new_ids[0] = 0;
+    trie->nodes[0].first_child = 0;
+    for (size_t id = 1; id < trie->n_nodes; id++) {
+        struct opening_node node = trie->nodes[id];
+        if (node.n_games < min_games) {
+            continue;
+        }
+        node.parent = new_ids[node.parent];
+        node.first_child = 0;
+        node.next_sibling = trie->nodes[node.parent].first_child;
+        trie->nodes[node.parent].first_child = n_kept;
+        new_ids[id] = n_kept;
+        trie->nodes[n_kept++] = node;
+    }
+    trie->n_nodes = n_kept;
+    free(new_ids);
+    return true;
+}
+
+uint8_t opening_node_id_bits(const struct opening_trie* trie) {
+    return how_many_bits_to_hold_number(trie->n_nodes - 1);
+}
+
+bool write_opening_trie(struct bit_writer* writer, const struct opening_trie* trie) {
+    if (!write_bits(writer, N_OPENING_NODES_BITS, trie->n_nodes - 1)) {
+        return false;
+    }
+    for (size_t id = 1; id < trie->n_nodes; id++) {
+        const struct opening_node* const node = &trie->nodes[id];
+        struct legal_move moves[MAX_LEGAL_MOVES];
+        const uint8_t n_moves = legal_moves_of(&trie->nodes[node->parent], moves);
+        if (!write_bits(writer, how_many_bits_to_hold_number(id - 1), node->parent) || !write_bits(writer, how_many_bits_to_hold_number(n_moves - 1), node->move_index)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool read_opening_trie(struct compressed_buf* buf, struct opening_trie* trie) {
+    uint64_t n_nodes;
+    ASSERT_PRINTF(read_bits(buf, N_OPENING_NODES_BITS, &n_nodes), "Cannot read the number of opening trie nodes !");
+    if (!opening_trie_init(trie)) {
+        return false;
+    }
+
+    bool status = true;
+    for (size_t id = 1; status && id <= n_nodes; id++) {
+        uint64_t parent;
+        uint64_t move_index = 0;
+        struct legal_move moves[MAX_LEGAL_MOVES];
+        size_t child;
+        status = read_bits(buf, how_many_bits_to_hold_number(id - 1), &parent) && parent < id;
+        const uint8_t n_moves = status ? legal_moves_of(&trie->nodes[parent], moves) : 0;
+        status = status && n_moves > 0 && read_bits(buf, how_many_bits_to_hold_number(n_moves - 1), &move_index);
+        status = status && add_child(trie, parent, move_index, &child);
+        if (!status) {
+            fprintf(stderr, "Invalid opening trie node %zu !\n", id);
+        }
+    }
+    if (!status) {
+        opening_trie_free(trie);
+    }
+    return status;
+}
@@ -2,6 +2,7 @@
 #include <string.h>
 
 #include "../include/common.h"
+#include "../include/coord_constants.h"
 #include "../include/error.h"
 #include "../include/parse.h"
 #include "../include/piece.h"
@@ -60,8 +61,10 @@ bool can_pawn_move_to(struct coord from, struct coord to, enum player moving_pla
     const int increment = to.rank > from.rank ? 1 : -1;
     if (from.file == to.file) {
 
-        if (rank_diff > 2) {
+        if (rank_diff == 0 || rank_diff > 2) {
             return false;
+        } else if (rank_diff == 2 && from.rank != (moving_player == WHITE ? RANK_2 : RANK_7)) {
+            return false; // only the first move can go 2 squares forward
         }
         for (int i = 1; i <= rank_diff; i++) {
             if (board_at(board, from.file, from.rank + i * increment)->type != EMPTY_SQUARE) {
@@ -74,13 +77,14 @@ bool can_pawn_move_to(struct coord from, struct coord to, enum player moving_pla
             return false;
         } else if (abs(from.file - to.file) != 1) {
             return false; // when capturing, moves 1 file
-        } else if (rank_diff != increment) {
-            return false; // when capturing, moves 1 rank forward
         }
         if (board_at_coord(board, to)->type != EMPTY_SQUARE) {
             return board_at_coord(board, to)->player != moving_player;
         }
-        return false;
+
+        // en passant, the captured pawn stands next to the starting square
+        const struct piece* const en_passant_pawn = board_at(board, to.file, from.rank);
+        return from.rank == (moving_player == WHITE ? RANK_5 : RANK_4) && en_passant_pawn->type == PAWN && en_passant_pawn->player != moving_player;
     }
 }
 
@@ -92,3 +96,19 @@ bool parse_pawn_move(struct move* move, const char* str, enum player moving_play
     ASSERT_PRINTF(find_starting_square(board, move, can_pawn_move_to), "Cannot find a starting square !\nMove: %s", move->algebraic_move);
     return true;
 }
+
+uint8_t list_promotion_squares(board board, struct coord pawn, enum player player, struct coord squares[3]) {
+    const int rank = pawn.rank + (player == WHITE ? 1 : -1);
+    uint8_t count = 0;
+
+    for (int file = pawn.file - 1; file <= pawn.file + 1; file++) {
+        if (file < 0 || file >= BOARD_SIZE) {
+            continue;
+        }
+        const struct coord square = { .file = file, .rank = rank };
+        if (can_pawn_move_to(pawn, square, player, board)) {
+            squares[count++] = square;
+        }
+    }
+    return count;
+}
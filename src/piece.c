@@ -17,6 +17,23 @@ const struct coord INVALID_COORD_STRUCT = {
     .rank = INVALID_COORD,
 };
 
+const struct piece EMPTY_PIECE = {
+    .type = EMPTY_SQUARE,
+    .player = INVALID_PLAYER
+};
+
+const struct move_undo EMPTY_MOVE_UNDO = {
+    .from = INVALID_COORD_STRUCT,
+    .to = INVALID_COORD_STRUCT,
+    .captured = {
+        .type = EMPTY_SQUARE,
+        .player = INVALID_PLAYER
+    },
+    .flags = MOVE_UNDO_NONE,
+    .castling_rights = ALL_CASTLING_RIGHTS,
+    .en_passant_file = INVALID_COORD
+};
+
 const struct pawn_move_infos EMPTY_PAWN_MOVE_INFOS = {
     .en_passant = false,
     .promoted = false,
@@ -0,0 +1,47 @@
+#include <stdlib.h>
+
+#include "../include/error.h"
+#include "../include/position_cache.h"
+
+bool position_cache_init(struct position_cache* cache, size_t n_entries) {
+    ASSERT_PRINTF(cache != NULL, "Position cache is NULL !");
+    ASSERT_PRINTF(n_entries > 0 && (n_entries & (n_entries - 1)) == 0, "Position cache size must be a power of 2, got %zu !", n_entries);
+
+    *cache = (struct position_cache) {
+        .entries = calloc(n_entries, sizeof(struct position_cache_entry)),
+        .mask = n_entries - 1,
+        .hits = 0,
+        .misses = 0
+    };
+    if (cache->entries == NULL) {
+        errprintf("Cannot allocate %zu cache entries !\n", n_entries);
+        return false;
+    }
+    return true;
+}
+
+void position_cache_free(struct position_cache* cache) {
+    if (cache != NULL) {
+        free(cache->entries);
+        cache->entries = NULL;
+    }
+}
+
+enum check_type cached_is_player_checked(struct position_cache* cache, zobrist_key key, const struct bitboards* bitboards, enum player player, int en_passant_file) {
+    if (cache == NULL) {
+        return is_player_checked(bitboards, player, true, en_passant_file);
+    }
+
+    struct position_cache_entry* const entry = &cache->entries[key & cache->mask];
+    if (entry->is_used && entry->key == key) {
+        cache->hits++;
+        return entry->check;
+    }
+    cache->misses++;
+    *entry = (struct position_cache_entry) {
+        .key = key,
+        .is_used = true,
+        .check = is_player_checked(bitboards, player, true, en_passant_file)
+    };
+    return entry->check;
+}
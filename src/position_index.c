@@ -0,0 +1,232 @@
+#define _POSIX_C_SOURCE 200809L // mmap
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../include/array.h"
+#include "../include/container.h"
+#include "../include/error.h"
+#include "../include/fen.h"
+#include "../include/position_index.h"
+#include "../include/read.h"
+#include "../include/uncompress.h"
+#include "../include/zobrist.h"
+
+struct index_builder {
+    struct position_index_entry* entries;
+    size_t n_entries;
+    size_t max_entries;
+    uint32_t game;
+    bool failed;
+};
+
+static void add_position(const struct board_state* state, unsigned ply, size_t bit_offset, void* data) {
+    (void)bit_offset;
+    struct index_builder* const builder = data;
+
+    if (builder->failed) {
+        return;
+    }
+    struct position_index_entry* const expanded = expand_array_if_needed(builder->entries, builder->n_entries + 1, sizeof(struct position_index_entry), &builder->max_entries, 2);
+    if (expanded == NULL) {
+        builder->failed = true;
+        return;
+    }
+    builder->entries = expanded;
+    builder->entries[builder->n_entries++] = (struct position_index_entry) {
+        .key = position_key(state),
+        .game = builder->game,
+        .ply = ply
+    };
+}
+
+static int compare_entries(const void* first, const void* second) {
+    const struct position_index_entry* const a = first;
+    const struct position_index_entry* const b = second;
+
+    if (a->key != b->key) {
+        return a->key < b->key ? -1 : 1;
+    } else if (a->game != b->game) {
+        return a->game < b->game ? -1 : 1;
+    }
+    return (a->ply > b->ply) - (a->ply < b->ply);
+}
+
+static void write_le(uint8_t* dest, uint64_t value, uint8_t n_bytes) {
+    for (uint8_t i = 0; i < n_bytes; i++) {
+        dest[i] = (value >> (8 * i)) & 0xFF;
+    }
+}
+
+static uint64_t read_le(const uint8_t* src, uint8_t n_bytes) {
+    uint64_t value = 0;
+    for (uint8_t i = 0; i < n_bytes; i++) {
+        value |= (uint64_t)src[i] << (8 * i);
+    }
+    return value;
+}
+
+static bool write_index(const char* name, const struct position_index_entry* entries, size_t n_entries) {
+    FILE* const file = fopen(name, "wb");
+    if (file == NULL) {
+        errprintf("Cannot open file %s", name);
+        return false;
+    }
+
+    bool status = fwrite(POSITION_INDEX_MAGIC, 1, POSITION_INDEX_MAGIC_SIZE, file) == POSITION_INDEX_MAGIC_SIZE;
+    for (size_t i = 0; status && i < n_entries; i++) {
+        uint8_t raw_entry[POSITION_INDEX_ENTRY_SIZE];
+        write_le(raw_entry, entries[i].key, 8);
+        write_le(raw_entry + 8, entries[i].game, 4);
+        write_le(raw_entry + 12, entries[i].ply, 4);
+        status = fwrite(raw_entry, 1, POSITION_INDEX_ENTRY_SIZE, file) == POSITION_INDEX_ENTRY_SIZE;
+    }
+    if (fclose(file) != 0 || !status) {
+        errprintf("Error while writing %s", name);
+        return false;
+    }
+    return true;
+}
+
+int build_position_index(const struct args* args) {
+    ASSERT_PRINTF_EXIT_FAILURE(args != NULL, "args is NULL !");
+    ASSERT_PRINTF_EXIT_FAILURE(args->input != NULL, "An input container is required to build an index !");
+
+    size_t size;
+    unsigned char* const raw_buf = read_compressed_file(args->input, &size);
+    if (raw_buf == NULL) {
+        fprintf(stderr, "Error while reading %s\n", args->input);
+        return EXIT_FAILURE;
+    }
+    struct compressed_buf buf;
+    make_compressed_buf(&buf, raw_buf, size);
+
+    struct index_builder builder = {
+        .max_entries = 256,
+        .game = 0,
+        .failed = false
+    };
+    builder.entries = malloc(sizeof(struct position_index_entry) * builder.max_entries);
+    struct position_cache cache = { 0 };
+    struct container_header header = { 0 };
+    struct uncompress_options options = {
+        .print = false,
+        .cache = &cache,
+        .mainline_only = true, // only the positions of the main line are indexed
+        .log = args->log
+    };
+    bool status = builder.entries != NULL && read_container_header(&buf, &header) && position_cache_init(&cache, POSITION_CACHE_DEFAULT_SIZE);
+    options.huffman = container_huffman(&header);
+    options.trie = container_trie(&header);
+    options.variation_lengths = container_has_variation_lengths(&header);
+    enum safe_bool has_game = FALSE;
+    for (; status && (has_game = next_game(&buf, &header)) == TRUE; builder.game++) {
+        status = uncompress_game(&buf, &options, NULL, add_position, &builder) == TRUE && !builder.failed;
+    }
+    status = status && has_game != ERROR;
+    position_cache_free(&cache);
+    free_container_header(&header);
+    free(raw_buf);
+
+    char* output = (char*)args->output;
+    if (status && args->output == NULL) {
+        output = malloc(strlen(args->input) + sizeof(".idx"));
+        status = output != NULL;
+        if (status) {
+            strcpy(output, args->input);
+            strcat(output, ".idx");
+        }
+    }
+    if (status) {
+        qsort(builder.entries, builder.n_entries, sizeof(struct position_index_entry), compare_entries);
+        status = write_index(output, builder.entries, builder.n_entries);
+    }
+    if (status) {
+        printf("Indexed %zu position%s of %u game%s into %s\n", builder.n_entries, builder.n_entries >= 2 ? "s" : "", (unsigned)builder.game, builder.game >= 2 ? "s" : "", output);
+    }
+
+    if (output != args->output) {
+        free(output);
+    }
+    free(builder.entries);
+    return status ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+void position_index_read_entry(const uint8_t* entries, size_t nth, struct position_index_entry* entry) {
+    const uint8_t* const raw_entry = entries + nth * POSITION_INDEX_ENTRY_SIZE;
+
+    entry->key = read_le(raw_entry, 8);
+    entry->game = read_le(raw_entry + 8, 4);
+    entry->ply = read_le(raw_entry + 12, 4);
+}
+
+size_t position_index_lower_bound(const uint8_t* entries, size_t n_entries, zobrist_key key) {
+    size_t low = 0;
+    size_t high = n_entries;
+
+    while (low < high) {
+        const size_t middle = low + (high - low) / 2;
+        if (read_le(entries + middle * POSITION_INDEX_ENTRY_SIZE, 8) < key) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+int find_position(const struct args* args) {
+    ASSERT_PRINTF_EXIT_FAILURE(args != NULL, "args is NULL !");
+    ASSERT_PRINTF_EXIT_FAILURE(args->input != NULL, "An index file is required to find a position !");
+
+    struct board_state state;
+    if (!board_state_from_fen(args->find_position, &state)) {
+        fprintf(stderr, "Invalid FEN '%s'\n", args->find_position);
+        return EXIT_FAILURE;
+    }
+    const zobrist_key key = position_key(&state);
+    free_board_state(&state);
+
+    const int fd = open(args->input, O_RDONLY);
+    if (fd == -1) {
+        errprintf("Cannot open file %s", args->input);
+        return EXIT_FAILURE;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size < POSITION_INDEX_MAGIC_SIZE || (file_stat.st_size - POSITION_INDEX_MAGIC_SIZE) % POSITION_INDEX_ENTRY_SIZE != 0) {
+        fprintf(stderr, "%s isn't a position index !\n", args->input);
+        close(fd);
+        return EXIT_FAILURE;
+    }
+    const size_t size = file_stat.st_size;
+    const uint8_t* const file = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (file == MAP_FAILED) {
+        errprintf("Cannot map file %s", args->input);
+        return EXIT_FAILURE;
+    } else if (memcmp(file, POSITION_INDEX_MAGIC, POSITION_INDEX_MAGIC_SIZE) != 0) {
+        fprintf(stderr, "%s isn't a position index !\n", args->input);
+        munmap((void*)file, size);
+        return EXIT_FAILURE;
+    }
+
+    const uint8_t* const entries = file + POSITION_INDEX_MAGIC_SIZE;
+    const size_t n_entries = (size - POSITION_INDEX_MAGIC_SIZE) / POSITION_INDEX_ENTRY_SIZE;
+    size_t n_found = 0;
+    for (size_t i = position_index_lower_bound(entries, n_entries, key); i < n_entries; i++, n_found++) {
+        struct position_index_entry entry;
+        position_index_read_entry(entries, i, &entry);
+        if (entry.key != key) {
+            break;
+        }
+        printf("Game %u, ply %u\n", (unsigned)entry.game + 1, (unsigned)entry.ply);
+    }
+    printf("%zu occurrence%s found\n", n_found, n_found >= 2 ? "s" : "");
+
+    munmap((void*)file, size);
+    return EXIT_SUCCESS;
+}
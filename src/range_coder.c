@@ -0,0 +1,143 @@
+#include "../include/range_coder.h"
+
+#define TOP_VALUE (1u << 24)
+#define N_FLUSH_BYTES 5
+
+void range_encoder_init(struct range_encoder* encoder, struct bit_writer* writer) {
+    *encoder = (struct range_encoder) {
+        .writer = writer,
+        .low = 0,
+        .range = UINT32_MAX,
+        .cache = 0,
+        .cache_size = 1
+    };
+}
+
+// a byte is only written once it's known that no carry can change it, 0xFF bytes are kept pending until then
+static bool shift_low(struct range_encoder* encoder) {
+    if ((uint32_t)encoder->low < 0xFF000000 || (encoder->low >> 32) != 0) {
+        const uint8_t carry = encoder->low >> 32;
+        uint8_t byte = encoder->cache;
+        do {
+            if (!write_bits(encoder->writer, 8, (uint8_t)(byte + carry))) {
+                return false;
+            }
+            byte = 0xFF;
+        } while (--encoder->cache_size != 0);
+        encoder->cache = (uint8_t)(encoder->low >> 24);
+    }
+    encoder->cache_size++;
+    encoder->low = (encoder->low & 0x00FFFFFF) << 8;
+    return true;
+}
+
+static bool normalize_encoder(struct range_encoder* encoder) {
+    while (encoder->range < TOP_VALUE) {
+        encoder->range <<= 8;
+        if (!shift_low(encoder)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool encode_bit(struct range_encoder* encoder, bit_probability* probability, bool bit) {
+    const uint32_t bound = (encoder->range >> BIT_PROBABILITY_BITS) * *probability;
+
+    if (!bit) {
+        encoder->range = bound;
+        *probability += ((1 << BIT_PROBABILITY_BITS) - *probability) >> BIT_PROBABILITY_MOVE_BITS;
+    } else {
+        encoder->low += bound;
+        encoder->range -= bound;
+        *probability -= *probability >> BIT_PROBABILITY_MOVE_BITS;
+    }
+    return normalize_encoder(encoder);
+}
+
+bool encode_direct_bits(struct range_encoder* encoder, uint8_t n_bits, uint32_t value) {
+    while (n_bits-- > 0) {
+        encoder->range >>= 1;
+        if ((value >> n_bits) & 1) {
+            encoder->low += encoder->range;
+        }
+        if (!normalize_encoder(encoder)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool range_encoder_flush(struct range_encoder* encoder) {
+    for (uint8_t i = 0; i < N_FLUSH_BYTES; i++) {
+        if (!shift_low(encoder)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool read_byte(struct range_decoder* decoder) {
+    uint8_t byte;
+    if (!read_n_bits(decoder->buf, 8, &byte)) {
+        return false;
+    }
+    decoder->code = (decoder->code << 8) | byte;
+    return true;
+}
+
+bool range_decoder_init(struct range_decoder* decoder, struct compressed_buf* buf) {
+    *decoder = (struct range_decoder) {
+        .buf = buf,
+        .range = UINT32_MAX,
+        .code = 0
+    };
+    for (uint8_t i = 0; i < N_FLUSH_BYTES; i++) {
+        if (!read_byte(decoder)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool normalize_decoder(struct range_decoder* decoder) {
+    while (decoder->range < TOP_VALUE) {
+        decoder->range <<= 8;
+        if (!read_byte(decoder)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool decode_bit(struct range_decoder* decoder, bit_probability* probability, bool* bit) {
+    const uint32_t bound = (decoder->range >> BIT_PROBABILITY_BITS) * *probability;
+
+    if (decoder->code < bound) {
+        decoder->range = bound;
+        *probability += ((1 << BIT_PROBABILITY_BITS) - *probability) >> BIT_PROBABILITY_MOVE_BITS;
+        *bit = false;
+    } else {
+        decoder->code -= bound;
+        decoder->range -= bound;
+        *probability -= *probability >> BIT_PROBABILITY_MOVE_BITS;
+        *bit = true;
+    }
+    return normalize_decoder(decoder);
+}
+
+bool decode_direct_bits(struct range_decoder* decoder, uint8_t n_bits, uint32_t* value) {
+    *value = 0;
+    while (n_bits-- > 0) {
+        decoder->range >>= 1;
+        const bool bit = decoder->code >= decoder->range;
+        if (bit) {
+            decoder->code -= decoder->range;
+        }
+        *value = (*value << 1) | bit;
+        if (!normalize_decoder(decoder)) {
+            return false;
+        }
+    }
+    return true;
+}
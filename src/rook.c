@@ -9,6 +9,8 @@ bool can_rook_move_to(struct coord from, struct coord to, enum player moving_pla
 
     if (!same_rank && !same_file) {
         return false; // rooks move in straight lines
+    } else if (same_rank && same_file) {
+        return false;
     }
     const int increment = same_file     ?
         (from.rank < to.rank ? 1 : -1)  :
@@ -16,11 +18,10 @@ bool can_rook_move_to(struct coord from, struct coord to, enum player moving_pla
     int* start = same_rank ? &from.file : &from.rank;
     const int end = same_rank ? to.file : to.rank;
 
-    while (*start != end) {
+    for (*start += increment; *start != end; *start += increment) {
         if (board_at_coord(board, from)->type != EMPTY_SQUARE) {
             return false; // rooks cannot jump over pieces
         }
-        start += increment;
     }
     if (board_at_coord(board, to)->type != EMPTY_SQUARE) {
         return board_at_coord(board, to)->player != moving_player;
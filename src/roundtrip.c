@@ -0,0 +1,268 @@
+#define _POSIX_C_SOURCE 200809L // sysconf
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../include/array.h"
+#include "../include/container.h"
+#include "../include/encode.h"
+#include "../include/error.h"
+#include "../include/read.h"
+#include "../include/roundtrip.h"
+#include "../include/uncompress.h"
+
+#define ROUNDTRIP_FAILED_DECODING (1 << N_MOVE_CODINGS) // the original game itself cannot be decoded
+
+/**
+ * Games checked by a thread, the container and its options being shared read only.
+ */
+struct roundtrip_job {
+    const struct compressed_buf* container;
+    const struct uncompress_options* options;
+    const size_t* game_starts; // bit offsets
+    size_t n_games;
+    size_t first_game;
+    size_t step;
+    uint8_t* mismatches; // for each game, a bit for each coding it doesn't survive, written by the thread of the game only
+    bool failed;
+};
+
+// what the SAN of the tokens shows, and the squares of the moves, the player being implied by the order of the moves
+static bool are_moves_equal(const struct move* first, const struct move* second) {
+    const struct pawn_move_infos* const first_pawn = &first->extra_infos.infos.pawn_infos;
+    const struct pawn_move_infos* const second_pawn = &second->extra_infos.infos.pawn_infos;
+    const struct king_move_infos* const first_king = &first->extra_infos.infos.king_infos;
+    const struct king_move_infos* const second_king = &second->extra_infos.infos.king_infos;
+
+    if (first->piece != second->piece || first->capture != second->capture || first->check != second->check) {
+        return false;
+    } else if (!are_coords_equal(&first->from, &second->from) || !are_coords_equal(&first->to, &second->to)) {
+        return false;
+    } else if (first->piece == PAWN) {
+        return
+            first_pawn->promoted == second_pawn->promoted && (!first_pawn->promoted || first_pawn->promotion_piece == second_pawn->promotion_piece) &&
+            first_pawn->en_passant == second_pawn->en_passant && (!first_pawn->en_passant || first_pawn->has_en_passant_extra_ep_notation == second_pawn->has_en_passant_extra_ep_notation);
+    } else if (first->piece == KING) {
+        return first_king->is_castling == second_king->is_castling && (!first_king->is_castling || first_king->castling == second_king->castling);
+    }
+    return true;
+}
+
+bool are_tokens_equal(const struct pgn_token* first, const struct pgn_token* second) {
+    if (first->type != second->type) {
+        return false;
+    }
+    switch (first->type) {
+        case COMMENT:
+            return strcmp(first->move.comment, second->move.comment) == 0;
+
+        case NAG:
+            return first->move.nag == second->move.nag;
+
+        case ALTERNATIVE_MOVE:
+            return first->move.alternative_moves_is_end == second->move.alternative_moves_is_end;
+
+        case END_OF_THE_GAME:
+            return first->move.winner.is_draw == second->move.winner.is_draw && (first->move.winner.is_draw || first->move.winner.winner == second->move.winner.winner);
+
+        default:
+            return are_moves_equal(&first->move.move, &second->move.move);
+    }
+}
+
+static bool are_token_lists_equal(const struct token_list* first, const struct token_list* second) {
+    if (first->n_tokens != second->n_tokens) {
+        return false;
+    }
+    for (size_t i = 0; i < first->n_tokens; i++) {
+        if (!are_tokens_equal(&first->tokens[i], &second->tokens[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool survives_coding(const struct compressed_buf* container, const struct game_layout* layout, const struct token_list* original, enum move_coding coding, struct bit_writer* writer, struct token_list* decoded) {
+    bit_writer_clear(writer);
+    token_list_clear(decoded);
+    if (!write_bits(writer, 8, make_version(coding, false)) ||
+        !copy_game_header(writer, container, layout) ||
+        !encode_moves(writer, original, 0, coding, NULL, false) ||
+        !bit_writer_align(writer)) {
+        return false;
+    }
+
+    const struct uncompress_options options = {
+        .print = false,
+        .cache = NULL,
+        .on_token = record_token,
+        .token_data = decoded
+    };
+    struct compressed_buf buf;
+    return
+        make_compressed_buf(&buf, writer->buf, writer->n_bits / 8) &&
+        uncompress_game(&buf, &options, NULL, NULL, NULL) == TRUE && !decoded->failed &&
+        are_token_lists_equal(original, decoded);
+}
+
+static uint8_t check_game(struct roundtrip_job* job, size_t game, struct bit_writer* writer, struct token_list* original, struct token_list* decoded) {
+    struct compressed_buf buf = *job->container;
+    struct uncompress_options options = *job->options;
+    struct game_layout layout;
+    options.on_token = record_token;
+    options.token_data = original;
+
+    token_list_clear(original);
+    if (!seek_bit_offset(&buf, job->game_starts[game]) || uncompress_game(&buf, &options, &layout, NULL, NULL) != TRUE || original->failed) {
+        return ROUNDTRIP_FAILED_DECODING;
+    }
+    uint8_t mismatches = 0;
+    for (enum move_coding coding = 0; coding < N_MOVE_CODINGS; coding++) {
+        if (!survives_coding(job->container, &layout, original, coding, writer, decoded)) {
+            mismatches |= 1 << coding;
+        }
+    }
+    return mismatches;
+}
+
+static void* run_job(void* data) {
+    struct roundtrip_job* const job = data;
+    struct bit_writer writer;
+    struct token_list original = { 0 };
+    struct token_list decoded = { 0 };
+
+    job->failed = !bit_writer_init(&writer);
+    for (size_t game = job->first_game; !job->failed && game < job->n_games; game += job->step) {
+        job->mismatches[game] = check_game(job, game, &writer, &original, &decoded);
+    }
+    token_list_free(&original);
+    token_list_free(&decoded);
+    bit_writer_free(&writer);
+    return NULL;
+}
+
+/**
+ * Decodes the whole container once, only to find where its games start.
+ * Returns FALSE if the games of damaged blocks had to be left out, ERROR if the games cannot be found.
+ */
+static enum safe_bool find_games(struct compressed_buf* buf, struct container_header* header, const struct uncompress_options* options, size_t** game_starts, size_t* n_games) {
+    size_t max_games = 64;
+    enum safe_bool has_game;
+    enum safe_bool is_intact = TRUE;
+    struct uncompress_options mainline_options = *options;
+    mainline_options.mainline_only = true; // only the end of the games matters
+
+    *n_games = 0;
+    *game_starts = malloc(sizeof(size_t) * max_games);
+    ASSERT_PRINTF_RETURN_ERROR(*game_starts != NULL, "Cannot allocate the game offsets !");
+    while ((has_game = next_game(buf, header)) != FALSE) {
+        if (has_game == ERROR) { // next_game already told which block is damaged
+            is_intact = FALSE;
+            continue;
+        }
+        size_t* const expanded = expand_array_if_needed(*game_starts, *n_games + 1, sizeof(size_t), &max_games, 2);
+        ASSERT_PRINTF_RETURN_ERROR(expanded != NULL, "Cannot allocate space for %zu game offsets !", *n_games + 1);
+        *game_starts = expanded;
+        (*game_starts)[*n_games] = bit_offset(buf);
+        ASSERT_PRINTF_RETURN_ERROR(uncompress_game(buf, &mainline_options, NULL, NULL, NULL) == TRUE, "Cannot decode game %zu, the following games cannot be found !", *n_games + 1);
+        (*n_games)++;
+    }
+    return is_intact;
+}
+
+static size_t count_threads(size_t n_games) {
+    const long n_processors = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t n_threads = n_processors >= 1 ? (size_t)n_processors : 1;
+
+    if (n_threads > MAX_ROUNDTRIP_THREADS) {
+        n_threads = MAX_ROUNDTRIP_THREADS;
+    }
+    return n_threads < n_games ? n_threads : (n_games > 0 ? n_games : 1);
+}
+
+static bool report(const uint8_t* mismatches, size_t n_games) {
+    size_t n_mismatches = 0;
+
+    for (size_t game = 0; game < n_games; game++) {
+        if (mismatches[game] == 0) {
+            continue;
+        }
+        n_mismatches++;
+        if (mismatches[game] & ROUNDTRIP_FAILED_DECODING) {
+            fprintf(stderr, "Game %zu cannot be decoded !\n", game + 1);
+            continue;
+        }
+        fprintf(stderr, "Game %zu doesn't survive the", game + 1);
+        for (enum move_coding coding = 0; coding < N_MOVE_CODINGS; coding++) {
+            if (mismatches[game] & (1 << coding)) {
+                fprintf(stderr, " %s", MOVE_CODING_NAMES[coding]);
+            }
+        }
+        fputs(" coding !\n", stderr);
+    }
+    printf("%zu game%s round-tripped through every move coding, %zu mismatching\n", n_games, n_games >= 2 ? "s" : "", n_mismatches);
+    return n_mismatches == 0;
+}
+
+int roundtrip(const struct args* args) {
+    ASSERT_PRINTF_EXIT_FAILURE(args != NULL, "args is NULL !");
+    ASSERT_PRINTF_EXIT_FAILURE(args->input != NULL, "A round trip requires an input container !");
+
+    size_t size;
+    unsigned char* const raw_buf = read_compressed_file(args->input, &size);
+    if (raw_buf == NULL) {
+        fprintf(stderr, "Error while reading %s\n", args->input);
+        return EXIT_FAILURE;
+    }
+    struct compressed_buf buf;
+    make_compressed_buf(&buf, raw_buf, size);
+    struct container_header header = { 0 };
+    struct uncompress_options options = {
+        .print = false,
+        .cache = NULL,
+        .log = false // only the summary is worth printing
+    };
+    size_t* game_starts = NULL;
+    size_t n_games = 0;
+    uint8_t* mismatches = NULL;
+    bool status = read_container_header(&buf, &header);
+    options.huffman = container_huffman(&header);
+    options.trie = container_trie(&header);
+    options.variation_lengths = container_has_variation_lengths(&header);
+    const enum safe_bool is_intact = status ? find_games(&buf, &header, &options, &game_starts, &n_games) : ERROR;
+    status = is_intact != ERROR && (mismatches = calloc(n_games > 0 ? n_games : 1, 1)) != NULL;
+
+    const size_t n_threads = count_threads(n_games);
+    struct roundtrip_job jobs[MAX_ROUNDTRIP_THREADS];
+    pthread_t threads[MAX_ROUNDTRIP_THREADS];
+    size_t n_started = 0;
+    for (; status && n_started < n_threads; n_started++) {
+        jobs[n_started] = (struct roundtrip_job) {
+            .container = &buf,
+            .options = &options,
+            .game_starts = game_starts,
+            .n_games = n_games,
+            .first_game = n_started,
+            .step = n_threads,
+            .mismatches = mismatches
+        };
+        if (pthread_create(&threads[n_started], NULL, run_job, &jobs[n_started]) != 0) {
+            errprintf("Cannot start round trip thread %zu !\n", n_started + 1);
+            status = false;
+            break;
+        }
+    }
+    for (size_t i = 0; i < n_started; i++) {
+        pthread_join(threads[i], NULL);
+        status = status && !jobs[i].failed;
+    }
+    status = status && report(mismatches, n_games) && is_intact == TRUE;
+
+    free(mismatches);
+    free(game_starts);
+    free_container_header(&header);
+    free(raw_buf);
+    return status ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -11,13 +11,14 @@ char* my_strndup(const char* str, size_t to_take, size_t* duplicate_len) {
 
     const bool has_nul_terminator = memchr(str, '\0', to_take);
     const size_t copy_size = to_take + !has_nul_terminator;
-    char* const copy = malloc(sizeof(char) * has_nul_terminator);
+    char* const copy = malloc(sizeof(char) * copy_size);
 
     if (copy == NULL) {
         errprintf("Cannot copy string '%*s' !\n", (int)to_take, str);
         return NULL;
     }
     strncpy(copy, str, to_take);
+    copy[copy_size - 1] = '\0';
     *duplicate_len = copy_size;
     return copy;
 }
@@ -1,5 +1,6 @@
 #include <ctype.h>
 #include <inttypes.h>
+#include <limits.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdint.h>
@@ -8,16 +9,23 @@
 
 #include "../include/apply_move.h"
 #include "../include/array.h"
+#include "../include/bitboard.h"
 #include "../include/bits.h"
+#include "../include/checkpoint.h"
+#include "../include/container.h"
 #include "../include/debug.h"
 #include "../include/error.h"
 #include "../include/king.h"
+#include "../include/legal_index.h"
 #include "../include/log.h"
+#include "../include/movegen.h"
+#include "../include/pawn.h"
 #include "../include/read.h"
 #include "../include/piece.h"
 #include "../include/safe_bool.h"
 #include "../include/source_location.h"
 #include "../include/uncompress.h"
+#include "../include/zobrist.h"
 
 static bool parse_en_passant_header(struct compressed_buf* buf, struct en_passant_header* header) {
     ASSERT_PRINTF(buf != NULL, "Compressed buffer is NULL !");
@@ -45,12 +53,10 @@ static bool parse_tag(struct compressed_buf* buf, struct tag* tag) {
     ASSERT_PRINTF(tag != NULL, "Tag is NULL !");
 
     tag->name = (char*)read_bytes_until_nul_terminator(buf, &tag->name_len);
-    LOG("tag name: '%s'", tag->name);
     if (tag->name == NULL) {
         return false;
     }
     tag->value = (char*)read_bytes_until_nul_terminator(buf, &tag->value_len);
-    LOG("tag value: '%s'", tag->value);
     if (tag->value == NULL) {
         return false;
     }
@@ -99,9 +105,12 @@ static bool parse_tags(struct compressed_buf* buf, struct tag** tags, size_t* n_
             break;
         } else if (!parse_tag(buf, *tags + *n_tags)) {
             goto error;
-        } else if (!expand_array_if_needed(tags, *n_tags, sizeof(struct tag), max_tags, 2)) {
+        }
+        struct tag* const expanded_tags = expand_array_if_needed(*tags, *n_tags + 1, sizeof(struct tag), max_tags, 2);
+        if (expanded_tags == NULL) {
             goto error;
         }
+        *tags = expanded_tags;
     }
     return true;
 
@@ -138,15 +147,22 @@ static bool parse_castling(struct compressed_buf* buf, struct board_state* state
         return false;
     }
     const enum castling castling = castling_bit ? QUEENSIDE : KINGSIDE;
+    const enum player player = state->current_player;
+    const uint8_t king = coord_to_square(king_starting_coords[player]);
+    const uint8_t rook = coord_to_square(rook_starting_coords[player][castling]);
+    ASSERT_PRINTF(state->castling_rights & CASTLING_RIGHT(player, castling), "Castling without the right to !");
+    ASSERT_PRINTF((state->bitboards.pieces[player][KING] & square_bit(king)) && (state->bitboards.pieces[player][ROOK] & square_bit(rook)),
+        "Castling without the king and the rook on their starting squares !");
+    ASSERT_PRINTF(!(squares_between(king, rook) & all_occupied(&state->bitboards)), "Castling through occupied squares !");
     *token = (struct pgn_token) {
         .type = CASTLING,
         .move = {
             .move = (struct move) {
                 .algebraic_move = castling_bit ? "O-O-O" : "O-O",
                 .capture = false,
-                .player = state->current_player,
-                .from = king_starting_coords[state->current_player],
-                .to = king_ending_coords[state->current_player][castling],
+                .player = player,
+                .from = king_starting_coords[player],
+                .to = king_ending_coords[player][castling],
                 .extra_infos = {
                     .piece_type = KING,
                     .infos = {
@@ -176,12 +192,7 @@ static bool parse_nag(struct compressed_buf* buf, struct pgn_token* token) {
     return true;
 }
 
-static bool parse_end_of_the_game(struct compressed_buf* buf, struct pgn_token* token) {
-    uint8_t end_of_the_game;
-    if (!read_n_bits(buf, 2, &end_of_the_game)) {
-        return false;
-    }
-
+static bool make_end_of_the_game(uint8_t end_of_the_game, struct pgn_token* token) {
     struct winner winner = { .is_draw = false, .winner = INVALID_PLAYER };
 
     switch (end_of_the_game) {
@@ -198,7 +209,8 @@ static bool parse_end_of_the_game(struct compressed_buf* buf, struct pgn_token*
             break;
 
         default:
-            FAIL("Invalid end of the game: %" PRIx8, end_of_the_game);
+            fprintf(stderr, "Invalid end of the game %" PRIx8 " !\n", end_of_the_game);
+            return false;
     }
     *token = (struct pgn_token) {
         .type = END_OF_THE_GAME,
@@ -209,16 +221,41 @@ static bool parse_end_of_the_game(struct compressed_buf* buf, struct pgn_token*
     return true;
 }
 
-static bool parse_comment(struct compressed_buf* buf, struct pgn_token* token) {
+static bool parse_end_of_the_game(struct compressed_buf* buf, struct pgn_token* token) {
+    uint8_t end_of_the_game;
+    if (!read_n_bits(buf, 2, &end_of_the_game)) {
+        return false;
+    }
+    return make_end_of_the_game(end_of_the_game, token);
+}
+
+// allocated from the arena if there's one, so that it isn't freed after its visit
+static char* read_comment(struct compressed_buf* buf, struct arena* arena) {
     size_t len;
-    char* comment = (char*)read_bytes_until_nul_terminator(buf, &len);
+    if (arena == NULL) {
+        return (char*)read_bytes_until_nul_terminator(buf, &len);
+    } else if (memchr_bits(buf, '\0', &len) != TRUE) {
+        return NULL;
+    }
+
+    char* const comment = arena_alloc(arena, len + 1);
+    for (size_t i = 0; comment != NULL && i <= len; i++) {
+        uint8_t c;
+        read_n_bits(buf, 8, &c);
+        comment[i] = c;
+    }
+    return comment;
+}
+
+static bool parse_comment(struct compressed_buf* buf, struct pgn_token* token, struct arena* arena) {
+    char* const comment = read_comment(buf, arena);
 
     if (comment == NULL) {
         fprintf(stderr, "Cannot read comment !\n");
         return false;
     }
     *token = (struct pgn_token) {
-        .type = CASTLING,
+        .type = COMMENT,
         .move = {
             .comment = comment
         }
@@ -228,7 +265,7 @@ static bool parse_comment(struct compressed_buf* buf, struct pgn_token* token) {
 
 static bool parse_promotion(struct compressed_buf* buf, struct board_state* state, struct pgn_token* token) {
     struct coord pawn_coords[BOARD_SIZE];
-    const uint8_t pawns_ready_to_promote = count_pawns_ready_to_promote(state->board, state->current_player, pawn_coords);
+    const uint8_t pawns_ready_to_promote = count_pawns_ready_to_promote(&state->bitboards, state->current_player, pawn_coords);
     if (pawns_ready_to_promote == 0) {
         fprintf(stderr, "No pawn can promote but still parsed promotion !\n");
         return false;
@@ -244,24 +281,40 @@ static bool parse_promotion(struct compressed_buf* buf, struct board_state* stat
 
     uint8_t nth_pawn = 0;
     if (pawns_ready_to_promote > 1) {
-        const uint8_t n_extra_bits = how_many_bits_to_hold_number(pawns_ready_to_promote);
+        const uint8_t n_extra_bits = how_many_bits_to_hold_number(pawns_ready_to_promote - 1);
         if (!read_n_bits(buf, n_extra_bits, &nth_pawn)) {
             fprintf(stderr, "Cannot parse promoted pawn ID !\n");
             return false;
         }
     }
-    struct coord pawn;
-    if (!nth_piece(state->board, state->current_player, PAWN, nth_pawn, &pawn)) {
+    if (nth_pawn >= pawns_ready_to_promote) {
         fprintf(stderr, "Cannot determine which pawn is being promoted !\n");
         return false;
     }
+    const struct coord pawn = pawn_coords[nth_pawn];
+
+    struct coord squares[3];
+    const uint8_t n_squares = list_promotion_squares(state->board, pawn, state->current_player, squares);
+    uint8_t nth_square = 0;
+    if (n_squares == 0) {
+        fprintf(stderr, "Promoted pawn cannot move !\n");
+        return false;
+    } else if (n_squares > 1 && !read_n_bits(buf, how_many_bits_to_hold_number(n_squares - 1), &nth_square)) {
+        fprintf(stderr, "Cannot parse promotion square !\n");
+        return false;
+    } else if (nth_square >= n_squares) {
+        fprintf(stderr, "Invalid promotion square index %" PRIu8 " !\n", nth_square);
+        return false;
+    }
+    const struct coord square = squares[nth_square];
     *token = (struct pgn_token) {
         .type = PROMOTION,
         .move = {
             .move = (struct move) {
-                .capture = false, /* must be checked ! */
+                .piece = PAWN,
+                .capture = board_at_coord(state->board, square)->type != EMPTY_SQUARE,
                 .from = pawn,
-                .to = pawn, /* must determine destination ! think about cases where the same pawn can capture twice or just go forward, 3 possibilities then !*/
+                .to = square,
                 .player = state->current_player,
                 .extra_infos = {
                     .piece_type = PAWN,
@@ -280,130 +333,329 @@ static bool parse_promotion(struct compressed_buf* buf, struct board_state* stat
     return true;
 }
 
-static enum safe_bool parse_move(struct compressed_buf* buf, struct board_state* state, struct pgn_token* token);
+static void visit_token(const struct uncompress_options* options, const struct pgn_token* token) {
+    if (options->on_token != NULL) {
+        options->on_token(token, options->token_data);
+    }
+}
+
+static bool make_alternative_moves_token(bool is_end, struct pgn_token* token) {
+    *token = (struct pgn_token) {
+        .type = ALTERNATIVE_MOVE,
+        .move = {
+            .alternative_moves_is_end = is_end
+        }
+    };
+    return true;
+}
 
-static bool parse_alternative_moves(struct compressed_buf* buf, struct board_state* state, struct pgn_token* token) {
+static bool parse_alternative_moves(struct compressed_buf* buf, struct pgn_token* token) {
     ASSERT_PRINTF(buf != NULL, "Compressed buffer is NULL !");
-    ASSERT_PRINTF(state != NULL, "Board state is NULL !");
     ASSERT_PRINTF(token != NULL, "PGN token is NULL !");
 
     uint8_t extra_bit;
     if (!read_n_bits(buf, 1, &extra_bit)) {
         return false;
     }
-    if (extra_bit == 0) {
-        LOG_FROM(LOC_HERE, "End of alternative moves");
-        return board_end_alternative_moves(state);
-    }
-    LOG_FROM(LOC_HERE, "Beginning of alternative moves");
-    ASSERT_PRINTF_EXIT_FAILURE(board_start_alternative_moves(state), "Cannot start alternative moves sequence !");
-    LOG("Previous board :");
-    print_board(state->board);
-    while (true) {
-        if (parse_move(buf, state, token) != TRUE) {
-            return false;
-        } else if (token->type == ALTERNATIVE_MOVE && token->move.alternative_moves_is_end) {
-            break;
-        }
+    return make_alternative_moves_token(extra_bit == 0, token);
+}
+
+// we must apply the move before calling is_player_checked, but it's taken back, as the move is applied in the main uncompressing loop
+static void compute_check(struct board_state* state, struct pgn_token* token, const struct uncompress_options* options) {
+    struct move_undo undo;
+    apply_move_on_raw_board(token, state->board, &state->bitboards, &undo);
+    const enum player opponent = opponent_player(state->current_player);
+    const int en_passant_file = en_passant_file_after(state->board, &undo);
+    const zobrist_key key = position_key_of(&state->bitboards, opponent, castling_rights_after(state->castling_rights, &undo), en_passant_file);
+    token->move.move.check = cached_is_player_checked(options->cache, key, &state->bitboards, opponent, en_passant_file);
+    unmake_move(state->board, &state->bitboards, &undo);
+}
+
+static bool parse_destination_index(struct compressed_buf* buf, struct board_state* state, enum piece_type piece, struct coord* to) {
+    const bitboard destinations = move_destinations(&state->bitboards, state->current_player, piece, state->en_passant_file);
+    const uint8_t n_destinations = count_squares(destinations);
+    uint8_t index = 0;
+    if (n_destinations == 0) {
+        fprintf(stderr, "No %s can move !\n", PIECES_NAME[piece]);
+        return false;
+    } else if (n_destinations > 1 && !read_n_bits(buf, how_many_bits_to_hold_number(n_destinations - 1), &index)) {
+        fprintf(stderr, "Cannot read destination index !\n");
+        return false;
+    } else if (index >= n_destinations) {
+        fprintf(stderr, "Invalid destination index %" PRIu8 " among %" PRIu8 " squares !\n", index, n_destinations);
+        return false;
     }
+    *to = square_to_coord(nth_square(destinations, index));
     return true;
 }
 
-static bool parse_move_impl(struct compressed_buf* buf, struct board_state* state, struct pgn_token* token) {
+static bool parse_move_impl(struct compressed_buf* buf, struct board_state* state, struct pgn_token* token, const struct uncompress_options* options) {
     uint8_t file;
     uint8_t rank;
-    ASSERT_PRINTF(read_n_bits(buf, 3, &file), "Error while parsing move file !");
-    ASSERT_PRINTF(read_n_bits(buf, 3, &rank), "Error while parsing move rank !");
+    if (options->coding == DESTINATION_CODING) {
+        if (!parse_destination_index(buf, state, token->move.move.piece, &token->move.move.to)) {
+            return false;
+        }
+        file = token->move.move.to.file;
+        rank = token->move.move.to.rank;
+    } else {
+        ASSERT_PRINTF(read_n_bits(buf, 3, &file), "Error while parsing move file !");
+        ASSERT_PRINTF(read_n_bits(buf, 3, &rank), "Error while parsing move rank !");
+    }
     token->move.move.to.file = file;
     token->move.move.to.rank = rank;
     token->move.move.capture = board_at_coord(state->board, token->move.move.to)->type != EMPTY_SQUARE;
-    LOG("A %s %s (%d) is moving", (state->current_player == WHITE ? "white" : "black"), PIECES_NAME[token->move.move.piece], token->move.move.piece);
-    LOG("file: %c (raw: %d) // rank: %d (raw: %d)\n", 'a' + file, file, 1 + rank, rank);
+    // the move generation relies on both kings, a malformed move mustn't take one
+    ASSERT_PRINTF(board_at_coord(state->board, token->move.move.to)->type != KING, "A king cannot be captured, at %c%d !", 'a' + file, 1 + rank);
+    LOG(options->log, "A %s %s (%d) is moving", (state->current_player == WHITE ? "white" : "black"), PIECES_NAME[token->move.move.piece], token->move.move.piece);
+    LOG(options->log, "file: %c (raw: %d) // rank: %d (raw: %d)\n", 'a' + file, file, 1 + rank, rank);
 
-    struct coord coords[8];
-    const uint8_t count = count_how_many_pieces_of_same_type_can_move_to_square(state->board, state->current_player, token->move.move.piece, &token->move.move.to, coords);
-    LOG("%hhu piece%s can move to the square %c%hhu\n", count, count >= 2 ? "s" : "", 'a' + token->move.move.to.file, 1 + token->move.move.to.rank);
+    struct coord coords[MAX_PIECES_TO_GO_TO_SAME_SQUARE];
+    const uint8_t count = count_how_many_pieces_of_same_type_can_move_to_square(&state->bitboards, state->current_player, token->move.move.piece, &token->move.move.to, coords);
+    LOG(options->log, "%hhu piece%s can move to the square %c%hhu\n", count, count >= 2 ? "s" : "", 'a' + token->move.move.to.file, 1 + token->move.move.to.rank);
     if (count == 0) {
-        print_board(state->board);
+        if (options->log) {
+            print_board(state->board);
+        }
+        fprintf(stderr, "No %s can move to %c%d !\n", PIECES_NAME[token->move.move.piece], 'a' + file, 1 + rank);
+        return false;
     }
 
     struct coord* coord = &coords[0];
 
     if (count > 1) {
         uint8_t nth;
-        ASSERT_PRINTF(read_n_bits(buf, how_many_bits_to_hold_number(count), &nth), "Cannot read disambiguation bits !");
-        qsort(coords, count, sizeof(struct coord), qsort_compare_piece_by_index);
+        ASSERT_PRINTF(read_n_bits(buf, how_many_bits_to_hold_number(count - 1), &nth), "Cannot read disambiguation bits !");
+        ASSERT_PRINTF(nth < count, "Invalid disambiguation %" PRIu8 " among %" PRIu8 " pieces !", nth, count);
         coord = coords + nth;
     }
     token->move.move.from = *coord;
-    LOG("The moves comes from %c%hhu", 'a' + coord->file, 1 + coord->rank);
+    LOG(options->log, "The moves comes from %c%hhu", 'a' + coord->file, 1 + coord->rank);
     token->move.move.piece = board_at_coord(state->board, *coord)->type;
-
-    // we must apply the move before calling is_player_checked, but we do it on a temp board, as the move is applied in the main uncompressing loop
-    board copy;
-    memcpy(copy, state->board, sizeof(board));
-    apply_move_on_raw_board(token, copy);
-    token->move.move.check = is_player_checked(copy, opponent_player(state->current_player), true);
+    if (token->move.move.piece == PAWN && coord->file != token->move.move.to.file && !token->move.move.capture) {
+        token->move.move.capture = true; // en passant
+        token->move.move.extra_infos.infos.pawn_infos.en_passant = true;
+    }
+    compute_check(state, token, options);
     return true;
 }
 
-static enum safe_bool parse_move(struct compressed_buf* buf, struct board_state* state, struct pgn_token* token) {
-    ASSERT_PRINTF(buf != NULL, "Compressed buffer is NULL !");
-    ASSERT_PRINTF(token != NULL, "PGN token is NULL !");
+static bool parse_indexed_token(struct compressed_buf* buf, struct board_state* state, struct pgn_token* token, const struct uncompress_options* options) {
+    struct legal_move moves[MAX_LEGAL_MOVES];
+    const uint8_t n_moves = generate_legal_moves(&state->bitboards, state->current_player, state->castling_rights, state->en_passant_file, moves);
+    uint8_t index;
+    ASSERT_PRINTF(read_n_bits(buf, legal_index_bits(n_moves), &index), "Cannot read token index !");
 
-    memset(token, 0, sizeof(struct pgn_token));
+    if (index < n_moves) {
+        legal_move_to_token(state->board, state->current_player, &moves[index], token);
+        if (token->type != CASTLING && token->type != PROMOTION) { // same as the prefix coding
+            compute_check(state, token, options);
+        }
+        return true;
+    }
+
+    switch (index - n_moves) {
+        case COMMENT_INDEX:
+            return parse_comment(buf, token, options->arena);
+
+        case ALTERNATIVE_MOVES_START_INDEX:
+            return make_alternative_moves_token(false, token);
+
+        case ALTERNATIVE_MOVES_END_INDEX:
+            return make_alternative_moves_token(true, token);
+
+        case NAG_INDEX:
+            return parse_nag(buf, token);
+
+        case END_OF_THE_GAME_INDEX:
+            return parse_end_of_the_game(buf, token);
+
+        default:
+            fprintf(stderr, "Invalid token index %" PRIu8 " with %" PRIu8 " legal moves !\n", index, n_moves);
+            return false;
+    }
+}
+
+// an arena cannot reallocate, a bigger comment is allocated instead, the arena ending up with less than twice the comment
+static char* expand_comment(char* comment, size_t len, size_t* capacity, struct arena* arena) {
+    if (arena == NULL) {
+        return expand_array_if_needed(comment, len + 1, sizeof(char), capacity, 2);
+    } else if (len + 1 < *capacity) {
+        return comment;
+    }
+    char* const expanded = arena_alloc(arena, *capacity * 2);
+    if (expanded != NULL) {
+        memcpy(expanded, comment, len);
+        *capacity *= 2;
+    }
+    return expanded;
+}
+
+static bool parse_arithmetic_comment(struct range_decoder* decoder, struct pgn_token* token, struct arena* arena) {
+    size_t len = 0;
+    size_t capacity = 32;
+    char* comment = arena != NULL ? arena_alloc(arena, capacity) : malloc(capacity);
 
+    while (comment != NULL) {
+        uint32_t c;
+        if (!decode_direct_bits(decoder, 8, &c)) {
+            break;
+        }
+        char* const expanded = expand_comment(comment, len, &capacity, arena);
+        if (expanded == NULL) {
+            break;
+        }
+        comment = expanded;
+        comment[len++] = c;
+        if (c == '\0') {
+            *token = (struct pgn_token) {
+                .type = COMMENT,
+                .move = {
+                    .comment = comment
+                }
+            };
+            return true;
+        }
+    }
+    if (arena == NULL) {
+        free(comment);
+    }
+    fprintf(stderr, "Cannot decode comment !\n");
+    return false;
+}
+
+static bool parse_arithmetic_token(struct board_state* state, struct pgn_token* token, const struct uncompress_options* options) {
+    struct range_decoder* const decoder = &options->arithmetic->decoder;
+    struct move_model* const model = &options->arithmetic->model;
+    bool is_move;
+    ASSERT_PRINTF(decode_bit(decoder, &model->is_move, &is_move), "Cannot decode token kind !");
+
+    if (is_move) {
+        struct legal_move moves[MAX_LEGAL_MOVES];
+        const uint8_t n_moves = generate_legal_moves(&state->bitboards, state->current_player, state->castling_rights, state->en_passant_file, moves);
+        uint8_t rank = 0;
+        ASSERT_PRINTF(n_moves > 0, "Decoded a move without any legal move !");
+        if (n_moves > 1) { // a forced move costs nothing
+            rank_legal_moves(model, state, moves, n_moves);
+            ASSERT_PRINTF(decode_rank(decoder, model, &rank), "Cannot decode move rank !");
+            ASSERT_PRINTF(rank < n_moves, "Invalid move rank %" PRIu8 " with %" PRIu8 " legal moves !", rank, n_moves);
+        }
+        legal_move_to_token(state->board, state->current_player, &moves[rank], token);
+        move_model_played(model, state->current_player, moves[rank].from, moves[rank].to);
+        if (token->type != CASTLING && token->type != PROMOTION) { // same as the prefix coding
+            compute_check(state, token, options);
+        }
+        return true;
+    }
+
+    enum special_index index;
+    uint32_t value;
+    ASSERT_PRINTF(decode_special_index(decoder, model, &index), "Cannot decode special token !");
+    switch (index) {
+        case COMMENT_INDEX:
+            return parse_arithmetic_comment(decoder, token, options->arena);
+
+        case ALTERNATIVE_MOVES_START_INDEX:
+            return make_alternative_moves_token(false, token);
+
+        case ALTERNATIVE_MOVES_END_INDEX:
+            return make_alternative_moves_token(true, token);
+
+        case NAG_INDEX:
+            ASSERT_PRINTF(decode_direct_bits(decoder, 8, &value), "Cannot decode NAG !");
+            *token = (struct pgn_token) {
+                .type = NAG,
+                .move = {
+                    .nag = value
+                }
+            };
+            return true;
+
+        case END_OF_THE_GAME_INDEX:
+            ASSERT_PRINTF(decode_direct_bits(decoder, 2, &value), "Cannot decode the end of the game !");
+            return make_end_of_the_game(value, token);
+
+        default:
+            fprintf(stderr, "Invalid special token %d !\n", index);
+            return false;
+    }
+}
+
+// the token types are their own prefix code, see enum token_type
+static bool read_prefix_token_type(struct compressed_buf* buf, enum token_type* type) {
     uint8_t token_3bits;
     if (!read_n_bits(buf, 3, &token_3bits)) {
         return false;
     }
-
     if (token_3bits != _0b110 && token_3bits != _0b111) {
-        token->type = token_3bits;
-        token->move.move.piece = token_3bits;
-        return parse_move_impl(buf, state, token);
-    }
-
-    uint8_t extra_1st_bit;
-    ASSERT_PRINTF(read_n_bits(buf, 1, &extra_1st_bit), "Cannot read extra 1st bit !");
-
-    if (token_3bits == _0b110) {
-        switch (extra_1st_bit) {
-            case 0:
-                return parse_castling(buf, state, token);
-
-            case 1:
-                return parse_promotion(buf, state, token);
-        }
-        FAIL("Invalid bit, got %" PRIu8 " instead of 0 or 1 !", extra_1st_bit);
-    } else if (token_3bits == _0b111) {
-        uint8_t extra_2nd_bit;
-        ASSERT_PRINTF(read_n_bits(buf, 1, &extra_2nd_bit), "Cannot read 2nd extra bit !");
-        ASSERT_PRINTF(extra_1st_bit <= 1, "Invalid extra 1st bit, got %" PRIu8 " instead of 0 or 1 !", extra_1st_bit);
-        ASSERT_PRINTF(extra_2nd_bit <= 1, "Invalid extra 2nd bit, got %" PRIu8 " instead of 0 or 1 !", extra_2nd_bit);
-
-        switch (extra_1st_bit) {
-            case 0:
-                switch (extra_2nd_bit) {
-                    case 0:
-                        return parse_comment(buf, token);
-                    case 1:
-                        return parse_alternative_moves(buf, state, token);
-                }
+        *type = token_3bits;
+        return true;
+    }
 
-            case 1:
-                switch (extra_2nd_bit) {
-                    case 0:
-                        return parse_nag(buf, token);
-                    case 1:
-                        return parse_end_of_the_game(buf, token);
-                }
+    const uint8_t n_extra_bits = token_3bits == _0b110 ? 1 : 2;
+    uint8_t extra_bits;
+    ASSERT_PRINTF(read_n_bits(buf, n_extra_bits, &extra_bits), "Cannot read the %" PRIu8 " extra bits of the token type !", n_extra_bits);
+    *type = (token_3bits << n_extra_bits) | extra_bits;
+    return true;
+}
 
-            default:
-                FAIL("Invalid 1st bit, got %" PRIu8 " instead of 0 or 1 !", extra_1st_bit);
-        }
+static enum safe_bool parse_prefixed_token(struct compressed_buf* buf, struct board_state* state, struct pgn_token* token, const struct uncompress_options* options) {
+    enum token_type type;
+    const bool is_type_read = options->huffman != NULL ?
+        read_token_type(buf, options->huffman, &type) :
+        read_prefix_token_type(buf, &type);
+    if (!is_type_read) {
+        return false;
+    }
+
+    switch (type) {
+        case CASTLING:
+            return parse_castling(buf, state, token);
+
+        case PROMOTION:
+            return parse_promotion(buf, state, token);
+
+        case COMMENT:
+            return parse_comment(buf, token, options->arena);
+
+        case ALTERNATIVE_MOVE:
+            return parse_alternative_moves(buf, token);
+
+        case NAG:
+            return parse_nag(buf, token);
+
+        case END_OF_THE_GAME:
+            return parse_end_of_the_game(buf, token);
+
+        default:
+            ASSERT_PRINTF_RETURN_ERROR(type <= MOVE_PAWN, "Invalid token type %d !", type);
+            token->type = type;
+            token->move.move.piece = (enum piece_type)type;
+            return parse_move_impl(buf, state, token, options);
     }
-    FAIL("Invalid bits !");
+}
+
+static enum safe_bool parse_move(struct compressed_buf* buf, struct board_state* state, struct pgn_token* token, const struct uncompress_options* options) {
+    ASSERT_PRINTF(buf != NULL, "Compressed buffer is NULL !");
+    ASSERT_PRINTF(token != NULL, "PGN token is NULL !");
+
+    memset(token, 0, sizeof(struct pgn_token));
+
+    enum safe_bool status;
+    switch (options->coding) {
+        case LEGAL_INDEX_CODING:
+            status = to_safe_bool(parse_indexed_token(buf, state, token, options));
+            break;
+
+        case ARITHMETIC_CODING:
+            status = to_safe_bool(parse_arithmetic_token(state, token, options));
+            break;
+
+        default:
+            status = parse_prefixed_token(buf, state, token, options);
+            break;
+    }
+    return status;
 }
 
 void free_token(struct pgn_token* token) {
@@ -419,6 +671,486 @@ static bool parse_version(struct compressed_buf* buf, uint8_t* version) {
     return read_n_bits(buf, 8, version);
 }
 
+static bool parse_opening_node(struct compressed_buf* buf, const struct uncompress_options* options, size_t* node) {
+    ASSERT_PRINTF(options->trie != NULL, "The game starts from the opening trie, but the container has none !");
+    uint64_t id;
+    ASSERT_PRINTF(read_bits(buf, opening_node_id_bits(options->trie), &id), "Cannot read the opening trie node !");
+    ASSERT_PRINTF(id < options->trie->n_nodes, "Invalid opening trie node %" PRIu64 " among %zu !", id, options->trie->n_nodes);
+    *node = id;
+    return true;
+}
+
+// checkpoints is NULL if the checkpoint table must be skipped, the own tags of a duplicate game are already in the layout
+static bool parse_game_header(struct compressed_buf* buf, const struct uncompress_options* options, struct game_layout* layout, bool is_duplicate, struct checkpoint** checkpoints, size_t* n_checkpoints) {
+    struct en_passant_header en_passant_header;
+    struct tag* tags = NULL;
+    size_t n_tags = 0;
+    size_t max_tags;
+
+    layout->start = bit_offset(buf);
+    bool status = true;
+    status = status && parse_version(buf, &layout->version);
+    if (options->print) {
+        printf("Protocol v%" PRIx8 "\n", layout->version);
+    }
+    if (status && !is_version_valid(layout->version)) {
+        fprintf(stderr, "Unknown protocol version %" PRIu8 " !\n", layout->version);
+        status = false;
+    }
+    LOG(options->log, "After version, status %d\n", status);
+    if (!is_duplicate) {
+        layout->tags_start = bit_offset(buf);
+    }
+    status = status && parse_tags(buf, &tags, &n_tags, &max_tags);
+    if (!is_duplicate) {
+        layout->tags_end = bit_offset(buf);
+    }
+    layout->en_passant_start = bit_offset(buf);
+    if (status && is_duplicate) {
+        free_tags(&tags, &n_tags, &max_tags);
+        struct compressed_buf tags_buf = *buf;
+        status = seek_bit_offset(&tags_buf, layout->tags_start) && parse_tags(&tags_buf, &tags, &n_tags, &max_tags);
+    }
+    LOG(options->log, "After tags, status: %d\n", status);
+    for (size_t i = 0; status && i < n_tags; i++) {
+        LOG(options->log, "tag '%s': '%s'", tags[i].name, tags[i].value);
+    }
+    status = status && parse_en_passant_header(buf, &en_passant_header);
+    LOG(options->log, "After en passant, status: %d\n", status);
+    if (status && options->print) {
+        debug_print(&en_passant_header, tags, n_tags);
+    }
+    free_tags(&tags, &n_tags, &max_tags);
+
+    layout->opening_start = bit_offset(buf);
+    layout->opening_node = 0;
+    if (status && (layout->version & VERSION_OPENING_TRIE)) {
+        status = parse_opening_node(buf, options, &layout->opening_node);
+        LOG(options->log, "After opening node, status: %d\n", status);
+    }
+    layout->checkpoints_start = bit_offset(buf);
+    if (checkpoints != NULL) {
+        *checkpoints = NULL;
+        *n_checkpoints = 0;
+    }
+    if (status && (layout->version & VERSION_CHECKPOINTS)) {
+        status = read_checkpoint_table(buf, checkpoints, n_checkpoints);
+        LOG(options->log, "After checkpoints, status: %d\n", status);
+    }
+    layout->moves_start = bit_offset(buf);
+    layout->end = layout->moves_start;
+    return status;
+}
+
+// the arithmetic decoder must outlive the game options
+static bool make_game_options(struct compressed_buf* buf, const struct uncompress_options* options, const struct game_layout* layout, struct uncompress_options* game_options, struct arithmetic_decoder* arithmetic) {
+    *game_options = *options;
+    game_options->coding = version_move_coding(layout->version);
+    game_options->arithmetic = NULL;
+    game_options->variation_lengths = options->variation_lengths && game_options->coding != ARITHMETIC_CODING;
+    if (!(layout->version & VERSION_HUFFMAN_TOKENS)) {
+        game_options->huffman = NULL;
+    } else {
+        ASSERT_PRINTF(options->huffman != NULL, "The game uses Huffman coded token types, but the container has no code !");
+    }
+    if (game_options->coding == ARITHMETIC_CODING) {
+        move_model_init(&arithmetic->model);
+        game_options->arithmetic = arithmetic;
+        ASSERT_PRINTF(range_decoder_init(&arithmetic->decoder, buf), "Cannot start decoding the moves !");
+    }
+    return true;
+}
+
+/**
+ * Visits the moves of the opening trie leading to the node the game starts from, without parsing anything,
+ * and sets the state to the one of the node. The positions before it all have the first move of the game as bit offset.
+ */
+static void replay_opening(const struct uncompress_options* options, const struct game_layout* layout, struct board_state* state, unsigned* ply, position_visitor visitor, void* data) {
+    size_t path[MAX_OPENING_PLIES];
+    unsigned depth = 0;
+    for (size_t node = layout->opening_node; node != 0; node = options->trie->nodes[node].parent) {
+        path[depth++] = node;
+    }
+
+    *state = empty_board_state();
+    *ply = 0;
+    if (visitor != NULL) {
+        visitor(state, *ply, layout->moves_start, data);
+    }
+    while (depth > 0) {
+        const struct opening_node* const node = &options->trie->nodes[path[--depth]];
+        visit_token(options, &node->token);
+        if (options->print) {
+            print_token(&node->token);
+        }
+        *ply = node->state.ply;
+        if (visitor != NULL || depth == 0) {
+            free_board_state(state);
+            restore_checkpoint(&node->state, state);
+        }
+        if (visitor != NULL) {
+            visitor(state, *ply, layout->moves_start, data);
+        }
+    }
+}
+
+static bool read_variation_length(struct compressed_buf* buf, uint64_t* length) {
+    uint8_t n_bits;
+    return read_n_bits(buf, VARIATION_LENGTH_SIZE_BITS, &n_bits) && read_bits(buf, n_bits, length);
+}
+
+// returns FALSE if the alternative moves are skipped, as only the main line is wanted
+static enum safe_bool start_alternative_moves(struct compressed_buf* buf, struct board_state* state, struct variation_stack* variations, const struct uncompress_options* options) {
+    LOG(options->log, "Beginning of alternative moves");
+    uint64_t length = 0;
+    if (options->variation_lengths) {
+        ASSERT_PRINTF_RETURN_ERROR(read_variation_length(buf, &length), "Cannot read the length of alternative moves !");
+        if (options->mainline_only) {
+            ASSERT_PRINTF_RETURN_ERROR(length <= buf->remaining_bits, "Alternative moves of %" PRIu64 " bits go past the end of the buffer !", length);
+            seek_bit_offset(buf, bit_offset(buf) + length);
+            return FALSE;
+        }
+    }
+    ASSERT_PRINTF_RETURN_ERROR(variations->depth < MAX_VARIATION_DEPTH, "Alternative moves cannot be nested more than %d times !", MAX_VARIATION_DEPTH);
+    ASSERT_PRINTF_RETURN_ERROR(board_start_alternative_moves(state), "Cannot start alternative moves sequence !");
+    variations->frames[variations->depth++] = (struct variation_frame) {
+        .start = bit_offset(buf),
+        .length = length
+    };
+    LOG(options->log, "Previous board :");
+    if (options->log) {
+        print_board(state->board);
+    }
+    return TRUE;
+}
+
+static enum safe_bool end_alternative_moves(struct compressed_buf* buf, struct board_state* state, struct variation_stack* variations, const struct uncompress_options* options) {
+    LOG(options->log, "End of alternative moves");
+    ASSERT_PRINTF_RETURN_ERROR(variations->depth > 0, "Alternative moves end without having started !");
+    const struct variation_frame* const frame = &variations->frames[--variations->depth];
+    ASSERT_PRINTF_RETURN_ERROR(!options->variation_lengths || bit_offset(buf) - frame->start == frame->length,
+        "Alternative moves of %" PRIu64 " bits took %zu bits !", frame->length, bit_offset(buf) - frame->start);
+    return board_end_alternative_moves(state) ? TRUE : ERROR;
+}
+
+/**
+ * Parses the next token and plays it, alternative moves being played in the same way as the main line.
+ * Returns FALSE if the token starts alternative moves which are skipped, ERROR if it's malformed.
+ */
+static enum safe_bool replay_token(struct compressed_buf* buf, struct board_state* board_state, const struct uncompress_options* options, struct variation_stack* variations, struct pgn_token* token) {
+    if (parse_move(buf, board_state, token, options) != TRUE) {
+        return ERROR;
+    }
+    if (token->type == ALTERNATIVE_MOVE) {
+        return token->move.alternative_moves_is_end ?
+            end_alternative_moves(buf, board_state, variations, options) :
+            start_alternative_moves(buf, board_state, variations, options);
+    } else if (is_token_a_move(token->type)) {
+        if (!apply_move(token, board_state)) {
+            return ERROR;
+        }
+        next_turn(board_state);
+        LOG_FROM(options->log, LOC_HERE, "Board after move :");
+        if (options->log) {
+            print_board(board_state->board);
+        }
+    }
+    return TRUE;
+}
+
+// without variation lengths, the alternative moves are still replayed when only the main line is wanted, but quietly
+static bool is_token_hidden(const struct uncompress_options* options, const struct variation_stack* variations, const struct pgn_token* token) {
+    return options->mainline_only && (variations->depth > 0 || token->type == ALTERNATIVE_MOVE);
+}
+
+/**
+ * Replays the main line from the state at the given ply, until the end of the game or the last ply.
+ * Alternative moves are replayed in the same loop, their nesting being kept by an explicit stack rather than by recursion.
+ * Returns ERROR if a move is malformed, TRUE otherwise, and layout->end is set if the end of the game is reached.
+ */
+static enum safe_bool replay_moves(struct compressed_buf* buf, struct board_state* board_state, const struct uncompress_options* options, struct game_layout* layout, unsigned* ply, unsigned last_ply, position_visitor visitor, void* data) {
+    struct variation_stack variations;
+    struct pgn_token token;
+
+    variations.depth = 0;
+    // the range decoder reads ahead, so the last moves of an arithmetic coded game are decoded from an empty buffer
+    while (*ply < last_ply && (options->coding == ARITHMETIC_CODING || !is_buf_empty(buf))) {
+        const enum safe_bool is_replayed = replay_token(buf, board_state, options, &variations, &token);
+        if (is_replayed != TRUE) {
+            if (is_replayed == ERROR) {
+                return ERROR;
+            }
+            continue;
+        }
+        if (!is_token_hidden(options, &variations, &token)) {
+            visit_token(options, &token);
+            if (options->print) {
+                print_token(&token);
+            }
+        }
+        if (token.type == END_OF_THE_GAME) {
+            break;
+        }
+        if (is_token_a_move(token.type) && variations.depth == 0) {
+            (*ply)++;
+            if (visitor != NULL) {
+                visitor(board_state, *ply, bit_offset(buf), data);
+            }
+        }
+        if (options->arena == NULL) {
+            free_token(&token);
+        }
+    }
+    if (*ply < last_ply) {
+        ASSERT_PRINTF_RETURN_ERROR(variations.depth == 0, "The game ends inside %zu alternative moves sequence%s !", variations.depth, variations.depth >= 2 ? "s" : "");
+        layout->end = bit_offset(buf);
+    }
+    return TRUE;
+}
+
+/**
+ * If the next game is a duplicate, records its own tags in the layout, seeks to its first occurrence
+ * and sets next_game to the offset right after the duplicate.
+ * Returns FALSE if it isn't a duplicate, the buffer being then untouched.
+ */
+static enum safe_bool follow_duplicate(struct compressed_buf* buf, const struct uncompress_options* options, struct game_layout* layout, size_t* next_game) {
+    uint8_t version;
+    if (!peek_n_bits(buf, 8, &version) || version != VERSION_DUPLICATE) {
+        return FALSE;
+    }
+
+    const size_t start = bit_offset(buf);
+    uint64_t offset;
+    ASSERT_PRINTF_RETURN_ERROR(parse_version(buf, &version) && read_bits(buf, DUPLICATE_OFFSET_BITS, &offset), "Cannot read the duplicate game reference !");
+    ASSERT_PRINTF_RETURN_ERROR(offset < start / 8, "The duplicate game at byte %zu refers to byte %" PRIu64 ", which isn't before it !", start / 8, offset);
+    struct tag* tags = NULL;
+    size_t n_tags = 0;
+    size_t max_tags;
+    layout->tags_start = bit_offset(buf);
+    ASSERT_PRINTF_RETURN_ERROR(parse_tags(buf, &tags, &n_tags, &max_tags), "Cannot read the tags of the duplicate game at byte %zu !", start / 8);
+    free_tags(&tags, &n_tags, &max_tags);
+    layout->tags_end = bit_offset(buf);
+    skip_to_next_byte(buf);
+    *next_game = bit_offset(buf);
+    if (options->print) {
+        printf("Duplicate of the game at byte %" PRIu64 "\n", offset);
+    }
+
+    seek_bit_offset(buf, offset * 8);
+    ASSERT_PRINTF_RETURN_ERROR(peek_n_bits(buf, 8, &version) && version != VERSION_DUPLICATE, "The duplicate game at byte %zu refers to another duplicate !", start / 8);
+    return TRUE;
+}
+
+enum safe_bool uncompress_game(struct compressed_buf* buf, const struct uncompress_options* options, struct game_layout* layout, position_visitor visitor, void* data) {
+    ASSERT_PRINTF_RETURN_ERROR(buf != NULL, "Compressed buffer is NULL !");
+    ASSERT_PRINTF_RETURN_ERROR(options != NULL, "Uncompress options are NULL !");
+
+    struct game_layout ignored_layout;
+    if (layout == NULL) {
+        layout = &ignored_layout;
+    }
+    size_t next_game;
+    const enum safe_bool is_duplicate = follow_duplicate(buf, options, layout, &next_game);
+    if (is_duplicate == ERROR || !parse_game_header(buf, options, layout, is_duplicate == TRUE, NULL, NULL)) {
+        return ERROR;
+    }
+    struct uncompress_options game_options;
+    struct arithmetic_decoder arithmetic;
+    if (!make_game_options(buf, options, layout, &game_options, &arithmetic)) {
+        return ERROR;
+    }
+
+    struct board_state board_state;
+    unsigned ply;
+    replay_opening(options, layout, &board_state, &ply, visitor, data);
+    const enum safe_bool state = replay_moves(buf, &board_state, &game_options, layout, &ply, UINT_MAX, visitor, data);
+    skip_to_next_byte(buf);
+    if (is_duplicate == TRUE) {
+        seek_bit_offset(buf, next_game);
+    }
+
+    free_board_state(&board_state);
+    return state;
+}
+
+bool copy_game_header(struct bit_writer* writer, const struct compressed_buf* buf, const struct game_layout* layout) {
+    return
+        copy_bits(writer, buf, layout->tags_start, layout->tags_end - layout->tags_start) &&
+        copy_bits(writer, buf, layout->en_passant_start, layout->opening_start - layout->en_passant_start);
+}
+
+enum safe_bool seek_game_to_ply(struct compressed_buf* buf, const struct uncompress_options* options, unsigned ply, struct board_state* board_state) {
+    ASSERT_PRINTF_RETURN_ERROR(buf != NULL, "Compressed buffer is NULL !");
+    ASSERT_PRINTF_RETURN_ERROR(options != NULL, "Uncompress options are NULL !");
+    ASSERT_PRINTF_RETURN_ERROR(board_state != NULL, "Board state is NULL !");
+
+    struct game_layout layout;
+    struct checkpoint* checkpoints;
+    size_t n_checkpoints;
+    size_t next_game;
+    const enum safe_bool is_duplicate = follow_duplicate(buf, options, &layout, &next_game);
+    if (is_duplicate == ERROR || !parse_game_header(buf, options, &layout, is_duplicate == TRUE, &checkpoints, &n_checkpoints)) {
+        return ERROR;
+    }
+
+    const struct opening_node* opening = layout.opening_node != 0 ? &options->trie->nodes[layout.opening_node] : NULL;
+    if (opening != NULL && ply <= opening->state.ply) {
+        while (opening->state.ply > ply) {
+            opening = &options->trie->nodes[opening->parent];
+        }
+        restore_checkpoint(&opening->state, board_state);
+        free(checkpoints);
+        return TRUE;
+    }
+
+    const struct checkpoint* nearest = NULL;
+    for (size_t i = 0; i < n_checkpoints && checkpoints[i].ply <= ply; i++) {
+        nearest = &checkpoints[i];
+    }
+    unsigned current_ply = 0;
+    if (nearest != NULL) {
+        LOG(options->log, "Starting from the checkpoint of ply %u", nearest->ply);
+        restore_checkpoint(nearest, board_state);
+        current_ply = nearest->ply;
+        seek_bit_offset(buf, layout.moves_start + nearest->bit_offset);
+    } else if (opening != NULL) {
+        LOG(options->log, "Starting from the opening trie node of ply %u", opening->state.ply);
+        restore_checkpoint(&opening->state, board_state);
+        current_ply = opening->state.ply;
+    } else {
+        *board_state = empty_board_state();
+    }
+    free(checkpoints);
+
+    struct uncompress_options game_options;
+    struct arithmetic_decoder arithmetic;
+    if (!make_game_options(buf, options, &layout, &game_options, &arithmetic)) {
+        free_board_state(board_state);
+        return ERROR;
+    }
+    if (replay_moves(buf, board_state, &game_options, &layout, &current_ply, ply, NULL, NULL) != TRUE) {
+        free_board_state(board_state);
+        return ERROR;
+    }
+    return current_ply == ply ? TRUE : FALSE;
+}
+
+enum safe_bool start_game_replay(struct compressed_buf* buf, const struct uncompress_options* options, struct game_replay* replay) {
+    ASSERT_PRINTF_RETURN_ERROR(buf != NULL, "Compressed buffer is NULL !");
+    ASSERT_PRINTF_RETURN_ERROR(options != NULL, "Uncompress options are NULL !");
+    ASSERT_PRINTF_RETURN_ERROR(replay != NULL, "Game replay is NULL !");
+
+    replay->buf = buf;
+    const enum safe_bool is_duplicate = follow_duplicate(buf, options, &replay->layout, &replay->next_game);
+    if (is_duplicate == ERROR || !parse_game_header(buf, options, &replay->layout, is_duplicate == TRUE, NULL, NULL)
+        || !make_game_options(buf, options, &replay->layout, &replay->options, &replay->arithmetic)) {
+        return ERROR;
+    }
+    replay->options.on_token = NULL;
+    replay->options.print = false;
+    replay->is_duplicate = is_duplicate == TRUE;
+    replay->is_over = false;
+    replay->variations.depth = 0;
+
+    replay->n_opening_nodes = 0;
+    for (size_t node = replay->layout.opening_node; node != 0; node = options->trie->nodes[node].parent) {
+        replay->opening_path[replay->n_opening_nodes++] = node;
+    }
+    if (replay->layout.opening_node != 0) {
+        restore_checkpoint(&options->trie->nodes[replay->layout.opening_node].state, &replay->state);
+    } else {
+        replay->state = empty_board_state();
+    }
+    return TRUE;
+}
+
+// moves the buffer to the next game
+static enum safe_bool finish_game_replay(struct game_replay* replay) {
+    replay->is_over = true;
+    const size_t depth = replay->variations.depth;
+    ASSERT_PRINTF_RETURN_ERROR(depth == 0, "The game ends inside %zu alternative moves sequence%s !", depth, depth >= 2 ? "s" : "");
+    replay->layout.end = bit_offset(replay->buf);
+    skip_to_next_byte(replay->buf);
+    if (replay->is_duplicate) {
+        seek_bit_offset(replay->buf, replay->next_game);
+    }
+    return TRUE;
+}
+
+enum safe_bool replay_next_token(struct game_replay* replay, struct pgn_token* token) {
+    ASSERT_PRINTF_RETURN_ERROR(replay != NULL, "Game replay is NULL !");
+    ASSERT_PRINTF_RETURN_ERROR(token != NULL, "PGN token is NULL !");
+
+    if (replay->n_opening_nodes > 0) {
+        *token = replay->options.trie->nodes[replay->opening_path[--replay->n_opening_nodes]].token;
+        return TRUE;
+    }
+    const struct uncompress_options* const options = &replay->options;
+    while (!replay->is_over) {
+        // the range decoder reads ahead, so the last moves of an arithmetic coded game are decoded from an empty buffer
+        if (options->coding != ARITHMETIC_CODING && is_buf_empty(replay->buf)) {
+            return finish_game_replay(replay) == TRUE ? FALSE : ERROR;
+        }
+        const enum safe_bool is_replayed = replay_token(replay->buf, &replay->state, options, &replay->variations, token);
+        if (is_replayed == ERROR) {
+            replay->is_over = true;
+            return ERROR;
+        } else if (is_replayed == FALSE) {
+            continue;
+        } else if (token->type == END_OF_THE_GAME) {
+            return finish_game_replay(replay);
+        } else if (!is_token_hidden(options, &replay->variations, token)) {
+            return TRUE;
+        }
+        if (options->arena == NULL) {
+            free_token(token);
+        }
+    }
+    return FALSE;
+}
+
+void end_game_replay(struct game_replay* replay) {
+    free_board_state(&replay->state);
+}
+
+bool has_next_game(const struct compressed_buf* buf) {
+    return buf->remaining_bits >= 8;
+}
+
+// only the first game of the container is looked at, the following ones can't be reached without replaying it entirely
+static int print_ply(struct compressed_buf* buf, struct container_header* header, unsigned ply, bool log) {
+    const struct uncompress_options options = {
+        .print = false,
+        .cache = NULL,
+        .huffman = container_huffman(header),
+        .trie = container_trie(header),
+        .variation_lengths = container_has_variation_lengths(header),
+        .mainline_only = true,
+        .log = log
+    };
+    struct board_state state;
+
+    if (next_game(buf, header) != TRUE) {
+        fputs("The container has no readable game !\n", stderr);
+        return EXIT_FAILURE;
+    }
+    switch (seek_game_to_ply(buf, &options, ply, &state)) {
+        case TRUE:
+            printf("Position after ply %u :\n", ply);
+            print_board(state.board);
+            free_board_state(&state);
+            return EXIT_SUCCESS;
+
+        case FALSE:
+            fprintf(stderr, "The game is shorter than %u plies !\n", ply);
+            free_board_state(&state);
+            return EXIT_FAILURE;
+
+        default:
+            return EXIT_FAILURE;
+    }
+}
+
 int uncompress(const struct args* args) {
     ASSERT_PRINTF_EXIT_FAILURE(args != NULL, "args is NULL !");
 
@@ -431,53 +1163,54 @@ int uncompress(const struct args* args) {
     printf("Content of %s (%zu byte%s):\n", args->input, size, size >= 2 ? "s" : "");
     binary_print(raw_buf, size);
 
-    struct compressed_buf buf = {
-        .buf = raw_buf,
-        .n_bytes = size,
-        .nth_bit = 0,
-        .nth_byte = 0,
-        .remaining_bits = size * 8
+    struct compressed_buf buf;
+    make_compressed_buf(&buf, raw_buf, size);
+    struct container_header header;
+    if (!read_container_header(&buf, &header)) {
+        free(raw_buf);
+        return EXIT_FAILURE;
+    }
+    if (args->ply >= 0) {
+        const int status = print_ply(&buf, &header, args->ply, args->log);
+        free_container_header(&header);
+        free(raw_buf);
+        return status;
+    }
+    if (header.flags & CONTAINER_HUFFMAN_TOKENS) {
+        print_token_huffman(&header.huffman);
+    }
+    if (header.flags & CONTAINER_OPENING_TRIE) {
+        printf("Opening trie : %zu node%s\n\n", header.trie.n_nodes, header.trie.n_nodes >= 2 ? "s" : "");
+    }
+    struct position_cache cache = { 0 };
+    const struct uncompress_options options = {
+        .print = true,
+        .cache = &cache,
+        .huffman = container_huffman(&header),
+        .trie = container_trie(&header),
+        .variation_lengths = container_has_variation_lengths(&header),
+        .mainline_only = args->mainline_only,
+        .log = args->log
     };
-    uint8_t version = 0;
-    struct en_passant_header en_passant_header;
-    struct tag* tags = NULL;
-    size_t n_tags = 0;
-    size_t max_tags;
-
-    bool status = true;
-    status = status && parse_version(&buf, &version);
-    printf("Protocol v%" PRIx8 "\n", version);
-    LOG("After version, status %d\n", status);
-    status = status && parse_tags(&buf, &tags, &n_tags, &max_tags);
-    LOG("After tags, status: %d\n", status);
-    status = status && parse_en_passant_header(&buf, &en_passant_header);
-    LOG("After en passant, status: %d\n", status);
-    debug_print(&en_passant_header, tags, n_tags);
-
-    bool has_moves = false;
-    struct board_state board_state = empty_board_state();
-    struct pgn_token token;
-    enum safe_bool state;
-    while (!is_buf_empty(&buf)) {
-        if ((state = parse_move(&buf, &board_state, &token)) != TRUE) {
-            break;
+    bool status = position_cache_init(&cache, POSITION_CACHE_DEFAULT_SIZE);
+    bool is_intact = true;
+    size_t nth_game = 0;
+    enum safe_bool has_game;
+    while (status && (has_game = next_game(&buf, &header)) != FALSE) {
+        if (has_game == ERROR) { // the games of the following blocks can still be read
+            is_intact = false;
+            continue;
         }
-        print_token(&token);
-        if (token.type == END_OF_THE_GAME) {
-            break;
+        if (nth_game > 0) {
+            printf("\nGame %zu\n", nth_game + 1);
         }
-        apply_move(&token, &board_state);
-        next_turn(&board_state);
-        has_moves = true;
-    }
-    if (state == ERROR) {
-        status = false;
+        status = uncompress_game(&buf, &options, NULL, NULL, NULL) == TRUE;
+        nth_game++;
     }
+    LOG(options.log, "Position cache : %zu hits, %zu misses", cache.hits, cache.misses);
+    position_cache_free(&cache);
+    free_container_header(&header);
 
-    free_board_state(&board_state);
-    free_token(has_moves ? &token : NULL);
-    free_tags(&tags, &n_tags, &max_tags);
     free(raw_buf);
-    LOG("%d\n", log_enabled);
-    return status ? EXIT_SUCCESS : EXIT_FAILURE;
+    return status && is_intact ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -0,0 +1,43 @@
+#include <string.h>
+
+#include "../include/version.h"
+
+const char* MOVE_CODING_NAMES[N_MOVE_CODINGS] = {
+    [PREFIX_CODING] = "prefix",
+    [LEGAL_INDEX_CODING] = "indices",
+    [ARITHMETIC_CODING] = "max",
+    [DESTINATION_CODING] = "destinations"
+};
+
+uint8_t make_version(enum move_coding coding, bool has_checkpoints) {
+    return (coding << VERSION_MOVE_CODING_SHIFT) | (has_checkpoints ? VERSION_CHECKPOINTS : 0);
+}
+
+enum move_coding version_move_coding(uint8_t version) {
+    return (version >> VERSION_MOVE_CODING_SHIFT) & VERSION_MOVE_CODING_MASK;
+}
+
+bool is_version_valid(uint8_t version) {
+    const uint8_t known_bits = VERSION_CHECKPOINTS | (VERSION_MOVE_CODING_MASK << VERSION_MOVE_CODING_SHIFT) | VERSION_HUFFMAN_TOKENS | VERSION_OPENING_TRIE;
+    const enum move_coding coding = version_move_coding(version);
+    if (version & VERSION_DUPLICATE) {
+        return version == VERSION_DUPLICATE;
+    }
+    return
+        (version & ~known_bits) == 0 && coding < N_MOVE_CODINGS &&
+        (!(version & VERSION_HUFFMAN_TOKENS) || has_token_type_prefix(coding));
+}
+
+bool has_token_type_prefix(enum move_coding coding) {
+    return coding == PREFIX_CODING || coding == DESTINATION_CODING;
+}
+
+bool move_coding_from_name(const char* name, enum move_coding* coding) {
+    for (enum move_coding i = 0; i < N_MOVE_CODINGS; i++) {
+        if (strcmp(name, MOVE_CODING_NAMES[i]) == 0) {
+            *coding = i;
+            return true;
+        }
+    }
+    return false;
+}
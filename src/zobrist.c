@@ -0,0 +1,63 @@
+#include "../include/bitboard.h"
+#include "../include/coord_constants.h"
+#include "../include/zobrist.h"
+
+#define N_PIECE_KEYS (2 * N_PIECE_TYPES * N_SQUARES)
+#define N_CASTLING_KEYS (ALL_CASTLING_RIGHTS + 1)
+
+#define FIRST_PIECE_KEY 0
+#define FIRST_CASTLING_KEY (FIRST_PIECE_KEY + N_PIECE_KEYS)
+#define FIRST_EN_PASSANT_KEY (FIRST_CASTLING_KEY + N_CASTLING_KEYS)
+#define BLACK_TO_MOVE_KEY (FIRST_EN_PASSANT_KEY + BOARD_SIZE)
+
+// splitmix64 finalizer, the nth key is derived from n so no table has to be built
+static zobrist_key nth_key(uint64_t n) {
+    uint64_t x = (n + 1) * 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+zobrist_key zobrist_piece_key(struct piece piece, uint8_t square) {
+    return nth_key(FIRST_PIECE_KEY + ((uint64_t)piece.player * N_PIECE_TYPES + piece.type) * N_SQUARES + square);
+}
+
+zobrist_key zobrist_castling_key(uint8_t castling_rights) {
+    return nth_key(FIRST_CASTLING_KEY + (castling_rights & ALL_CASTLING_RIGHTS));
+}
+
+zobrist_key zobrist_en_passant_key(int en_passant_file) {
+    return en_passant_file == INVALID_COORD ? 0 : nth_key(FIRST_EN_PASSANT_KEY + en_passant_file);
+}
+
+zobrist_key zobrist_black_to_move_key(void) {
+    return nth_key(BLACK_TO_MOVE_KEY);
+}
+
+bool can_capture_en_passant(const struct bitboards* bitboards, enum player player, int en_passant_file) {
+    if (en_passant_file == INVALID_COORD) {
+        return false;
+    }
+    const struct coord target = {
+        .file = en_passant_file,
+        .rank = player == WHITE ? RANK_6 : RANK_3
+    };
+    // a pawn attacks the target if a pawn of the opponent on the target would attack the pawn
+    return (PAWN_ATTACKS[opponent_player(player)][coord_to_square(target)] & bitboards->pieces[player][PAWN]) != EMPTY_BITBOARD;
+}
+
+zobrist_key position_key_of(const struct bitboards* bitboards, enum player player_to_move, uint8_t castling_rights, int en_passant_file) {
+    zobrist_key key = bitboards->pieces_key ^ zobrist_castling_key(castling_rights);
+
+    if (player_to_move == BLACK) {
+        key ^= zobrist_black_to_move_key();
+    }
+    if (can_capture_en_passant(bitboards, player_to_move, en_passant_file)) {
+        key ^= zobrist_en_passant_key(en_passant_file);
+    }
+    return key;
+}
+
+zobrist_key position_key(const struct board_state* state) {
+    return position_key_of(&state->bitboards, state->current_player, state->castling_rights, state->en_passant_file);
+}
@@ -0,0 +1,155 @@
+#include <criterion/criterion.h>
+#include <string.h>
+#include "../include/apply_move.h"
+#include "../include/bitboard.h"
+#include "../include/coord_constants.h"
+
+static bool are_boards_equal(board first, board second) {
+    for (int rank = 0; rank < BOARD_SIZE; rank++) {
+        for (int file = 0; file < BOARD_SIZE; file++) {
+            if (!are_pieces_equal(&first[rank][file], &second[rank][file])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// incrementally updated bitboards must match the ones built from scratch
+static bool are_bitboards_in_sync(board board, const struct bitboards* bitboards) {
+    struct bitboards expected;
+    compute_bitboards(board, &expected);
+    return memcmp(&expected, bitboards, sizeof(struct bitboards)) == 0;
+}
+
+Test(apply_move, make_unmake_capture) {
+    struct board_state state = empty_board_state();
+    board copy;
+    memcpy(copy, state.board, sizeof(board));
+
+    const struct coord from = MAKE_CONSTANT_COORD(D, 1);
+    const struct coord to = MAKE_CONSTANT_COORD(D, 7);
+    struct move_undo undo;
+    make_move(state.board, &state.bitboards, &from, &to, EMPTY_SQUARE, &undo);
+    cr_assert_eq(board_at_coord(state.board, to)->type, QUEEN);
+    cr_assert_eq(board_at_coord(state.board, from)->type, EMPTY_SQUARE);
+    cr_assert_eq(undo.captured.type, PAWN);
+    cr_assert_eq(undo.captured.player, BLACK);
+
+    unmake_move(state.board, &state.bitboards, &undo);
+    cr_assert(are_boards_equal(state.board, copy));
+    free_board_state(&state);
+}
+
+Test(apply_move, make_unmake_en_passant) {
+    struct board_state state = empty_board_state();
+    const struct coord white_from = MAKE_CONSTANT_COORD(E, 2);
+    const struct coord white_to = MAKE_CONSTANT_COORD(E, 5);
+    const struct coord black_from = MAKE_CONSTANT_COORD(D, 7);
+    const struct coord black_to = MAKE_CONSTANT_COORD(D, 5);
+    move_piece(state.board, &white_from, &white_to);
+    move_piece(state.board, &black_from, &black_to);
+    compute_bitboards(state.board, &state.bitboards);
+    board copy;
+    memcpy(copy, state.board, sizeof(board));
+
+    const struct coord en_passant = MAKE_CONSTANT_COORD(D, 6);
+    struct move_undo undo;
+    make_move(state.board, &state.bitboards, &white_to, &en_passant, EMPTY_SQUARE, &undo);
+    cr_assert(undo.flags & MOVE_UNDO_EN_PASSANT);
+    cr_assert_eq(board_at_coord(state.board, black_to)->type, EMPTY_SQUARE);
+    cr_assert_eq(board_at_coord(state.board, en_passant)->type, PAWN);
+
+    unmake_move(state.board, &state.bitboards, &undo);
+    cr_assert(are_boards_equal(state.board, copy));
+    free_board_state(&state);
+}
+
+Test(apply_move, make_unmake_castling) {
+    struct board_state state = empty_board_state();
+    *board_at(state.board, F_FILE, RANK_1) = EMPTY_PIECE;
+    *board_at(state.board, G_FILE, RANK_1) = EMPTY_PIECE;
+    compute_bitboards(state.board, &state.bitboards);
+    board copy;
+    memcpy(copy, state.board, sizeof(board));
+
+    struct move_undo undo;
+    make_castling(state.board, &state.bitboards, WHITE, KINGSIDE, &undo);
+    cr_assert_eq(board_at(state.board, G_FILE, RANK_1)->type, KING);
+    cr_assert_eq(board_at(state.board, F_FILE, RANK_1)->type, ROOK);
+
+    unmake_move(state.board, &state.bitboards, &undo);
+    cr_assert(are_boards_equal(state.board, copy));
+    free_board_state(&state);
+}
+
+Test(apply_move, make_unmake_promotion) {
+    struct board_state state = empty_board_state();
+    const struct coord from = MAKE_CONSTANT_COORD(B, 7);
+    const struct coord to = MAKE_CONSTANT_COORD(A, 8);
+    *board_at_coord(state.board, from) = (struct piece) { .type = PAWN, .player = WHITE };
+    compute_bitboards(state.board, &state.bitboards);
+    board copy;
+    memcpy(copy, state.board, sizeof(board));
+
+    struct move_undo undo;
+    make_move(state.board, &state.bitboards, &from, &to, QUEEN, &undo);
+    cr_assert_eq(board_at_coord(state.board, to)->type, QUEEN);
+    cr_assert_eq(undo.captured.type, ROOK);
+    cr_assert(are_bitboards_in_sync(state.board, &state.bitboards));
+
+    unmake_move(state.board, &state.bitboards, &undo);
+    cr_assert(are_boards_equal(state.board, copy));
+    cr_assert(are_bitboards_in_sync(state.board, &state.bitboards));
+    free_board_state(&state);
+}
+
+Test(apply_move, packed_board) {
+    cr_assert_eq(sizeof(struct piece), 1);
+    cr_assert_eq(sizeof(board), BOARD_SIZE * BOARD_SIZE);
+    cr_assert_eq(EMPTY_PIECE.player, INVALID_PLAYER);
+}
+
+// the promotion is taken back by the alternative moves, then played again from the undo log once they end
+Test(apply_move, alternative_moves_replace_a_promotion) {
+    struct board_state state = empty_board_state();
+    *board_at(state.board, B_FILE, RANK_7) = (struct piece) { .type = PAWN, .player = WHITE };
+    compute_bitboards(state.board, &state.bitboards);
+    const struct pgn_token promotion = {
+        .type = PROMOTION,
+        .move.move = {
+            .player = WHITE,
+            .from = MAKE_CONSTANT_COORD(B, 7),
+            .to = MAKE_CONSTANT_COORD(A, 8),
+            .extra_infos.infos.pawn_infos = { .promoted = true, .promotion_piece = KNIGHT }
+        }
+    };
+    const struct pgn_token knight = { .type = MOVE_KNIGHT, .move.move = { .player = WHITE, .from = MAKE_CONSTANT_COORD(G, 1), .to = MAKE_CONSTANT_COORD(F, 3) } };
+    const struct pgn_token pawn = { .type = MOVE_PAWN, .move.move = { .player = BLACK, .from = MAKE_CONSTANT_COORD(E, 7), .to = MAKE_CONSTANT_COORD(E, 5) } };
+    cr_assert(apply_move(&promotion, &state));
+    next_turn(&state);
+    board copy;
+    memcpy(copy, state.board, sizeof(board));
+
+    cr_assert(board_start_alternative_moves(&state));
+    cr_assert_eq(board_at(state.board, B_FILE, RANK_7)->type, PAWN);
+    cr_assert(apply_move(&knight, &state));
+    next_turn(&state);
+    cr_assert(board_start_alternative_moves(&state));
+    cr_assert(apply_move(&knight, &state));
+    next_turn(&state);
+    cr_assert(apply_move(&pawn, &state));
+    next_turn(&state);
+    cr_assert_eq(state.undo_log.size, 3);
+    cr_assert(board_end_alternative_moves(&state));
+    cr_assert_eq(state.undo_log.size, 1);
+    cr_assert(board_end_alternative_moves(&state));
+
+    cr_assert_eq(state.undo_log.size, 0);
+    cr_assert(are_boards_equal(state.board, copy));
+    cr_assert(are_bitboards_in_sync(state.board, &state.bitboards));
+    cr_assert_eq(state.current_player, BLACK);
+    cr_assert_eq(board_at(state.board, A_FILE, RANK_8)->type, KNIGHT);
+    cr_assert(are_coords_equal(&state.last_move.to, &promotion.move.move.to));
+    free_board_state(&state);
+}
@@ -0,0 +1,33 @@
+#include <criterion/criterion.h>
+#include <stdint.h>
+#include <string.h>
+#include "../include/arena.h"
+
+Test(arena, aligned_allocations) {
+    struct arena arena;
+    arena_init(&arena);
+
+    for (size_t size = 1; size < 100; size++) {
+        unsigned char* const allocation = arena_alloc(&arena, size);
+        cr_assert_not_null(allocation);
+        cr_assert_eq((uintptr_t)allocation % ARENA_ALIGNMENT, 0);
+        memset(allocation, (int)size, size);
+    }
+    arena_free(&arena);
+    cr_assert_null(arena.chunk);
+}
+
+Test(arena, allocation_bigger_than_a_chunk) {
+    struct arena arena;
+    arena_init(&arena);
+
+    unsigned char* const small = arena_alloc(&arena, 8);
+    unsigned char* const big = arena_alloc(&arena, 3 * ARENA_CHUNK_SIZE);
+    cr_assert_not_null(small);
+    cr_assert_not_null(big);
+    memset(small, 1, 8);
+    memset(big, 2, 3 * ARENA_CHUNK_SIZE);
+    cr_assert_eq(small[7], 1);
+    cr_assert_eq(big[3 * ARENA_CHUNK_SIZE - 1], 2);
+    arena_free(&arena);
+}
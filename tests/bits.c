@@ -41,3 +41,42 @@ Test(bits, read) {
     cr_assert_eq(memchr_bits(&buf, 'E', &size), FALSE); // 'E' not found
     cr_assert_eq(size, 0, "Size is %zu instead of 0 !", size);
 }
+
+Test(bits, how_many_bits_to_hold_number) {
+    cr_assert_eq(how_many_bits_to_hold_number(0), 0);
+    cr_assert_eq(how_many_bits_to_hold_number(1), 1);
+    cr_assert_eq(how_many_bits_to_hold_number(2), 2);
+    cr_assert_eq(how_many_bits_to_hold_number(3), 2);
+    cr_assert_eq(how_many_bits_to_hold_number(4), 3);
+    cr_assert_eq(how_many_bits_to_hold_number(7), 3);
+    cr_assert_eq(how_many_bits_to_hold_number(8), 4);
+}
+
+Test(bits, write_then_read) {
+    struct bit_writer writer;
+    cr_assert(bit_writer_init(&writer));
+    cr_assert(write_bits(&writer, 3, 0x5));
+    cr_assert(write_bits(&writer, 64, 0x0123456789ABCDEF));
+    cr_assert(write_bits(&writer, 1, 1));
+    cr_assert(bit_writer_align(&writer));
+    cr_assert_eq(writer.n_bits, 72);
+
+    struct compressed_buf buf;
+    cr_assert(make_compressed_buf(&buf, writer.buf, writer.n_bits / 8));
+    uint64_t n;
+    cr_assert(read_bits(&buf, 3, &n));
+    cr_assert_eq(n, 0x5);
+    cr_assert(read_bits(&buf, 64, &n));
+    cr_assert_eq(n, 0x0123456789ABCDEF);
+    cr_assert_eq(bit_offset(&buf), 67);
+
+    struct bit_writer copy;
+    cr_assert(bit_writer_init(&copy));
+    cr_assert(copy_bits(&copy, &buf, 3, 64));
+    cr_assert(seek_bit_offset(&buf, 3));
+    cr_assert(make_compressed_buf(&buf, copy.buf, copy.n_bits / 8));
+    cr_assert(read_bits(&buf, 64, &n));
+    cr_assert_eq(n, 0x0123456789ABCDEF);
+    bit_writer_free(&copy);
+    bit_writer_free(&writer);
+}
@@ -0,0 +1,69 @@
+#include <criterion/criterion.h>
+#include "../include/checkpoint.h"
+#include "test_helpers.h"
+
+Test(checkpoint, table_round_trip) {
+    struct board_state state = empty_board_state();
+    struct checkpoint written[2];
+    make_checkpoint(&state, 0, 0, &written[0]);
+    play(&state, MOVE_PAWN, AT(E, 2), AT(E, 4));
+    play(&state, MOVE_PAWN, AT(D, 7), AT(D, 5));
+    play(&state, MOVE_PAWN, AT(E, 4), AT(D, 5));
+    make_checkpoint(&state, 3, 42, &written[1]);
+
+    struct bit_writer writer;
+    cr_assert(bit_writer_init(&writer));
+    cr_assert(write_checkpoint_table(&writer, written, 2));
+    cr_assert(bit_writer_align(&writer));
+
+    struct compressed_buf buf;
+    struct checkpoint* read = NULL;
+    size_t n_read = 0;
+    cr_assert(make_compressed_buf(&buf, writer.buf, writer.n_bits / 8));
+    cr_assert(read_checkpoint_table(&buf, &read, &n_read));
+    cr_assert_eq(n_read, 2);
+    for (size_t i = 0; i < n_read; i++) {
+        cr_assert_eq(read[i].ply, written[i].ply);
+        cr_assert_eq(read[i].bit_offset, written[i].bit_offset);
+        cr_assert_eq(read[i].castling_rights, written[i].castling_rights);
+        cr_assert_eq(read[i].en_passant_file, written[i].en_passant_file);
+        cr_assert(are_coords_equal(&read[i].last_move.from, &written[i].last_move.from));
+        cr_assert(are_coords_equal(&read[i].last_move.to, &written[i].last_move.to));
+        cr_assert(are_pieces_equal(&read[i].last_move.captured, &written[i].last_move.captured));
+        for (uint8_t rank = 0; rank < BOARD_SIZE; rank++) {
+            for (uint8_t file = 0; file < BOARD_SIZE; file++) {
+                cr_assert(are_pieces_equal(&read[i].board[rank][file], &written[i].board[rank][file]));
+            }
+        }
+    }
+
+    // the side to move comes from the ply, so black must be able to take back the capture
+    struct board_state restored;
+    restore_checkpoint(&read[1], &restored);
+    cr_assert_eq(restored.current_player, BLACK);
+    cr_assert_eq(restored.move_turn, 2);
+    cr_assert(board_start_alternative_moves(&restored));
+    cr_assert_eq(board_at_coord(restored.board, AT(D, 5))->player, BLACK);
+    cr_assert_eq(board_at_coord(restored.board, AT(E, 4))->type, PAWN);
+
+    free(read);
+    free_board_state(&restored);
+    free_board_state(&state);
+    bit_writer_free(&writer);
+}
+
+Test(checkpoint, compact_snapshot) {
+    struct board_state state = empty_board_state();
+    struct checkpoint checkpoint;
+    play(&state, MOVE_PAWN, AT(E, 2), AT(E, 4));
+    make_checkpoint(&state, 1, 12, &checkpoint);
+
+    struct bit_writer writer;
+    cr_assert(bit_writer_init(&writer));
+    cr_assert(write_checkpoint_table(&writer, &checkpoint, 1));
+    // the 32 pieces of the board, the en passant file and the last move fit in 26 bytes
+    cr_assert_leq(writer.n_bits - N_CHECKPOINTS_BITS, 26 * 8, "A checkpoint takes %zu bits !", writer.n_bits - N_CHECKPOINTS_BITS);
+
+    free_board_state(&state);
+    bit_writer_free(&writer);
+}
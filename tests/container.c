@@ -0,0 +1,65 @@
+#include <criterion/criterion.h>
+#include "../include/container.h"
+
+#define BLOCK_SIZE 3
+#define N_GAMES 3
+
+// 2 bytes games, so that the first block holds 2 of them and the second one the last
+static void write_blocks(struct bit_writer* writer) {
+    const struct container_header header = { .flags = CONTAINER_BLOCKS };
+    struct block_writer block = { 0 };
+
+    cr_assert(bit_writer_init(writer));
+    cr_assert(write_container_header(writer, &header));
+    for (int game = 0; game < N_GAMES; game++) {
+        cr_assert_eq(begin_block_game(writer, &block, BLOCK_SIZE), game != 1 ? TRUE : FALSE);
+        cr_assert(write_bits(writer, 16, game));
+    }
+    cr_assert(end_block(writer, &block));
+}
+
+static void assert_next_game(struct compressed_buf* buf, struct container_header* header, int game) {
+    uint64_t read;
+    cr_assert_eq(next_game(buf, header), TRUE);
+    cr_assert(read_bits(buf, 16, &read));
+    cr_assert_eq(read, game);
+}
+
+Test(container, blocks) {
+    struct bit_writer writer;
+    write_blocks(&writer);
+    cr_assert_eq(writer.n_bits / 8, 1 + N_GAMES * 2 + 2 * BLOCK_HEADER_SIZE);
+
+    struct compressed_buf buf;
+    struct container_header header;
+    cr_assert(make_compressed_buf(&buf, writer.buf, writer.n_bits / 8));
+    cr_assert(read_container_header(&buf, &header));
+    cr_assert_eq(header.flags, CONTAINER_BLOCKS);
+    for (int game = 0; game < N_GAMES; game++) {
+        assert_next_game(&buf, &header, game);
+    }
+    cr_assert_eq(next_game(&buf, &header), FALSE);
+    bit_writer_free(&writer);
+}
+
+Test(container, corrupted_block) {
+    struct bit_writer writer;
+    write_blocks(&writer);
+    writer.buf[1 + BLOCK_HEADER_SIZE] ^= 1; // first game
+
+    struct compressed_buf buf;
+    struct container_header header;
+    cr_assert(make_compressed_buf(&buf, writer.buf, writer.n_bits / 8));
+    cr_assert(read_container_header(&buf, &header));
+    cr_assert_eq(next_game(&buf, &header), ERROR);
+    assert_next_game(&buf, &header, 2);
+    cr_assert_eq(next_game(&buf, &header), FALSE);
+
+    // the last block is cut in the middle of its game
+    cr_assert(make_compressed_buf(&buf, writer.buf, writer.n_bits / 8 - 1));
+    cr_assert(read_container_header(&buf, &header));
+    cr_assert_eq(next_game(&buf, &header), ERROR);
+    cr_assert_eq(next_game(&buf, &header), ERROR);
+    cr_assert_eq(next_game(&buf, &header), FALSE);
+    bit_writer_free(&writer);
+}
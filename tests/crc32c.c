@@ -0,0 +1,20 @@
+#include <criterion/criterion.h>
+#include "../include/crc32c.h"
+
+Test(crc32c, check_value) {
+    cr_assert_eq(crc32c((const uint8_t*)"123456789", 9), 0xE3069283);
+    cr_assert_eq(crc32c(NULL, 0), 0);
+}
+
+Test(crc32c, same_as_portable) {
+    uint8_t data[100];
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = i * 37;
+    }
+    // every alignment and tail length of the 8 bytes steps
+    for (size_t start = 0; start < 8; start++) {
+        for (size_t size = 0; start + size <= sizeof(data); size++) {
+            cr_assert_eq(crc32c(data + start, size), crc32c_portable(data + start, size));
+        }
+    }
+}
@@ -0,0 +1,144 @@
+#include <criterion/criterion.h>
+#include "../include/decoder.h"
+#include "../include/encode.h"
+#include "test_helpers.h"
+
+static void write_game(struct bit_writer* writer, const struct pgn_token* game, size_t n_tokens, enum move_coding coding) {
+    const struct tag tags[] = {
+        { .name = "Event", .name_len = 5, .value = "Test", .value_len = 4 },
+        { .name = "Result", .name_len = 6, .value = "*", .value_len = 1 }
+    };
+    struct token_list tokens = { 0 };
+    for (size_t i = 0; i < n_tokens; i++) {
+        cr_assert(token_list_push(&tokens, &game[i]));
+    }
+    cr_assert(encode_game(writer, tags, sizeof(tags) / sizeof(tags[0]), &tokens, coding));
+    token_list_free(&tokens);
+}
+
+// 1. e4 e5 (1... c5 {Sicilian}) 2. Nf3 1-0, then 1. d4 d5 1/2-1/2
+static void write_games(struct bit_writer* writer, enum move_coding coding) {
+    const struct pgn_token first_game[] = {
+        move_token(MOVE_PAWN, WHITE, AT(E, 2), AT(E, 4)),
+        move_token(MOVE_PAWN, BLACK, AT(E, 7), AT(E, 5)),
+        { .type = ALTERNATIVE_MOVE, .move.alternative_moves_is_end = false },
+        move_token(MOVE_PAWN, BLACK, AT(C, 7), AT(C, 5)),
+        { .type = COMMENT, .move.comment = "Sicilian" },
+        { .type = ALTERNATIVE_MOVE, .move.alternative_moves_is_end = true },
+        move_token(MOVE_KNIGHT, WHITE, AT(G, 1), AT(F, 3)),
+        { .type = END_OF_THE_GAME, .move.winner = { .is_draw = false, .winner = WHITE } }
+    };
+    const struct pgn_token second_game[] = {
+        move_token(MOVE_PAWN, WHITE, AT(D, 2), AT(D, 4)),
+        move_token(MOVE_PAWN, BLACK, AT(D, 7), AT(D, 5)),
+        { .type = END_OF_THE_GAME, .move.winner = { .is_draw = true } }
+    };
+
+    cr_assert(bit_writer_init(writer));
+    write_game(writer, first_game, sizeof(first_game) / sizeof(first_game[0]), coding);
+    write_game(writer, second_game, sizeof(second_game) / sizeof(second_game[0]), coding);
+}
+
+static void read_games(enum move_coding coding) {
+    const enum token_type first_game[] = {
+        MOVE_PAWN, MOVE_PAWN, ALTERNATIVE_MOVE, MOVE_PAWN, COMMENT, ALTERNATIVE_MOVE, MOVE_KNIGHT, END_OF_THE_GAME
+    };
+    struct bit_writer writer;
+    struct decoder decoder;
+    struct pgn_token token;
+    const char* comment = NULL;
+    write_games(&writer, coding);
+    cr_assert(decoder_open(&decoder, writer.buf, writer.n_bits / 8));
+
+    cr_assert_eq(decoder_next_token(&decoder, &token), FALSE); // no game opened yet
+    cr_assert_eq(decoder_next_game(&decoder), TRUE);
+    for (size_t i = 0; i < sizeof(first_game) / sizeof(first_game[0]); i++) {
+        cr_assert_eq(decoder_next_token(&decoder, &token), TRUE);
+        cr_assert_eq(token.type, first_game[i], "Token %zu has type %d instead of %d !", i, token.type, first_game[i]);
+        if (token.type == COMMENT) {
+            comment = token.move.comment;
+        }
+    }
+    cr_assert_eq(decoder_next_token(&decoder, &token), FALSE);
+    cr_assert_str_eq(comment, "Sicilian"); // still alive until the next game
+
+    cr_assert_eq(decoder_next_game(&decoder), TRUE);
+    cr_assert_eq(decoder_next_token(&decoder, &token), TRUE);
+    cr_assert(are_coords_equal(&token.move.move.to, &AT(D, 4)));
+    cr_assert_eq(decoder_next_game(&decoder), FALSE); // the rest of the game is skipped
+    cr_assert_eq(decoder_next_token(&decoder, &token), FALSE);
+
+    decoder_close(&decoder);
+    bit_writer_free(&writer);
+}
+
+Test(decoder, next_token) {
+    read_games(PREFIX_CODING);
+    read_games(LEGAL_INDEX_CODING);
+    read_games(ARITHMETIC_CODING);
+}
+
+Test(decoder, malformed_game_ends_the_container) {
+    const uint8_t garbage[] = { VERSION_MOVE_CODING_MASK << VERSION_MOVE_CODING_SHIFT, 0 }; // unknown move coding
+    struct decoder decoder;
+    cr_assert(decoder_open(&decoder, garbage, sizeof(garbage)));
+    cr_assert_eq(decoder_next_game(&decoder), ERROR);
+    cr_assert_eq(decoder_next_game(&decoder), FALSE);
+    decoder_close(&decoder);
+}
+
+Test(decoder, invalid_end_of_the_game) {
+    struct bit_writer writer;
+    struct decoder decoder;
+    struct pgn_token token;
+    cr_assert(bit_writer_init(&writer));
+    cr_assert(write_bits(&writer, 8, make_version(PREFIX_CODING, false)));
+    cr_assert(write_bits(&writer, 8, '\0')); // no tags
+    cr_assert(write_bits(&writer, N_EN_PASSANT_BITS, 0));
+    cr_assert(write_bits(&writer, 5, END_OF_THE_GAME));
+    cr_assert(write_bits(&writer, 2, 3)); // no result has this code
+    cr_assert(bit_writer_align(&writer));
+
+    cr_assert(decoder_open(&decoder, writer.buf, writer.n_bits / 8));
+    cr_assert_eq(decoder_next_game(&decoder), TRUE);
+    cr_assert_eq(decoder_next_token(&decoder, &token), ERROR); // the process goes on
+    cr_assert_eq(decoder_next_game(&decoder), FALSE);
+    decoder_close(&decoder);
+    bit_writer_free(&writer);
+}
+
+Test(decoder, illegal_castling) {
+    struct pgn_token castling = { .type = CASTLING, .move.move = { .player = WHITE, .piece = KING } };
+    castling.move.move.extra_infos.infos.king_infos = (struct king_move_infos) { .is_castling = true, .castling = KINGSIDE };
+    // 1. e4 e5 2. Ke2 d6 3. O-O, the king has already moved
+    const struct pgn_token game[] = {
+        move_token(MOVE_PAWN, WHITE, AT(E, 2), AT(E, 4)),
+        move_token(MOVE_PAWN, BLACK, AT(E, 7), AT(E, 5)),
+        move_token(MOVE_KING, WHITE, AT(E, 1), AT(E, 2)),
+        move_token(MOVE_PAWN, BLACK, AT(D, 7), AT(D, 6)),
+        castling,
+        { .type = END_OF_THE_GAME, .move.winner = { .is_draw = true } }
+    };
+    struct bit_writer writer;
+    struct decoder decoder;
+    struct pgn_token token;
+    cr_assert(bit_writer_init(&writer));
+    write_game(&writer, game, sizeof(game) / sizeof(game[0]), PREFIX_CODING);
+
+    cr_assert(decoder_open(&decoder, writer.buf, writer.n_bits / 8));
+    cr_assert_eq(decoder_next_game(&decoder), TRUE);
+    for (size_t i = 0; i < 4; i++) {
+        cr_assert_eq(decoder_next_token(&decoder, &token), TRUE);
+    }
+    cr_assert_eq(decoder_next_token(&decoder, &token), ERROR);
+    cr_assert_eq(decoder_next_game(&decoder), FALSE); // the malformed game ends the container
+    decoder_close(&decoder);
+
+    bit_writer_clear(&writer);
+    write_game(&writer, &game[4], 2, PREFIX_CODING); // 1. O-O, through the bishop and the knight
+    cr_assert(decoder_open(&decoder, writer.buf, writer.n_bits / 8));
+    cr_assert_eq(decoder_next_game(&decoder), TRUE);
+    cr_assert_eq(decoder_next_token(&decoder, &token), ERROR);
+    decoder_close(&decoder);
+    bit_writer_free(&writer);
+}
@@ -0,0 +1,146 @@
+#include <criterion/criterion.h>
+#include <string.h>
+#include <unistd.h>
+#include "../include/container.h"
+#include "../include/dedup.h"
+#include "../include/encode.h"
+#include "../include/read.h"
+#include "../include/uncompress.h"
+#include "test_helpers.h"
+
+static const uint8_t TAGS[] = "Event\0Casual\0White\0Alice\0Black\0Bob\0";
+
+static void make_game(struct token_list* tokens, struct pgn_token* storage, const char* comment) {
+    storage[0] = (struct pgn_token) { .type = MOVE_PAWN, .move.move = { .player = WHITE, .piece = PAWN, .from = AT(E, 2), .to = AT(E, 4) } };
+    storage[1] = (struct pgn_token) { .type = COMMENT, .move.comment = (char*)comment };
+    storage[2] = (struct pgn_token) { .type = END_OF_THE_GAME, .move.winner = { .is_draw = true } };
+    *tokens = (struct token_list) { .tokens = storage, .n_tokens = 3, .max_tokens = 3 };
+}
+
+static bool are_hashes_equal(struct game_hash first, struct game_hash second) {
+    return first.high == second.high && first.low == second.low;
+}
+
+Test(dedup, hash_game) {
+    struct pgn_token first_storage[3];
+    struct pgn_token second_storage[3];
+    struct token_list first;
+    struct token_list second;
+    make_game(&first, first_storage, "Solid");
+    make_game(&second, second_storage, "Solid");
+    second_storage[0].move.move.check = CHECK; // not part of the normalized moves
+
+    cr_assert(are_hashes_equal(hash_game(&first, TAGS, sizeof(TAGS), NULL), hash_game(&second, NULL, 0, NULL)));
+    cr_assert(are_hashes_equal(hash_game(&first, TAGS, sizeof(TAGS), "Round"), hash_game(&first, NULL, 0, NULL)));
+    cr_assert(!are_hashes_equal(hash_game(&first, TAGS, sizeof(TAGS), "Event,White"), hash_game(&first, NULL, 0, NULL)));
+
+    second_storage[1].move.comment = "Dubious";
+    cr_assert(!are_hashes_equal(hash_game(&first, NULL, 0, NULL), hash_game(&second, NULL, 0, NULL)));
+}
+
+Test(dedup, find_or_add) {
+    struct dedup_set set;
+    cr_assert(dedup_set_init(&set));
+
+    // enough games to grow the set a few times
+    for (uint64_t game = 0; game < 4 * DEDUP_SET_INITIAL_SIZE; game++) {
+        uint64_t offset = game * 100;
+        cr_assert_eq(dedup_set_find_or_add(&set, (struct game_hash) { .high = game, .low = game * 7 }, &offset), FALSE);
+    }
+    for (uint64_t game = 0; game < 4 * DEDUP_SET_INITIAL_SIZE; game++) {
+        uint64_t offset = 0;
+        cr_assert_eq(dedup_set_find_or_add(&set, (struct game_hash) { .high = game, .low = game * 7 }, &offset), TRUE);
+        cr_assert_eq(offset, game * 100);
+    }
+    cr_assert_eq(set.n_entries, 4 * DEDUP_SET_INITIAL_SIZE);
+    dedup_set_free(&set);
+}
+
+static const struct tag FIRST_TAGS[] = { { .name = "Date", .name_len = 4, .value = "2024.01.01", .value_len = 10 } };
+static const struct tag SECOND_TAGS[] = { { .name = "Date", .name_len = 4, .value = "2025.02.02", .value_len = 10 } };
+static const uint8_t FIRST_TAG_BYTES[] = "Date\0" "2024.01.01\0"; // followed by the \0 ending the tags
+static const uint8_t SECOND_TAG_BYTES[] = "Date\0" "2025.02.02\0";
+
+// the games of the container at path, which must be two games with these tags, the second one being a duplicate if is_deduplicated
+static void check_tags(const char* path, bool is_deduplicated) {
+    size_t size;
+    unsigned char* const raw_buf = read_compressed_file(path, &size);
+    cr_assert_not_null(raw_buf);
+    struct compressed_buf buf;
+    struct container_header header = { 0 };
+    make_compressed_buf(&buf, raw_buf, size);
+    cr_assert(read_container_header(&buf, &header));
+    const struct uncompress_options options = { 0 };
+    struct game_layout layout;
+
+    cr_assert_eq(uncompress_game(&buf, &options, &layout, NULL, NULL), TRUE);
+    cr_assert_eq(layout.tags_end - layout.tags_start, 8 * sizeof(FIRST_TAG_BYTES));
+    cr_assert(memcmp(raw_buf + layout.tags_start / 8, FIRST_TAG_BYTES, sizeof(FIRST_TAG_BYTES)) == 0);
+
+    cr_assert_eq(raw_buf[bit_offset(&buf) / 8] == VERSION_DUPLICATE, is_deduplicated);
+    cr_assert_eq(uncompress_game(&buf, &options, &layout, NULL, NULL), TRUE);
+    cr_assert_eq(layout.tags_end - layout.tags_start, 8 * sizeof(SECOND_TAG_BYTES));
+    cr_assert(memcmp(raw_buf + layout.tags_start / 8, SECOND_TAG_BYTES, sizeof(SECOND_TAG_BYTES)) == 0);
+    cr_assert(is_buf_empty(&buf));
+
+    free_container_header(&header);
+    free(raw_buf);
+}
+
+static void make_temporary_file(char* path) {
+    const int fd = mkstemp(path);
+    cr_assert(fd >= 0);
+    close(fd);
+}
+
+Test(dedup, keeps_duplicate_tags) {
+    char input[] = "/tmp/dedup_input_XXXXXX";
+    char deduplicated[] = "/tmp/dedup_output_XXXXXX";
+    char expanded[] = "/tmp/dedup_expanded_XXXXXX";
+    make_temporary_file(input);
+    make_temporary_file(deduplicated);
+    make_temporary_file(expanded);
+
+    struct pgn_token storage[3];
+    struct token_list tokens;
+    struct bit_writer writer;
+    make_game(&tokens, storage, "Solid");
+    cr_assert(bit_writer_init(&writer));
+    cr_assert(encode_game(&writer, FIRST_TAGS, 1, &tokens, PREFIX_CODING));
+    cr_assert(encode_game(&writer, SECOND_TAGS, 1, &tokens, PREFIX_CODING));
+    cr_assert(bit_writer_save(&writer, input));
+    bit_writer_free(&writer);
+
+    // same moves, so the second game is a reference to the first one, but with its own date
+    const struct args dedup_args = { .transcode = "prefix", .dedup = true, .input = input, .output = deduplicated };
+    cr_assert_eq(transcode(&dedup_args), EXIT_SUCCESS);
+    check_tags(deduplicated, true);
+
+    // the duplicate is written again as a whole game, still with its own date
+    const struct args expand_args = { .transcode = "prefix", .input = deduplicated, .output = expanded };
+    cr_assert_eq(transcode(&expand_args), EXIT_SUCCESS);
+    check_tags(expanded, false);
+
+    remove(input);
+    remove(deduplicated);
+    remove(expanded);
+}
+
+Test(dedup, full_set) {
+    struct dedup_set set;
+    cr_assert(dedup_set_init(&set));
+    set.max_entries = 4;
+
+    for (uint64_t game = 0; game < 4; game++) {
+        uint64_t offset = game;
+        cr_assert_eq(dedup_set_find_or_add(&set, (struct game_hash) { .high = game, .low = game }, &offset), FALSE);
+    }
+    uint64_t offset = 4;
+    cr_assert_eq(dedup_set_find_or_add(&set, (struct game_hash) { .high = 4, .low = 4 }, &offset), ERROR);
+    cr_assert_eq(dedup_set_find_or_add(&set, (struct game_hash) { .high = 2, .low = 2 }, &offset), TRUE); // still found
+    cr_assert_eq(offset, 2);
+
+    dedup_set_clear(&set); // a new block
+    cr_assert_eq(dedup_set_find_or_add(&set, (struct game_hash) { .high = 4, .low = 4 }, &offset), FALSE);
+    dedup_set_free(&set);
+}
@@ -0,0 +1,238 @@
+#include <criterion/criterion.h>
+#include "../include/encode.h"
+#include "../include/legal_index.h"
+#include "../include/uncompress.h"
+#include "test_helpers.h"
+
+// 1. e4 e5 (1... c5 {Sicilian}) 2. Nf3 $1 1-0
+static void make_game(struct token_list* tokens) {
+    const struct pgn_token game[] = {
+        move_token(MOVE_PAWN, WHITE, AT(E, 2), AT(E, 4)),
+        move_token(MOVE_PAWN, BLACK, AT(E, 7), AT(E, 5)),
+        { .type = ALTERNATIVE_MOVE, .move.alternative_moves_is_end = false },
+        move_token(MOVE_PAWN, BLACK, AT(C, 7), AT(C, 5)),
+        { .type = COMMENT, .move.comment = "Sicilian" },
+        { .type = ALTERNATIVE_MOVE, .move.alternative_moves_is_end = true },
+        move_token(MOVE_KNIGHT, WHITE, AT(G, 1), AT(F, 3)),
+        { .type = NAG, .move.nag = 1 },
+        { .type = END_OF_THE_GAME, .move.winner = { .is_draw = false, .winner = WHITE } }
+    };
+    for (size_t i = 0; i < sizeof(game) / sizeof(game[0]); i++) {
+        cr_assert(token_list_push(tokens, &game[i]));
+    }
+}
+
+// 1. e4 e5 (1... c5 2. Nf3 (2. Nc3 Nc6) 2... d6) 2. Nf3 Nc6 (2... d6 (2... f6)) 3. Bb5 1-0
+static void make_nested_game(struct token_list* tokens) {
+    const struct pgn_token start = { .type = ALTERNATIVE_MOVE, .move.alternative_moves_is_end = false };
+    const struct pgn_token end = { .type = ALTERNATIVE_MOVE, .move.alternative_moves_is_end = true };
+    const struct pgn_token game[] = {
+        move_token(MOVE_PAWN, WHITE, AT(E, 2), AT(E, 4)),
+        move_token(MOVE_PAWN, BLACK, AT(E, 7), AT(E, 5)),
+        start,
+        move_token(MOVE_PAWN, BLACK, AT(C, 7), AT(C, 5)),
+        move_token(MOVE_KNIGHT, WHITE, AT(G, 1), AT(F, 3)),
+        start,
+        move_token(MOVE_KNIGHT, WHITE, AT(B, 1), AT(C, 3)),
+        move_token(MOVE_KNIGHT, BLACK, AT(B, 8), AT(C, 6)),
+        end,
+        move_token(MOVE_PAWN, BLACK, AT(D, 7), AT(D, 6)),
+        end,
+        move_token(MOVE_KNIGHT, WHITE, AT(G, 1), AT(F, 3)),
+        move_token(MOVE_KNIGHT, BLACK, AT(B, 8), AT(C, 6)),
+        start,
+        move_token(MOVE_PAWN, BLACK, AT(D, 7), AT(D, 6)),
+        start,
+        move_token(MOVE_PAWN, BLACK, AT(F, 7), AT(F, 6)),
+        end,
+        end,
+        move_token(MOVE_BISHOP, WHITE, AT(F, 1), AT(B, 5)),
+        { .type = END_OF_THE_GAME, .move.winner = { .is_draw = false, .winner = WHITE } }
+    };
+    for (size_t i = 0; i < sizeof(game) / sizeof(game[0]); i++) {
+        cr_assert(token_list_push(tokens, &game[i]));
+    }
+}
+
+// 1. a4 a5 2. h4 h5 3. Ra3 Ra6 4. Rh3 Rh6 5. a move of the rook on a3 1-0
+static void make_rook_game(struct token_list* tokens, struct coord to) {
+    const struct pgn_token game[] = {
+        move_token(MOVE_PAWN, WHITE, AT(A, 2), AT(A, 4)),
+        move_token(MOVE_PAWN, BLACK, AT(A, 7), AT(A, 5)),
+        move_token(MOVE_PAWN, WHITE, AT(H, 2), AT(H, 4)),
+        move_token(MOVE_PAWN, BLACK, AT(H, 7), AT(H, 5)),
+        move_token(MOVE_ROOK, WHITE, AT(A, 1), AT(A, 3)),
+        move_token(MOVE_ROOK, BLACK, AT(A, 8), AT(A, 6)),
+        move_token(MOVE_ROOK, WHITE, AT(H, 1), AT(H, 3)),
+        move_token(MOVE_ROOK, BLACK, AT(H, 8), AT(H, 6)),
+        move_token(MOVE_ROOK, WHITE, AT(A, 3), to),
+        { .type = END_OF_THE_GAME, .move.winner = { .is_draw = false, .winner = WHITE } }
+    };
+    for (size_t i = 0; i < sizeof(game) / sizeof(game[0]); i++) {
+        cr_assert(token_list_push(tokens, &game[i]));
+    }
+}
+
+// the rook on h3 can go to d3 too
+static void make_ambiguous_game(struct token_list* tokens) {
+    make_rook_game(tokens, AT(D, 3));
+}
+
+static size_t count_move_bits(const struct token_list* tokens, enum move_coding coding) {
+    struct bit_writer writer;
+    cr_assert(bit_writer_init(&writer));
+    cr_assert(encode_moves(&writer, tokens, 0, coding, NULL, false));
+    const size_t n_bits = writer.n_bits;
+    bit_writer_free(&writer);
+    return n_bits;
+}
+
+static void write_game(struct bit_writer* writer, const struct token_list* tokens, enum move_coding coding, const struct token_huffman* huffman, bool variation_lengths) {
+    cr_assert(bit_writer_init(writer));
+    cr_assert(write_bits(writer, 8, make_version(coding, false) | (huffman != NULL ? VERSION_HUFFMAN_TOKENS : 0)));
+    cr_assert(write_bits(writer, 8, '\0')); // no tags
+    cr_assert(write_bits(writer, N_EN_PASSANT_BITS, 0));
+    cr_assert(encode_moves(writer, tokens, 0, coding, huffman, variation_lengths));
+    cr_assert(bit_writer_align(writer));
+}
+
+static void encode_then_decode_game(void (*make)(struct token_list* tokens), enum move_coding coding, const struct token_huffman* huffman, bool variation_lengths) {
+    struct token_list written = { 0 };
+    struct token_list read = { 0 };
+    struct bit_writer writer;
+    make(&written);
+    write_game(&writer, &written, coding, huffman, variation_lengths);
+
+    struct compressed_buf buf;
+    const struct uncompress_options options = {
+        .on_token = record_token,
+        .token_data = &read,
+        .huffman = huffman,
+        .variation_lengths = variation_lengths
+    };
+    cr_assert(make_compressed_buf(&buf, writer.buf, writer.n_bits / 8));
+    cr_assert_eq(uncompress_game(&buf, &options, NULL, NULL, NULL), TRUE);
+    cr_assert_not(has_next_game(&buf));
+
+    cr_assert_eq(read.n_tokens, written.n_tokens);
+    for (size_t i = 0; i < read.n_tokens; i++) {
+        const struct pgn_token* const expected = &written.tokens[i];
+        const struct pgn_token* const actual = &read.tokens[i];
+        cr_assert_eq(actual->type, expected->type, "Token %zu has type %d instead of %d !", i, actual->type, expected->type);
+        if (is_token_a_move(expected->type)) {
+            cr_assert(are_coords_equal(&actual->move.move.from, &expected->move.move.from));
+            cr_assert(are_coords_equal(&actual->move.move.to, &expected->move.move.to));
+        } else if (expected->type == COMMENT) {
+            cr_assert_str_eq(actual->move.comment, expected->move.comment);
+        } else if (expected->type == ALTERNATIVE_MOVE) {
+            cr_assert_eq(actual->move.alternative_moves_is_end, expected->move.alternative_moves_is_end);
+        }
+    }
+
+    token_list_free(&written);
+    token_list_free(&read);
+    bit_writer_free(&writer);
+}
+
+static void encode_then_decode(enum move_coding coding, const struct token_huffman* huffman, bool variation_lengths) {
+    encode_then_decode_game(make_game, coding, huffman, variation_lengths);
+}
+
+Test(encode, prefix_round_trip) {
+    encode_then_decode(PREFIX_CODING, NULL, false);
+}
+
+Test(encode, legal_index_round_trip) {
+    encode_then_decode(LEGAL_INDEX_CODING, NULL, false);
+}
+
+Test(encode, legal_index_bits) {
+    cr_assert_eq(legal_index_bits(0), 3); // only the special indices
+    cr_assert_eq(legal_index_bits(20), 5); // starting position
+    cr_assert_eq(legal_index_bits(27), 5);
+    cr_assert_eq(legal_index_bits(28), 6);
+}
+
+Test(encode, arithmetic_round_trip) {
+    encode_then_decode(ARITHMETIC_CODING, NULL, false);
+}
+
+Test(encode, destination_round_trip) {
+    encode_then_decode(DESTINATION_CODING, NULL, false);
+}
+
+Test(encode, disambiguation_bits) {
+    struct token_list ambiguous = { 0 };
+    struct token_list unambiguous = { 0 };
+    make_ambiguous_game(&ambiguous);
+    make_rook_game(&unambiguous, AT(A, 1));
+
+    // Ra1 and Rad3 have the same type and destination bits, only Rad3 has to tell which of the 2 rooks moves, in 1 bit
+    cr_assert_eq(count_move_bits(&ambiguous, PREFIX_CODING), count_move_bits(&unambiguous, PREFIX_CODING) + 1);
+    cr_assert_eq(count_move_bits(&ambiguous, DESTINATION_CODING), count_move_bits(&unambiguous, DESTINATION_CODING) + 1);
+    encode_then_decode_game(make_ambiguous_game, PREFIX_CODING, NULL, false);
+    encode_then_decode_game(make_ambiguous_game, DESTINATION_CODING, NULL, false);
+
+    token_list_free(&ambiguous);
+    token_list_free(&unambiguous);
+}
+
+Test(encode, huffman_round_trip) {
+    struct token_huffman huffman;
+    const uint64_t frequencies[N_TOKEN_SYMBOLS] = { [5] = 100, [3] = 20, [9] = 10, [10] = 5 }; // pawns, knights, alternative moves and NAGs
+    token_huffman_from_frequencies(&huffman, frequencies);
+
+    encode_then_decode(PREFIX_CODING, &huffman, false);
+    encode_then_decode(DESTINATION_CODING, &huffman, false);
+}
+
+Test(encode, variation_lengths_round_trip) {
+    encode_then_decode(PREFIX_CODING, NULL, true);
+    encode_then_decode(LEGAL_INDEX_CODING, NULL, true);
+    encode_then_decode(DESTINATION_CODING, NULL, true);
+}
+
+Test(encode, nested_alternative_moves_round_trip) {
+    for (enum move_coding coding = 0; coding < N_MOVE_CODINGS; coding++) {
+        encode_then_decode_game(make_nested_game, coding, NULL, false);
+        if (coding != ARITHMETIC_CODING) {
+            encode_then_decode_game(make_nested_game, coding, NULL, true);
+        }
+    }
+}
+
+static void decode_main_line(enum move_coding coding, bool variation_lengths) {
+    const enum token_type main_line[] = { MOVE_PAWN, MOVE_PAWN, MOVE_KNIGHT, NAG, END_OF_THE_GAME };
+    struct token_list written = { 0 };
+    struct token_list read = { 0 };
+    struct bit_writer writer;
+    make_game(&written);
+    write_game(&writer, &written, coding, NULL, variation_lengths);
+
+    struct compressed_buf buf;
+    const struct uncompress_options options = {
+        .on_token = record_token,
+        .token_data = &read,
+        .variation_lengths = variation_lengths,
+        .mainline_only = true
+    };
+    cr_assert(make_compressed_buf(&buf, writer.buf, writer.n_bits / 8));
+    cr_assert_eq(uncompress_game(&buf, &options, NULL, NULL, NULL), TRUE);
+    cr_assert_not(has_next_game(&buf));
+
+    cr_assert_eq(read.n_tokens, sizeof(main_line) / sizeof(main_line[0]));
+    for (size_t i = 0; i < read.n_tokens; i++) {
+        cr_assert_eq(read.tokens[i].type, main_line[i], "Token %zu has type %d instead of %d !", i, read.tokens[i].type, main_line[i]);
+    }
+
+    token_list_free(&written);
+    token_list_free(&read);
+    bit_writer_free(&writer);
+}
+
+Test(encode, mainline_only) {
+    decode_main_line(PREFIX_CODING, true); // skipped
+    decode_main_line(LEGAL_INDEX_CODING, true);
+    decode_main_line(PREFIX_CODING, false); // parsed quietly
+    decode_main_line(ARITHMETIC_CODING, false);
+}
@@ -0,0 +1,99 @@
+#include <criterion/criterion.h>
+#include "../include/encode.h"
+#include "../include/game_tree.h"
+#include "test_helpers.h"
+
+// 1. e4 e5 (1... c5 {Sicilian} 2. Nf3 (2. Nc3)) (1... e6) 2. Nf3 1-0
+static void write_game(struct bit_writer* writer, enum move_coding coding) {
+    const struct pgn_token start = { .type = ALTERNATIVE_MOVE, .move.alternative_moves_is_end = false };
+    const struct pgn_token end = { .type = ALTERNATIVE_MOVE, .move.alternative_moves_is_end = true };
+    const struct pgn_token game[] = {
+        move_token(MOVE_PAWN, WHITE, AT(E, 2), AT(E, 4)),
+        move_token(MOVE_PAWN, BLACK, AT(E, 7), AT(E, 5)),
+        start,
+        move_token(MOVE_PAWN, BLACK, AT(C, 7), AT(C, 5)),
+        { .type = COMMENT, .move.comment = "Sicilian" },
+        move_token(MOVE_KNIGHT, WHITE, AT(G, 1), AT(F, 3)),
+        start,
+        move_token(MOVE_KNIGHT, WHITE, AT(B, 1), AT(C, 3)),
+        end,
+        end,
+        start,
+        move_token(MOVE_PAWN, BLACK, AT(E, 7), AT(E, 6)),
+        end,
+        move_token(MOVE_KNIGHT, WHITE, AT(G, 1), AT(F, 3)),
+        { .type = END_OF_THE_GAME, .move.winner = { .is_draw = false, .winner = WHITE } }
+    };
+    struct token_list tokens = { 0 };
+    for (size_t i = 0; i < sizeof(game) / sizeof(game[0]); i++) {
+        cr_assert(token_list_push(&tokens, &game[i]));
+    }
+
+    cr_assert(bit_writer_init(writer));
+    cr_assert(write_bits(writer, 8, make_version(coding, false)));
+    cr_assert(write_bits(writer, 8, '\0')); // no tags
+    cr_assert(write_bits(writer, N_EN_PASSANT_BITS, 0));
+    cr_assert(encode_moves(writer, &tokens, 0, coding, NULL, false));
+    cr_assert(bit_writer_align(writer));
+    token_list_free(&tokens);
+}
+
+static void assert_move_to(const struct game_node* node, struct coord to) {
+    cr_assert_not_null(node);
+    cr_assert(is_token_a_move(node->token.type));
+    cr_assert(are_coords_equal(&node->token.move.move.to, &to));
+}
+
+static void build_tree(enum move_coding coding) {
+    struct bit_writer writer;
+    write_game(&writer, coding);
+
+    struct compressed_buf buf;
+    struct game_tree tree;
+    const struct uncompress_options options = { 0 };
+    cr_assert(make_compressed_buf(&buf, writer.buf, writer.n_bits / 8));
+    cr_assert_eq(uncompress_game_tree(&buf, &options, NULL, &tree), TRUE);
+    cr_assert_not(has_next_game(&buf));
+    cr_assert_eq(tree.n_nodes, 9);
+
+    const struct game_node* const e5 = tree.main_line->next;
+    assert_move_to(tree.main_line, AT(E, 4));
+    assert_move_to(e5, AT(E, 5));
+    assert_move_to(e5->next, AT(F, 3));
+    cr_assert_eq(e5->next->next->token.type, END_OF_THE_GAME);
+    cr_assert_null(e5->next->next->next);
+
+    const struct game_node* const c5 = e5->variations;
+    assert_move_to(c5, AT(C, 5));
+    cr_assert_eq(c5->next->token.type, COMMENT);
+    cr_assert_str_eq(c5->next->token.move.comment, "Sicilian");
+    assert_move_to(c5->next->next, AT(F, 3));
+    assert_move_to(c5->next->next->variations, AT(C, 3));
+    assert_move_to(c5->next_variation, AT(E, 6));
+    cr_assert_null(c5->next_variation->next_variation);
+    cr_assert_null(c5->next_variation->next);
+
+    game_tree_free(&tree);
+    bit_writer_free(&writer);
+}
+
+Test(game_tree, nested_alternative_moves) {
+    build_tree(PREFIX_CODING);
+    build_tree(ARITHMETIC_CODING);
+}
+
+Test(game_tree, mainline_only) {
+    struct bit_writer writer;
+    write_game(&writer, LEGAL_INDEX_CODING);
+
+    struct compressed_buf buf;
+    struct game_tree tree;
+    const struct uncompress_options options = { .mainline_only = true };
+    cr_assert(make_compressed_buf(&buf, writer.buf, writer.n_bits / 8));
+    cr_assert_eq(uncompress_game_tree(&buf, &options, NULL, &tree), TRUE);
+    cr_assert_eq(tree.n_nodes, 4);
+    cr_assert_null(tree.main_line->next->variations);
+
+    game_tree_free(&tree);
+    bit_writer_free(&writer);
+}
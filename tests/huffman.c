@@ -0,0 +1,67 @@
+#include <criterion/criterion.h>
+#include "../include/huffman.h"
+
+Test(huffman, frequent_symbols_are_shorter) {
+    struct token_huffman huffman;
+    uint64_t frequencies[N_TOKEN_SYMBOLS] = { 0 };
+    frequencies[token_symbol(MOVE_PAWN)] = 1000;
+    frequencies[token_symbol(MOVE_KNIGHT)] = 300;
+    frequencies[token_symbol(MOVE_KING)] = 20;
+    token_huffman_from_frequencies(&huffman, frequencies);
+
+    const uint8_t pawn = huffman.lengths[token_symbol(MOVE_PAWN)];
+    cr_assert_eq(pawn, 1);
+    cr_assert_lt(huffman.lengths[token_symbol(MOVE_KNIGHT)], huffman.lengths[token_symbol(MOVE_KING)]);
+    for (uint8_t symbol = 0; symbol < N_TOKEN_SYMBOLS; symbol++) {
+        cr_assert_leq(huffman.lengths[symbol], MAX_TOKEN_CODE_LENGTH);
+    }
+}
+
+Test(huffman, lengths_are_limited) {
+    struct token_huffman huffman;
+    uint64_t frequencies[N_TOKEN_SYMBOLS];
+    for (uint8_t symbol = 0; symbol < N_TOKEN_SYMBOLS; symbol++) {
+        frequencies[symbol] = (uint64_t)1 << (3 * symbol); // would need 11 bits codes
+    }
+    token_huffman_from_frequencies(&huffman, frequencies);
+
+    for (uint8_t symbol = 0; symbol < N_TOKEN_SYMBOLS; symbol++) {
+        cr_assert_leq(huffman.lengths[symbol], MAX_TOKEN_CODE_LENGTH);
+    }
+}
+
+Test(huffman, invalid_lengths) {
+    struct token_huffman huffman;
+    const uint8_t too_short[N_TOKEN_SYMBOLS] = { 1, 1, 1, 4, 4, 4, 4, 4, 4, 4, 4, 4 };
+    const uint8_t incomplete[N_TOKEN_SYMBOLS] = { 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4 };
+    cr_assert_not(token_huffman_from_lengths(&huffman, too_short));
+    cr_assert_not(token_huffman_from_lengths(&huffman, incomplete));
+}
+
+Test(huffman, write_then_read) {
+    struct token_huffman written;
+    struct token_huffman read;
+    const uint8_t lengths[N_TOKEN_SYMBOLS] = { 5, 4, 4, 3, 4, 1, 5, 6, 6, 5, 5, 5 };
+    cr_assert(token_huffman_from_lengths(&written, lengths));
+
+    struct bit_writer writer;
+    cr_assert(bit_writer_init(&writer));
+    cr_assert(write_token_huffman(&writer, &written));
+    for (uint8_t symbol = 0; symbol < N_TOKEN_SYMBOLS; symbol++) {
+        cr_assert(write_token_type(&writer, &written, TOKEN_SYMBOLS[symbol]));
+    }
+    const size_t n_bits = writer.n_bits;
+    cr_assert(bit_writer_align(&writer));
+
+    struct compressed_buf buf;
+    cr_assert(make_compressed_buf(&buf, writer.buf, writer.n_bits / 8));
+    cr_assert(read_token_huffman(&buf, &read));
+    for (uint8_t symbol = 0; symbol < N_TOKEN_SYMBOLS; symbol++) {
+        enum token_type type;
+        cr_assert_eq(read.lengths[symbol], lengths[symbol]);
+        cr_assert(read_token_type(&buf, &read, &type));
+        cr_assert_eq(type, TOKEN_SYMBOLS[symbol]);
+    }
+    cr_assert_eq(bit_offset(&buf), n_bits);
+    bit_writer_free(&writer);
+}
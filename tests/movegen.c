@@ -0,0 +1,194 @@
+#include <criterion/criterion.h>
+#include <ctype.h>
+#include "../include/apply_move.h"
+#include "../include/movegen.h"
+
+static enum piece_type piece_from_char(char c) {
+    switch (toupper(c)) {
+        case 'K': return KING;
+        case 'Q': return QUEEN;
+        case 'B': return BISHOP;
+        case 'N': return KNIGHT;
+        case 'R': return ROOK;
+        case 'P': return PAWN;
+        default: return EMPTY_SQUARE;
+    }
+}
+
+// only reads the piece placement field of a FEN
+static void board_from_placement(board board, const char* placement) {
+    int rank = BOARD_SIZE - 1;
+    int file = 0;
+
+    for (; *placement && *placement != ' '; placement++) {
+        if (*placement == '/') {
+            rank--;
+            file = 0;
+        } else if (isdigit(*placement)) {
+            for (int i = 0; i < *placement - '0'; i++) {
+                board[rank][file++] = EMPTY_PIECE;
+            }
+        } else {
+            board[rank][file++] = (struct piece) {
+                .type = piece_from_char(*placement),
+                .player = isupper(*placement) ? WHITE : BLACK
+            };
+        }
+    }
+}
+
+// the bitboards are only computed at the root, moves then update them incrementally
+static uint64_t perft_impl(board board, struct bitboards* bitboards, enum player player, uint8_t castling_rights, int en_passant_file, unsigned depth) {
+    struct legal_move moves[MAX_LEGAL_MOVES];
+    const uint8_t n_moves = generate_legal_moves(bitboards, player, castling_rights, en_passant_file, moves);
+
+    if (depth == 1) {
+        return n_moves;
+    }
+    uint64_t count = 0;
+    for (uint8_t i = 0; i < n_moves; i++) {
+        struct move_undo undo;
+        make_legal_move(board, bitboards, &moves[i], &undo);
+        count += perft_impl(board, bitboards, opponent_player(player), castling_rights_after(castling_rights, &undo), en_passant_file_after(board, &undo), depth - 1);
+        unmake_move(board, bitboards, &undo);
+    }
+    return count;
+}
+
+static uint64_t perft(board board, enum player player, uint8_t castling_rights, int en_passant_file, unsigned depth) {
+    struct bitboards bitboards;
+    compute_bitboards(board, &bitboards);
+    return perft_impl(board, &bitboards, player, castling_rights, en_passant_file, depth);
+}
+
+Test(movegen, perft_starting_position) {
+    struct board_state state = empty_board_state();
+
+    cr_assert_eq(perft(state.board, WHITE, ALL_CASTLING_RIGHTS, INVALID_COORD, 1), 20);
+    cr_assert_eq(perft(state.board, WHITE, ALL_CASTLING_RIGHTS, INVALID_COORD, 2), 400);
+    cr_assert_eq(perft(state.board, WHITE, ALL_CASTLING_RIGHTS, INVALID_COORD, 3), 8902);
+    cr_assert_eq(perft(state.board, WHITE, ALL_CASTLING_RIGHTS, INVALID_COORD, 4), 197281);
+    free_board_state(&state);
+}
+
+// "Kiwipete" position, full of pins, castling, en passant and promotions
+Test(movegen, perft_kiwipete) {
+    board board;
+    board_from_placement(board, "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R");
+
+    cr_assert_eq(perft(board, WHITE, ALL_CASTLING_RIGHTS, INVALID_COORD, 1), 48);
+    cr_assert_eq(perft(board, WHITE, ALL_CASTLING_RIGHTS, INVALID_COORD, 2), 2039);
+    cr_assert_eq(perft(board, WHITE, ALL_CASTLING_RIGHTS, INVALID_COORD, 3), 97862);
+}
+
+Test(movegen, perft_en_passant_pins) {
+    board board;
+    board_from_placement(board, "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8");
+
+    cr_assert_eq(perft(board, WHITE, 0, INVALID_COORD, 1), 14);
+    cr_assert_eq(perft(board, WHITE, 0, INVALID_COORD, 2), 191);
+    cr_assert_eq(perft(board, WHITE, 0, INVALID_COORD, 3), 2812);
+    cr_assert_eq(perft(board, WHITE, 0, INVALID_COORD, 4), 43238);
+}
+
+static uint8_t count_castlings(const struct bitboards* bitboards, enum player player, uint8_t castling_rights) {
+    struct legal_move moves[MAX_LEGAL_MOVES];
+    const uint8_t n_moves = generate_legal_moves(bitboards, player, castling_rights, INVALID_COORD, moves);
+    uint8_t count = 0;
+
+    for (uint8_t i = 0; i < n_moves; i++) {
+        count += moves[i].is_castling;
+    }
+    return count;
+}
+
+Test(movegen, castling_rights) {
+    board board;
+    board_from_placement(board, "r3k2r/8/8/8/8/8/8/R3K2R");
+    struct bitboards bitboards;
+    compute_bitboards(board, &bitboards);
+    uint8_t castling_rights = ALL_CASTLING_RIGHTS;
+    cr_assert_eq(count_castlings(&bitboards, WHITE, castling_rights), 2);
+
+    // the white king goes to f1 and comes back, the board is the same but white cannot castle anymore
+    const struct coord e1 = { .file = 4, .rank = 0 };
+    const struct coord f1 = { .file = 5, .rank = 0 };
+    struct move_undo undo;
+    make_move(board, &bitboards, &e1, &f1, EMPTY_SQUARE, &undo);
+    castling_rights = castling_rights_after(castling_rights, &undo);
+    make_move(board, &bitboards, &f1, &e1, EMPTY_SQUARE, &undo);
+    castling_rights = castling_rights_after(castling_rights, &undo);
+    cr_assert_eq(count_castlings(&bitboards, WHITE, castling_rights), 0);
+    cr_assert_eq(count_castlings(&bitboards, BLACK, castling_rights), 2);
+
+    // only the queenside right is left once the h8 rook has moved
+    cr_assert_eq(count_castlings(&bitboards, BLACK, castling_rights & ~CASTLING_RIGHT(BLACK, KINGSIDE)), 1);
+}
+
+Test(movegen, checkmate) {
+    board board;
+    board_from_placement(board, "rnbqkbnr/ppppp2p/5p2/6pQ/4P3/7P/PPPP1PP1/RNB1KBNR");
+
+    struct bitboards bitboards;
+    compute_bitboards(board, &bitboards);
+
+    cr_assert_eq(is_player_checked(&bitboards, BLACK, true, INVALID_COORD), CHECKMATE);
+    cr_assert_eq(is_player_checked(&bitboards, WHITE, true, INVALID_COORD), NO_CHECK);
+}
+
+Test(movegen, disambiguation_candidates) {
+    board board;
+    board_from_placement(board, "4k3/8/8/1N3N2/4Pp2/1N6/6P1/4K3");
+    struct bitboards bitboards;
+    compute_bitboards(board, &bitboards);
+    struct coord to = { .file = 3, .rank = 3 }; // d4
+    struct coord coords[MAX_PIECES_TO_GO_TO_SAME_SQUARE];
+
+    cr_assert_eq(count_how_many_pieces_of_same_type_can_move_to_square(&bitboards, WHITE, KNIGHT, &to, coords), 3);
+    cr_assert_eq(coords[0].file, 1); // b3
+    cr_assert_eq(coords[0].rank, 2);
+    cr_assert_eq(coords[1].file, 1); // b5
+    cr_assert_eq(coords[1].rank, 4);
+    cr_assert_eq(coords[2].file, 5); // f5
+    cr_assert_eq(coords[2].rank, 4);
+
+    to = (struct coord) { .file = 6, .rank = 3 }; // g4, double push
+    cr_assert_eq(count_how_many_pieces_of_same_type_can_move_to_square(&bitboards, WHITE, PAWN, &to, coords), 1);
+    cr_assert_eq(coords[0].rank, 1);
+    to = (struct coord) { .file = 4, .rank = 2 }; // e3, en passant
+    cr_assert_eq(count_how_many_pieces_of_same_type_can_move_to_square(&bitboards, BLACK, PAWN, &to, coords), 1);
+    to = (struct coord) { .file = 6, .rank = 2 }; // g3, no white pawn to capture
+    cr_assert_eq(count_how_many_pieces_of_same_type_can_move_to_square(&bitboards, BLACK, PAWN, &to, coords), 0);
+    to = (struct coord) { .file = 5, .rank = 2 }; // f3, push
+    cr_assert_eq(count_how_many_pieces_of_same_type_can_move_to_square(&bitboards, BLACK, PAWN, &to, coords), 1);
+}
+
+// every destination of the legal moves, and only the squares disambiguation knows a candidate for
+Test(movegen, move_destinations) {
+    board board;
+    board_from_placement(board, "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R");
+    struct bitboards bitboards;
+    compute_bitboards(board, &bitboards);
+    struct legal_move moves[MAX_LEGAL_MOVES];
+    const uint8_t n_moves = generate_legal_moves(&bitboards, WHITE, ALL_CASTLING_RIGHTS, INVALID_COORD, moves);
+
+    for (enum piece_type piece = KING; piece < N_PIECE_TYPES; piece++) {
+        const bitboard destinations = move_destinations(&bitboards, WHITE, piece, INVALID_COORD);
+        for (uint8_t square = 0; square < N_SQUARES; square++) {
+            const bool has_candidate = pieces_able_to_move_to(&bitboards, WHITE, piece, square) != EMPTY_BITBOARD;
+            cr_assert_eq((destinations & square_bit(square)) != EMPTY_BITBOARD, has_candidate, "%s to square %d", PIECES_NAME[piece], square);
+        }
+        for (uint8_t i = 0; i < n_moves; i++) {
+            if (moves[i].piece == piece && !moves[i].is_castling) {
+                cr_assert(destinations & coord_bit(moves[i].to));
+            }
+        }
+    }
+
+    const bitboard destinations = move_destinations(&bitboards, BLACK, PAWN, 0); // bxa3 en passant
+    const uint8_t a3 = coord_to_square((struct coord) { .file = 0, .rank = 2 });
+    cr_assert(destinations & square_bit(a3));
+    cr_assert_eq(count_squares_below(destinations, a3), 1); // after hxg2
+    cr_assert_eq(nth_square(destinations, 1), a3);
+    cr_assert_eq(nth_square(destinations, count_squares(destinations)), N_SQUARES);
+}
@@ -0,0 +1,72 @@
+#include <criterion/criterion.h>
+#include "../include/opening_trie.h"
+#include "test_helpers.h"
+
+// 1. e4 e5 2. Nf3, 1. e4 e5 2. Nc3 and 1. e4 c5 {Sicilian}
+static void make_trie(struct opening_trie* trie) {
+    const struct pgn_token king_knight[] = {
+        move_token(MOVE_PAWN, WHITE, AT(E, 2), AT(E, 4)),
+        move_token(MOVE_PAWN, BLACK, AT(E, 7), AT(E, 5)),
+        move_token(MOVE_KNIGHT, WHITE, AT(G, 1), AT(F, 3))
+    };
+    const struct pgn_token vienna[] = {
+        move_token(MOVE_PAWN, WHITE, AT(E, 2), AT(E, 4)),
+        move_token(MOVE_PAWN, BLACK, AT(E, 7), AT(E, 5)),
+        move_token(MOVE_KNIGHT, WHITE, AT(B, 1), AT(C, 3))
+    };
+    const struct pgn_token sicilian[] = {
+        move_token(MOVE_PAWN, WHITE, AT(E, 2), AT(E, 4)),
+        move_token(MOVE_PAWN, BLACK, AT(C, 7), AT(C, 5)),
+        { .type = COMMENT, .move.comment = "Sicilian" }
+    };
+
+    cr_assert(opening_trie_init(trie));
+    cr_assert(opening_trie_add_game(trie, king_knight, 3, MAX_OPENING_PLIES));
+    cr_assert(opening_trie_add_game(trie, vienna, 3, MAX_OPENING_PLIES));
+    cr_assert(opening_trie_add_game(trie, sicilian, 3, MAX_OPENING_PLIES));
+}
+
+Test(opening_trie, prune_then_find) {
+    struct opening_trie trie;
+    make_trie(&trie);
+    cr_assert_eq(trie.n_nodes, 6);
+
+    cr_assert(opening_trie_prune(&trie, OPENING_TRIE_MIN_GAMES));
+    cr_assert_eq(trie.n_nodes, 3); // 1. e4 e5 only
+
+    const struct pgn_token ruy_lopez[] = {
+        move_token(MOVE_PAWN, WHITE, AT(E, 2), AT(E, 4)),
+        move_token(MOVE_PAWN, BLACK, AT(E, 7), AT(E, 5)),
+        move_token(MOVE_KNIGHT, WHITE, AT(G, 1), AT(F, 3))
+    };
+    const size_t node = opening_trie_find(&trie, ruy_lopez, 3);
+    cr_assert_eq(trie.nodes[node].state.ply, 2);
+    cr_assert(are_coords_equal(&trie.nodes[node].token.move.move.to, &ruy_lopez[1].move.move.to));
+    opening_trie_free(&trie);
+}
+
+Test(opening_trie, write_then_read) {
+    struct opening_trie written;
+    struct opening_trie read;
+    make_trie(&written);
+
+    struct bit_writer writer;
+    cr_assert(bit_writer_init(&writer));
+    cr_assert(write_opening_trie(&writer, &written));
+    cr_assert(bit_writer_align(&writer));
+
+    struct compressed_buf buf;
+    cr_assert(make_compressed_buf(&buf, writer.buf, writer.n_bits / 8));
+    cr_assert(read_opening_trie(&buf, &read));
+    cr_assert_eq(read.n_nodes, written.n_nodes);
+    for (size_t id = 0; id < read.n_nodes; id++) {
+        cr_assert_eq(read.nodes[id].parent, written.nodes[id].parent);
+        cr_assert_eq(read.nodes[id].move_index, written.nodes[id].move_index);
+        cr_assert_eq(read.nodes[id].state.ply, written.nodes[id].state.ply);
+        cr_assert_eq(memcmp(read.nodes[id].state.board, written.nodes[id].state.board, sizeof(board)), 0);
+    }
+
+    opening_trie_free(&written);
+    opening_trie_free(&read);
+    bit_writer_free(&writer);
+}
@@ -0,0 +1,30 @@
+#include <criterion/criterion.h>
+#include "../include/fen.h"
+#include "../include/position_cache.h"
+#include "../include/zobrist.h"
+
+Test(position_cache, hits_after_first_lookup) {
+    struct position_cache cache;
+    struct board_state state;
+    cr_assert(position_cache_init(&cache, 16));
+    cr_assert(board_state_from_fen("rnbqkbnr/ppppp2p/5p2/6pQ/4P3/7P/PPPP1PP1/RNB1KBNR b KQkq - 1 3", &state));
+    const zobrist_key key = position_key(&state);
+
+    cr_assert_eq(cached_is_player_checked(&cache, key, &state.bitboards, BLACK, INVALID_COORD), CHECKMATE);
+    cr_assert_eq(cached_is_player_checked(&cache, key, &state.bitboards, BLACK, INVALID_COORD), CHECKMATE);
+    cr_assert_eq(cache.hits, 1);
+    cr_assert_eq(cache.misses, 1);
+
+    // same slot, another position replaces the first one
+    cr_assert_eq(cached_is_player_checked(&cache, key + 16, &state.bitboards, BLACK, INVALID_COORD), CHECKMATE);
+    cr_assert_eq(cached_is_player_checked(&cache, key, &state.bitboards, BLACK, INVALID_COORD), CHECKMATE);
+    cr_assert_eq(cache.misses, 3);
+
+    free_board_state(&state);
+    position_cache_free(&cache);
+}
+
+Test(position_cache, size_must_be_a_power_of_2) {
+    struct position_cache cache;
+    cr_assert_not(position_cache_init(&cache, 12));
+}
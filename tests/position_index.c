@@ -0,0 +1,67 @@
+#include <criterion/criterion.h>
+#include "../include/fen.h"
+#include "../include/position_index.h"
+#include "../include/zobrist.h"
+#include "test_helpers.h"
+
+Test(position_index, fen_starting_position) {
+    struct board_state from_fen;
+    struct board_state starting = empty_board_state();
+
+    cr_assert(board_state_from_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", &from_fen));
+    cr_assert_eq(position_key(&from_fen), position_key(&starting));
+    cr_assert_eq(from_fen.move_turn, 1);
+    free_board_state(&from_fen);
+    free_board_state(&starting);
+}
+
+Test(position_index, fen_matches_replayed_game) {
+    struct board_state from_fen;
+    struct board_state played = empty_board_state();
+    struct pgn_token token = {
+        .type = MOVE_PAWN,
+        .move.move = { .player = WHITE, .from = AT(E, 2), .to = AT(E, 4) }
+    };
+    apply_move(&token, &played);
+    next_turn(&played);
+
+    cr_assert(board_state_from_fen("rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1", &from_fen));
+    cr_assert_eq(from_fen.current_player, BLACK);
+    cr_assert_eq(from_fen.en_passant_file, E_FILE);
+    cr_assert_eq(position_key(&from_fen), position_key(&played));
+    free_board_state(&from_fen);
+
+    cr_assert(board_state_from_fen("rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b Kkq - 0 1", &from_fen));
+    cr_assert_neq(position_key(&from_fen), position_key(&played));
+    free_board_state(&from_fen);
+    free_board_state(&played);
+}
+
+Test(position_index, invalid_fen) {
+    struct board_state state;
+
+    cr_assert_not(board_state_from_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP w KQkq - 0 1", &state));
+    cr_assert_not(board_state_from_fen("rnbqkbnr/pppppppp/9/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", &state));
+    cr_assert_not(board_state_from_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR x KQkq - 0 1", &state));
+}
+
+Test(position_index, lower_bound) {
+    const zobrist_key keys[] = { 3, 7, 7, 7, 12 };
+    uint8_t entries[sizeof(keys) / sizeof(keys[0])][POSITION_INDEX_ENTRY_SIZE] = { 0 };
+    for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+        for (int byte = 0; byte < 8; byte++) {
+            entries[i][byte] = (keys[i] >> (8 * byte)) & 0xFF;
+        }
+        entries[i][12] = i; // ply
+    }
+
+    cr_assert_eq(position_index_lower_bound(&entries[0][0], 5, 1), 0);
+    cr_assert_eq(position_index_lower_bound(&entries[0][0], 5, 7), 1);
+    cr_assert_eq(position_index_lower_bound(&entries[0][0], 5, 8), 4);
+    cr_assert_eq(position_index_lower_bound(&entries[0][0], 5, 13), 5);
+
+    struct position_index_entry entry;
+    position_index_read_entry(&entries[0][0], 3, &entry);
+    cr_assert_eq(entry.key, 7);
+    cr_assert_eq(entry.ply, 3);
+}
@@ -0,0 +1,71 @@
+#include <criterion/criterion.h>
+#include "../include/move_model.h"
+#include "../include/range_coder.h"
+
+#define N_BITS 1000
+
+Test(range_coder, bits_round_trip) {
+    struct bit_writer writer;
+    struct range_encoder encoder;
+    bit_probability probability = BIT_PROBABILITY_INIT;
+    cr_assert(bit_writer_init(&writer));
+    cr_assert(write_bits(&writer, 3, 0x5)); // coded data doesn't need to be aligned
+    range_encoder_init(&encoder, &writer);
+    for (unsigned i = 0; i < N_BITS; i++) {
+        cr_assert(encode_bit(&encoder, &probability, i % 10 == 0));
+        cr_assert(encode_direct_bits(&encoder, 5, i & 0x1F));
+    }
+    cr_assert(range_encoder_flush(&encoder));
+    const size_t n_bits = writer.n_bits;
+    cr_assert(write_bits(&writer, 8, 'X'));
+    cr_assert(bit_writer_align(&writer));
+
+    struct compressed_buf buf;
+    struct range_decoder decoder;
+    uint8_t header;
+    cr_assert(make_compressed_buf(&buf, writer.buf, writer.n_bits / 8));
+    cr_assert(read_n_bits(&buf, 3, &header));
+    cr_assert(range_decoder_init(&decoder, &buf));
+    probability = BIT_PROBABILITY_INIT;
+    for (unsigned i = 0; i < N_BITS; i++) {
+        bool bit;
+        uint32_t direct;
+        cr_assert(decode_bit(&decoder, &probability, &bit));
+        cr_assert_eq(bit, i % 10 == 0, "Bit %u is wrong !", i);
+        cr_assert(decode_direct_bits(&decoder, 5, &direct));
+        cr_assert_eq(direct, i & 0x1F);
+    }
+    // the decoder reads exactly what the encoder wrote, so that the next game follows
+    cr_assert_eq(bit_offset(&buf), n_bits);
+    bit_writer_free(&writer);
+}
+
+Test(range_coder, ranks_round_trip) {
+    struct bit_writer writer;
+    struct range_encoder encoder;
+    struct move_model* const model = malloc(sizeof(struct move_model));
+    cr_assert(bit_writer_init(&writer));
+    range_encoder_init(&encoder, &writer);
+    move_model_init(model);
+    for (unsigned rank = 0; rank < MAX_LEGAL_MOVES; rank++) {
+        cr_assert(encode_rank(&encoder, model, rank));
+        cr_assert(encode_special_index(&encoder, model, rank % N_SPECIAL_INDICES));
+    }
+    cr_assert(range_encoder_flush(&encoder));
+
+    struct compressed_buf buf;
+    struct range_decoder decoder;
+    cr_assert(make_compressed_buf(&buf, writer.buf, writer.n_bits / 8));
+    cr_assert(range_decoder_init(&decoder, &buf));
+    move_model_init(model);
+    for (unsigned rank = 0; rank < MAX_LEGAL_MOVES; rank++) {
+        uint8_t decoded;
+        enum special_index index;
+        cr_assert(decode_rank(&decoder, model, &decoded));
+        cr_assert_eq(decoded, rank);
+        cr_assert(decode_special_index(&decoder, model, &index));
+        cr_assert_eq(index, rank % N_SPECIAL_INDICES);
+    }
+    free(model);
+    bit_writer_free(&writer);
+}
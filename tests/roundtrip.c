@@ -0,0 +1,75 @@
+#include <criterion/criterion.h>
+#include "../include/roundtrip.h"
+#include "test_helpers.h"
+
+Test(roundtrip, are_tokens_equal) {
+    const struct pgn_token e4 = move_token(MOVE_PAWN, WHITE, AT(E, 2), AT(E, 4));
+    struct pgn_token other = e4;
+    cr_assert(are_tokens_equal(&e4, &other));
+    other.move.move.check = CHECK;
+    cr_assert(!are_tokens_equal(&e4, &other));
+    other = move_token(MOVE_PAWN, WHITE, AT(E, 2), AT(E, 3));
+    cr_assert(!are_tokens_equal(&e4, &other));
+
+    char solid[] = "Solid";
+    const struct pgn_token comment = { .type = COMMENT, .move.comment = "Solid" };
+    other = (struct pgn_token) { .type = COMMENT, .move.comment = solid }; // compared by content
+    cr_assert(are_tokens_equal(&comment, &other));
+    other.move.comment = "Dubious";
+    cr_assert(!are_tokens_equal(&comment, &other));
+    cr_assert(!are_tokens_equal(&comment, &e4));
+
+    // the winner of a draw doesn't matter
+    const struct pgn_token draw = { .type = END_OF_THE_GAME, .move.winner = { .is_draw = true, .winner = WHITE } };
+    other = (struct pgn_token) { .type = END_OF_THE_GAME, .move.winner = { .is_draw = true, .winner = BLACK } };
+    cr_assert(are_tokens_equal(&draw, &other));
+    other.move.winner.is_draw = false;
+    cr_assert(!are_tokens_equal(&draw, &other));
+}
+
+Test(roundtrip, survives_coding) {
+    // 1. e4 e5 (1... c5 {Sicilian}) 2. Nf3 1-0
+    const struct pgn_token game[] = {
+        move_token(MOVE_PAWN, WHITE, AT(E, 2), AT(E, 4)),
+        move_token(MOVE_PAWN, BLACK, AT(E, 7), AT(E, 5)),
+        { .type = ALTERNATIVE_MOVE, .move.alternative_moves_is_end = false },
+        move_token(MOVE_PAWN, BLACK, AT(C, 7), AT(C, 5)),
+        { .type = COMMENT, .move.comment = "Sicilian" },
+        { .type = ALTERNATIVE_MOVE, .move.alternative_moves_is_end = true },
+        move_token(MOVE_KNIGHT, WHITE, AT(G, 1), AT(F, 3)),
+        { .type = END_OF_THE_GAME, .move.winner = { .is_draw = false, .winner = WHITE } }
+    };
+    const struct tag tags[] = { { .name = "Event", .name_len = 5, .value = "Test", .value_len = 4 } };
+    struct token_list tokens = { 0 };
+    for (size_t i = 0; i < sizeof(game) / sizeof(game[0]); i++) {
+        cr_assert(token_list_push(&tokens, &game[i]));
+    }
+    struct bit_writer container;
+    cr_assert(bit_writer_init(&container));
+    cr_assert(encode_game(&container, tags, 1, &tokens, PREFIX_CODING));
+
+    struct token_list original = { 0 };
+    const struct uncompress_options options = { .on_token = record_token, .token_data = &original };
+    struct compressed_buf buf;
+    struct game_layout layout;
+    cr_assert(make_compressed_buf(&buf, container.buf, container.n_bits / 8));
+    cr_assert_eq(uncompress_game(&buf, &options, &layout, NULL, NULL), TRUE);
+
+    struct bit_writer writer;
+    struct token_list decoded = { 0 };
+    cr_assert(bit_writer_init(&writer));
+    cr_assert(make_compressed_buf(&buf, container.buf, container.n_bits / 8));
+    for (enum move_coding coding = 0; coding < N_MOVE_CODINGS; coding++) {
+        cr_assert(survives_coding(&buf, &layout, &original, coding, &writer, &decoded), "The game doesn't survive the coding %d !", coding);
+    }
+
+    // a check the position doesn't give cannot come back from the indices among the legal moves
+    original.tokens[0].move.move.check = CHECK;
+    cr_assert(!survives_coding(&buf, &layout, &original, LEGAL_INDEX_CODING, &writer, &decoded));
+
+    token_list_free(&decoded);
+    token_list_free(&original);
+    token_list_free(&tokens);
+    bit_writer_free(&writer);
+    bit_writer_free(&container);
+}
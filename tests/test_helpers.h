@@ -0,0 +1,28 @@
+#pragma once
+
+#include "../include/apply_move.h"
+#include "../include/coord_constants.h"
+#include "../include/piece.h"
+
+#define AT(file, rank) ((struct coord) MAKE_CONSTANT_COORD(file, rank))
+
+static inline struct pgn_token move_token(enum token_type type, enum player player, struct coord from, struct coord to) {
+    return (struct pgn_token) {
+        .type = type,
+        .move.move = { .player = player, .piece = (enum piece_type)type, .from = from, .to = to }
+    };
+}
+
+// plays the move for the player whose turn it is
+static inline void play(struct board_state* state, enum token_type type, struct coord from, struct coord to) {
+    struct pgn_token token = {
+        .type = type,
+        .move.move = {
+            .player = state->current_player,
+            .from = from,
+            .to = to
+        }
+    };
+    apply_move(&token, state);
+    next_turn(state);
+}
@@ -0,0 +1,69 @@
+#include <criterion/criterion.h>
+#include "../include/zobrist.h"
+#include "test_helpers.h"
+
+Test(zobrist, transpositions_have_the_same_key) {
+    struct board_state first = empty_board_state();
+    struct board_state second = empty_board_state();
+    const zobrist_key starting_key = position_key(&first);
+
+    play(&first, MOVE_KNIGHT, AT(G, 1), AT(F, 3));
+    play(&first, MOVE_KNIGHT, AT(G, 8), AT(F, 6));
+    cr_assert_neq(position_key(&first), starting_key);
+    play(&first, MOVE_KNIGHT, AT(F, 3), AT(G, 1));
+    play(&first, MOVE_KNIGHT, AT(F, 6), AT(G, 8));
+    cr_assert_eq(position_key(&first), starting_key);
+
+    play(&first, MOVE_PAWN, AT(E, 2), AT(E, 4));
+    play(&first, MOVE_PAWN, AT(E, 7), AT(E, 5));
+    play(&first, MOVE_KNIGHT, AT(G, 1), AT(F, 3));
+    play(&second, MOVE_KNIGHT, AT(G, 1), AT(F, 3));
+    play(&second, MOVE_PAWN, AT(E, 7), AT(E, 5));
+    play(&second, MOVE_PAWN, AT(E, 2), AT(E, 4));
+    cr_assert_eq(position_key(&first), position_key(&second));
+
+    free_board_state(&first);
+    free_board_state(&second);
+}
+
+Test(zobrist, castling_rights_and_side_to_move) {
+    struct board_state first = empty_board_state();
+    struct board_state second = empty_board_state();
+
+    play(&first, MOVE_PAWN, AT(E, 2), AT(E, 4));
+    play(&first, MOVE_PAWN, AT(E, 7), AT(E, 5));
+    play(&second, MOVE_PAWN, AT(E, 2), AT(E, 4));
+    play(&second, MOVE_PAWN, AT(E, 7), AT(E, 5));
+
+    // same placement, but the king moved back and forth
+    play(&first, MOVE_KING, AT(E, 1), AT(E, 2));
+    play(&first, MOVE_KING, AT(E, 8), AT(E, 7));
+    play(&first, MOVE_KING, AT(E, 2), AT(E, 1));
+    play(&first, MOVE_KING, AT(E, 7), AT(E, 8));
+    cr_assert_eq(first.castling_rights, 0);
+    cr_assert_eq(second.castling_rights, ALL_CASTLING_RIGHTS);
+    cr_assert_neq(position_key(&first), position_key(&second));
+
+    const zobrist_key white_to_move = position_key(&second);
+    next_turn(&second);
+    cr_assert_eq(position_key(&second) ^ white_to_move, zobrist_black_to_move_key());
+
+    free_board_state(&first);
+    free_board_state(&second);
+}
+
+Test(zobrist, restored_after_alternative_moves) {
+    struct board_state state = empty_board_state();
+
+    play(&state, MOVE_PAWN, AT(E, 2), AT(E, 4));
+    play(&state, MOVE_PAWN, AT(D, 7), AT(D, 5));
+    const zobrist_key key = position_key(&state);
+
+    cr_assert(board_start_alternative_moves(&state));
+    play(&state, MOVE_PAWN, AT(E, 7), AT(E, 5));
+    cr_assert_neq(position_key(&state), key);
+    cr_assert(board_end_alternative_moves(&state));
+    cr_assert_eq(position_key(&state), key);
+
+    free_board_state(&state);
+}